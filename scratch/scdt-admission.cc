@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Compare the child admission policies of SCDT.
+//
+// Every policy is run on the same topology, access links and join
+// times (same seed), with the fan-out derived from the access link rate
+// so that the bandwidth weighted policy has capacities to weigh.  For
+// each policy: mean and worst join latency, mean and largest tree depth,
+// and the mean and worst p99 of the chunk latencies, streamed once the
+// joins are over.
+//
+//   ./waf --run "scdt-admission --overlayNodes=200 --seed=1"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtAdmission");
+
+struct AdmissionResult
+{
+  uint32_t attached;
+  double meanJoin; //!< Mean join latency, in seconds
+  double worstJoin; //!< Largest join latency, in seconds
+  uint32_t maxDepth;
+  double meanDepth;
+  double meanP99; //!< Mean of the node p99s, in seconds
+  double worstP99; //!< Largest node p99, in seconds
+};
+
+static AdmissionResult
+RunConfig (std::string policy, std::string confFile, uint32_t overlayNodes, std::string streamRate,
+           unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (0));
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (streamRate)));
+  rootHelper.SetAttribute ("AdmissionPolicy", TypeIdValue (TypeId::LookupByName (policy)));
+  // Joins are spread over the first 51 s; stream once they are done
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (60.0)));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("MaxFanout", UintegerValue (0));
+  scdtServerHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (streamRate)));
+  scdtServerHelper.SetAttribute ("AdmissionPolicy", TypeIdValue (TypeId::LookupByName (policy)));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (Seconds (120.0));
+  // Joins spread uniformly over 50 s from 2 s, alike in every configuration
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (Seconds (120.0));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Run ();
+
+  std::vector<int32_t> depths = GetScdtTreeDepths (apps, Ipv4Address::ConvertFrom (rootIp));
+
+  AdmissionResult result = { 0, 0, 0, 0, 0, 0, 0 };
+  double joinSum = 0;
+  double depthSum = 0;
+  double p99Sum = 0;
+  uint32_t received = 0;
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      if (depths[k] < 0)
+        {
+          continue;
+        }
+      uint32_t depth = depths[k];
+      result.attached++;
+      joinSum += app->GetJoinLatency ().GetSeconds ();
+      result.worstJoin = std::max (result.worstJoin, app->GetJoinLatency ().GetSeconds ());
+      result.maxDepth = std::max (result.maxDepth, depth);
+      depthSum += depth;
+      const ScdtLatencyHistogram &latency = app->GetLatencyHistogram ();
+      if (latency.GetCount () > 0)
+        {
+          double p99 = latency.GetQuantile (0.99).GetSeconds ();
+          p99Sum += p99;
+          result.worstP99 = std::max (result.worstP99, p99);
+          received++;
+        }
+    }
+  result.meanJoin = result.attached ? joinSum / result.attached : 0;
+  result.meanDepth = result.attached ? depthSum / result.attached : 0;
+  result.meanP99 = received ? p99Sum / received : 0;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 200;
+  std::string streamRate = "1Mbps";
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("streamRate", "Stream rate, which also sizes the fan-out of each node", streamRate);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  std::string policies[] = {
+    "ns3::ScdtLowestRttAdmissionPolicy",
+    "ns3::ScdtDepthBalancedAdmissionPolicy",
+    "ns3::ScdtBandwidthWeightedAdmissionPolicy",
+    "ns3::ScdtNeverEvictAdmissionPolicy",
+  };
+
+  std::cout << std::left << std::setw (40) << "policy" << std::right
+            << std::setw (10) << "attached" << std::setw (14) << "meanJoin(s)"
+            << std::setw (14) << "worstJoin(s)" << std::setw (10) << "maxDepth"
+            << std::setw (11) << "meanDepth" << std::setw (13) << "meanP99(s)"
+            << std::setw (13) << "worstP99(s)" << std::endl;
+  for (uint32_t c = 0; c < sizeof (policies) / sizeof (policies[0]); c++)
+    {
+      AdmissionResult r = RunConfig (policies[c], confFile, overlayNodes, streamRate, seed);
+      std::cout << std::left << std::setw (40) << policies[c] << std::right
+                << std::setw (10) << r.attached
+                << std::fixed << std::setprecision (4)
+                << std::setw (14) << r.meanJoin << std::setw (14) << r.worstJoin
+                << std::setw (10) << r.maxDepth
+                << std::setprecision (2)
+                << std::setw (11) << r.meanDepth
+                << std::setprecision (4)
+                << std::setw (13) << r.meanP99 << std::setw (13) << r.worstP99
+                << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Control traffic of a join storm with and without control aggregation.
+//
+// Both runs use the same topology, access links and join times (same
+// seed): every overlay node joins within the first stormWindow seconds
+// while the root streams, so that the tree is built under load and the
+// HEARTBEATs to children run alongside the chunks.  For each run: the
+// control messages and datagrams per node, root included, the join
+// latencies, and the wall-clock time of the simulation.  --arrivals
+// picks how the joins are spread over the window; a flash crowd starts
+// burstSize nodes (all by default) within the first burst milliseconds.
+//
+//   ./waf --run "scdt-aggregation --overlayNodes=1000 --stormWindow=5 --seed=1"
+//   ./waf --run "scdt-aggregation --arrivals=FlashCrowd --burstSize=500 --burst=200"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include "ns3/system-wall-clock-ms.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtAggregation");
+
+struct AggregationResult
+{
+  uint32_t attached;
+  double messagesPerNode; //!< Control messages sent per node
+  double datagramsPerNode; //!< Control datagrams sent per node
+  double meanJoin; //!< Mean join latency of the attached nodes, in seconds
+  double worstJoin; //!< Largest join latency, in seconds
+  int64_t wallClock; //!< Wall-clock time of Simulator::Run, in milliseconds
+};
+
+static AggregationResult
+RunConfig (bool aggregation, std::string confFile, uint32_t overlayNodes, uint32_t stormWindow,
+           std::string arrivals, uint32_t burstSize, uint32_t burst, std::string streamRate, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (streamRate)));
+  rootHelper.SetAttribute ("ControlAggregation", BooleanValue (aggregation));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (streamRate)));
+  scdtServerHelper.SetAttribute ("ControlAggregation", BooleanValue (aggregation));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (Seconds (60.0));
+  scdtServerHelper.SetArrivals (arrivals, Seconds (2.0), Seconds (stormWindow));
+  scdtServerHelper.SetFlashCrowd (burstSize, MilliSeconds (burst));
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (Seconds (60.0));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+
+  AggregationResult result = { 0, 0, 0, 0, 0, clock.End () };
+  double joinSum = 0;
+  Ptr<ScdtServer> root = rootApps.Get (0)->GetObject<ScdtServer> ();
+  uint64_t messages = root->GetControlMessages ();
+  uint64_t datagrams = root->GetControlTx ();
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      messages += app->GetControlMessages ();
+      datagrams += app->GetControlTx ();
+      if (app->IsAttached ())
+        {
+          result.attached++;
+          joinSum += app->GetJoinLatency ().GetSeconds ();
+          result.worstJoin = std::max (result.worstJoin, app->GetJoinLatency ().GetSeconds ());
+        }
+    }
+  result.messagesPerNode = static_cast<double> (messages) / (overlayNodes + 1);
+  result.datagramsPerNode = static_cast<double> (datagrams) / (overlayNodes + 1);
+  result.meanJoin = result.attached ? joinSum / result.attached : 0;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 1000;
+  uint32_t stormWindow = 5;
+  std::string arrivals = "Uniform";
+  uint32_t burstSize = 0;
+  uint32_t burst = 100;
+  std::string streamRate = "500kbps";
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("stormWindow", "Seconds over which every overlay node starts joining", stormWindow);
+  cmd.AddValue ("arrivals", "Arrival model of the joins: Uniform, Poisson, FlashCrowd or Diurnal", arrivals);
+  cmd.AddValue ("burstSize", "Nodes in the burst of a flash crowd, 0 for all", burstSize);
+  cmd.AddValue ("burst", "Duration of the burst of a flash crowd, in milliseconds", burst);
+  cmd.AddValue ("streamRate", "Stream rate, which also sizes the fan-out of each node", streamRate);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  std::cout << std::left << std::setw (13) << "aggregation" << std::right
+            << std::setw (10) << "attached" << std::setw (11) << "msgs/node"
+            << std::setw (12) << "dgrams/node" << std::setw (14) << "meanJoin(s)"
+            << std::setw (14) << "worstJoin(s)" << std::setw (12) << "wall(ms)" << std::endl;
+  for (uint32_t c = 0; c < 2; c++)
+    {
+      AggregationResult r = RunConfig (c > 0, confFile, overlayNodes, std::max<uint32_t> (stormWindow, 1),
+                                       arrivals, burstSize, burst, streamRate, seed);
+      std::cout << std::left << std::setw (13) << (c > 0 ? "on" : "off") << std::right
+                << std::setw (10) << r.attached
+                << std::fixed << std::setprecision (2)
+                << std::setw (11) << r.messagesPerNode << std::setw (12) << r.datagramsPerNode
+                << std::setprecision (4)
+                << std::setw (14) << r.meanJoin << std::setw (14) << r.worstJoin
+                << std::setw (12) << r.wallClock
+                << std::endl;
+    }
+
+  return 0;
+}
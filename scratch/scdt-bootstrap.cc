@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Control load on the root with root-funnelled and distributed joins.
+//
+// Both configurations are run on the same topology and access links
+// (same seed).  With --entryPoints=k, every joiner is given k entry
+// points drawn among the nodes that started at least 5 s before it, and
+// nodes rejoin from their ancestors after a REATTACH; with 0 every join
+// and rejoin starts at the root.  The root's control messages are
+// compared with the total over all the nodes.
+//
+//   ./waf --run "scdt-bootstrap --overlayNodes=10000 --entryPoints=3"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtBootstrap");
+
+struct BootstrapResult
+{
+  uint32_t attached;
+  double meanJoin; //!< Mean join latency of the attached nodes, in seconds
+  uint64_t rootControl; //!< Control datagrams sent by the root
+  uint64_t totalControl; //!< Control datagrams sent by all the nodes
+};
+
+static BootstrapResult
+RunConfig (uint32_t entryPoints, std::string confFile, uint32_t overlayNodes,
+           uint32_t maxFanout, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  if (entryPoints == 0)
+    {
+      scdtServerHelper.SetAttribute ("MaxEntryPoints", UintegerValue (0));
+    }
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (Seconds (120.0));
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  std::vector<Time> startTimes = scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (Seconds (120.0));
+  for (uint32_t k = 0; k < apps.GetN () && entryPoints > 0; k++)
+    {
+      // Members that had time to join; the earliest nodes go to the root
+      for (uint32_t e = 0, tries = 0; e < entryPoints && tries < 10 * entryPoints; tries++)
+        {
+          uint32_t other = rand () % apps.GetN ();
+          if (startTimes[other] + Seconds (5) <= startTimes[k])
+            {
+              scdtServerHelper.AddEntryPoint (apps.Get (k), InetSocketAddress (topology.overlayIps[other], 9));
+              e++;
+            }
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Run ();
+
+  BootstrapResult result = { 0, 0, 0, 0 };
+  double joinSum = 0;
+  result.rootControl = rootApps.Get (0)->GetObject<ScdtServer> ()->GetControlTx ();
+  result.totalControl = result.rootControl;
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      result.totalControl += app->GetControlTx ();
+      if (app->IsAttached ())
+        {
+          result.attached++;
+          joinSum += app->GetJoinLatency ().GetSeconds ();
+        }
+    }
+  result.meanJoin = result.attached ? joinSum / result.attached : 0;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 1000;
+  uint32_t maxFanout = 4;
+  uint32_t entryPoints = 3;
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("maxFanout", "Maximum number of children", maxFanout);
+  cmd.AddValue ("entryPoints", "Entry points given to every joiner in the distributed run", entryPoints);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  uint32_t configs[] = { 0, entryPoints };
+
+  std::cout << std::left << std::setw (14) << "entryPoints" << std::right
+            << std::setw (10) << "attached" << std::setw (12) << "rootCtrl"
+            << std::setw (12) << "totalCtrl" << std::setw (11) << "rootShare"
+            << std::setw (14) << "meanJoin(s)" << std::endl;
+  for (uint32_t c = 0; c < 2; c++)
+    {
+      BootstrapResult r = RunConfig (configs[c], confFile, overlayNodes, maxFanout, seed);
+      std::cout << std::left << std::setw (14) << configs[c] << std::right
+                << std::setw (10) << r.attached << std::setw (12) << r.rootControl
+                << std::setw (12) << r.totalControl
+                << std::fixed << std::setprecision (3)
+                << std::setw (11) << (r.totalControl ? static_cast<double> (r.rootControl) / r.totalControl : 0)
+                << std::setprecision (4)
+                << std::setw (14) << r.meanJoin << std::endl;
+    }
+
+  return 0;
+}
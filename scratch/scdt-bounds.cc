@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Depth- and latency-bounded SCDT trees.
+//
+// The same session (same seed, topology, access links and join times)
+// is run without bounds, with MaxDepth and with MaxLatency.  For each
+// configuration: the largest depth and root latency the members ended
+// at, as told by their parents, the mean and worst p99 of the chunk
+// latencies, the chunks dropped as later than MaxLatency and the
+// relocations made to meet the bounds.
+//
+//   ./waf --run "scdt-bounds --overlayNodes=200 --maxDepth=6 --maxLatency=250ms"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtBounds");
+
+struct BoundsResult
+{
+  uint32_t attached;
+  uint32_t maxDepth;
+  double maxRootLatency; //!< Largest estimated root latency, in seconds
+  double meanP99; //!< Mean of the node p99s, in seconds
+  double worstP99; //!< Largest node p99, in seconds
+  uint64_t lateChunks;
+  uint32_t relocations;
+};
+
+static BoundsResult
+RunConfig (uint16_t maxDepth, Time maxLatency, std::string confFile, uint32_t overlayNodes,
+           uint32_t maxFanout, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("200kbps")));
+  rootHelper.SetAttribute ("MaxDepth", UintegerValue (maxDepth));
+  rootHelper.SetAttribute ("MaxLatency", TimeValue (maxLatency));
+  // Joins are spread over the first 51 s; stream once they are done
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (60.0)));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  scdtServerHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("200kbps")));
+  scdtServerHelper.SetAttribute ("MaxDepth", UintegerValue (maxDepth));
+  scdtServerHelper.SetAttribute ("MaxLatency", TimeValue (maxLatency));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (Seconds (150.0));
+  // Joins spread uniformly over 50 s from 2 s, alike in every configuration
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (Seconds (150.0));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Run ();
+
+  BoundsResult result = { 0, 0, 0, 0, 0, 0, 0 };
+  double p99Sum = 0;
+  uint32_t received = 0;
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      result.lateChunks += app->GetLateChunks ();
+      result.relocations += app->GetRelocations ();
+      if (!app->IsAttached ())
+        {
+          continue;
+        }
+      result.attached++;
+      result.maxDepth = std::max<uint32_t> (result.maxDepth, app->GetDepth ());
+      result.maxRootLatency = std::max (result.maxRootLatency, app->GetRootLatency ().GetSeconds ());
+      const ScdtLatencyHistogram &latency = app->GetLatencyHistogram ();
+      if (latency.GetCount () > 0)
+        {
+          double p99 = latency.GetQuantile (0.99).GetSeconds ();
+          p99Sum += p99;
+          result.worstP99 = std::max (result.worstP99, p99);
+          received++;
+        }
+    }
+  result.meanP99 = received ? p99Sum / received : 0;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+static void
+PrintResult (std::string label, const BoundsResult & r)
+{
+  std::cout << std::left << std::setw (16) << label << std::right
+            << std::setw (10) << r.attached << std::setw (10) << r.maxDepth
+            << std::fixed << std::setprecision (4)
+            << std::setw (16) << r.maxRootLatency
+            << std::setw (13) << r.meanP99 << std::setw (13) << r.worstP99
+            << std::setw (12) << r.lateChunks << std::setw (13) << r.relocations
+            << std::endl;
+  std::cout.unsetf (std::ios::floatfield);
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 200;
+  uint32_t maxFanout = 2;
+  uint16_t maxDepth = 6;
+  Time maxLatency = MilliSeconds (250);
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("maxFanout", "Maximum number of children", maxFanout);
+  cmd.AddValue ("maxDepth", "Depth bound of the second run", maxDepth);
+  cmd.AddValue ("maxLatency", "Root latency bound of the third run", maxLatency);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  std::cout << std::left << std::setw (16) << "bounds" << std::right
+            << std::setw (10) << "attached" << std::setw (10) << "maxDepth"
+            << std::setw (16) << "maxRootLat(s)" << std::setw (13) << "meanP99(s)"
+            << std::setw (13) << "worstP99(s)" << std::setw (12) << "lateChunks"
+            << std::setw (13) << "relocations" << std::endl;
+  PrintResult ("none", RunConfig (0, Seconds (0), confFile, overlayNodes, maxFanout, seed));
+  std::ostringstream depthLabel;
+  depthLabel << "depth<=" << maxDepth;
+  PrintResult (depthLabel.str (), RunConfig (maxDepth, Seconds (0), confFile, overlayNodes, maxFanout, seed));
+  std::ostringstream latencyLabel;
+  latencyLabel << "latency<=" << maxLatency.GetMilliSeconds () << "ms";
+  PrintResult (latencyLabel.str (), RunConfig (0, maxLatency, confFile, overlayNodes, maxFanout, seed));
+
+  return 0;
+}
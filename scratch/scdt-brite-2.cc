@@ -26,7 +26,6 @@
 #include "ns3/ipv4-nix-vector-helper.h"
 #include <iostream>
 #include <fstream>
-#include <time.h>
 
 #define OVERLAY_NODES 50
 
@@ -37,7 +36,6 @@ NS_LOG_COMPONENT_DEFINE ("BriteScdt");
 int
 main (int argc, char *argv[])
 {
-  srand (time(NULL));
   LogComponentEnable ("ScdtServerApplication", LOG_LEVEL_INFO);
 
   LogComponentEnable ("BriteScdt", LOG_LEVEL_INFO);
@@ -48,13 +46,34 @@ main (int argc, char *argv[])
   std::string confFile = "src/brite/examples/conf_files/scdt.conf";
   bool tracing = false;
   bool nix = false;
+  bool bandwidthProbe = false;
+  double snapshotInterval = 0;
+  std::string treeFile = "";
+  std::string arrivals = "Uniform";
+  uint32_t burstSize = 0;
+  uint32_t burst = 100;
+  unsigned seed = 1;
 
   CommandLine cmd;
   cmd.AddValue ("confFile", "BRITE conf file", confFile);
   cmd.AddValue ("tracing", "Enable or disable ascii tracing", tracing);
   cmd.AddValue ("nix", "Enable or disable nix-vector routing", nix);
+  cmd.AddValue ("bandwidthProbe", "Select parents on RTT and packet-pair bandwidth", bandwidthProbe);
+  cmd.AddValue ("snapshotInterval", "Seconds between tree snapshots written to scdt-tree.json "
+                "and scdt-tree.dot, 0 for none", snapshotInterval);
+  cmd.AddValue ("tree", "Start from the last tree of a scdt-tree.json written by an earlier run "
+                "instead of joining", treeFile);
+  cmd.AddValue ("arrivals", "Arrival model of the joins over 50 s: Uniform, Poisson, FlashCrowd "
+                "or Diurnal", arrivals);
+  cmd.AddValue ("burstSize", "Nodes in the burst of a flash crowd, 0 for all", burstSize);
+  cmd.AddValue ("burst", "Duration of the burst of a flash crowd, in milliseconds", burst);
+  cmd.AddValue ("seed", "Seed for the access links and join times", seed);
 
   cmd.Parse (argc,argv);
+  srand (seed);
+  RngSeedManager::SetRun (seed);
+
+  Config::SetDefault ("ns3::ScdtServer::BandwidthProbe", BooleanValue (bandwidthProbe));
 
   nix = false;
 
@@ -148,21 +167,66 @@ main (int argc, char *argv[])
       break;
     }
   }  
+  // Every node reports to it when it stops; it writes scdt-stats.csv and
+  // scdt-stats.bin at Simulator::Destroy
+  Ptr<ScdtStatsCollector> stats = CreateObject<ScdtStatsCollector> ();
+
+  // Overlay nodes are addressed in order, so a tree of an earlier run
+  // names the same nodes in this one
+  ScdtTree tree;
+  if (!treeFile.empty () && !tree.LoadSnapshot (treeFile))
+    {
+      NS_FATAL_ERROR ("Cannot read a tree from " << treeFile);
+    }
+
   ScdtServerHelper rootHelper (rootIp, 9, 1);
+  // Joins are spread over the first 51 s; stream once they are done,
+  // or right away from a preset tree
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (tree.GetN () > 0 ? 1.0 : 60.0)));
+  rootHelper.SetTree (tree);
+  // Send 100 kB to every node as fast as the tree carries it; the
+  // lastChunk column then holds the completion time of the transfer:
+  //   ./waf --run "scdt-stats-summary --streamStart=61"  (2 with --tree)
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (0)));
+  rootHelper.SetAttribute ("StreamBytes", UintegerValue (100000));
+  rootHelper.SetAttribute ("StatsCollector", PointerValue (stats));
   ApplicationContainer rootAppContainer = rootHelper.Install (rootContainer.Get (0));
 
   ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("StatsCollector", PointerValue (stats));
+  scdtServerHelper.SetTree (tree);
   ApplicationContainer generalAppContainer = scdtServerHelper.Install(overlayContainer);
 
   rootAppContainer.Start (Seconds (1.0));
-  rootAppContainer.Stop (Seconds (500.0));
+  rootAppContainer.Stop (Seconds (120.0));
 
-  for (uint32_t i = 0; i < generalAppContainer.GetN(); i++) 
+  if (tree.GetN () > 0)
     {
-      generalAppContainer.Get (i)->SetStartTime (Seconds(rand () % 50 + 1));
+      // A preset tree starts together with its root
+      generalAppContainer.Start (Seconds (1.0));
+    }
+  else
+    {
+      scdtServerHelper.SetArrivals (arrivals, Seconds (1.0), Seconds (50.0));
+      scdtServerHelper.SetFlashCrowd (burstSize, MilliSeconds (burst));
+      scdtServerHelper.AssignStreams (overlayContainer, 100);
+      scdtServerHelper.ScheduleArrivals (generalAppContainer);
     }
   //generalAppContainer.Start (Seconds (1.0));
-  generalAppContainer.Stop (Seconds (500.0));
+  generalAppContainer.Stop (Seconds (120.0));
+
+  // How the tree fills up during the join phase
+  ScdtTreeSnapshotHelper snapshots;
+  if (snapshotInterval > 0)
+    {
+      snapshots.Add (rootAppContainer);
+      snapshots.Add (generalAppContainer);
+      snapshots.EnableJson ("scdt-tree.json");
+      snapshots.EnableDot ("scdt-tree.dot");
+      snapshots.SetInterval (Seconds (snapshotInterval));
+      snapshots.Start (Seconds (1.0));
+      snapshots.Stop (Seconds (120.0));
+    }
 
   if (!nix)
     {
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// The BRITE topology the SCDT scratch programs run on, built in one
+// place so that they all compare on the same network.
+//
+// The routers come from a BRITE conf file.  Each overlay node hangs off
+// a random leaf router of an AS through its own access link; the ASes
+// are visited in turn, 1 to 5 overlay nodes at a time.  The root, when
+// there is one, hangs off the last leaf router of AS 0.  Access links
+// get a random rate of 1-10 Mbps and delay of 1-50 ms, drawn from
+// rand (): the caller seeds it with srand (), and the same seed gives
+// the same access links.  GetScdtTreeDepths then reads the depths of
+// the tree the applications built on it.
+
+#ifndef SCDT_BRITE_TOPOLOGY_H
+#define SCDT_BRITE_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/brite-module.h"
+#include "ns3/applications-module.h"
+
+namespace ns3 {
+
+/**
+ * The nodes the SCDT applications are installed on, and their
+ * addresses on their access links.
+ */
+struct ScdtBriteTopology
+{
+  NodeContainer overlay; //!< The overlay nodes
+  std::vector<Ipv4Address> overlayIps; //!< Address of each overlay node on its access link
+  Ptr<Node> root; //!< The root node, 0 if none was asked for
+  Address rootIp; //!< Address of the root on its access link
+};
+
+/**
+ * Give the next access link a random rate and delay.
+ * \param p2p the helper the access links are installed with
+ */
+static void
+SetRandomAccessLink (PointToPointHelper &p2p)
+{
+  char dataRate[10];
+  sprintf (dataRate, "%dMbps", rand () % 10 + 1);
+  char delay[10];
+  sprintf (delay, "%dms", rand () % 50 + 1);
+  p2p.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+  p2p.SetChannelAttribute ("Delay", StringValue (delay));
+}
+
+/**
+ * Build the BRITE routers, the overlay nodes and their access links.
+ *
+ * The routers are numbered from 10.0.0.0 on, the access links from
+ * 11.0.0.0 on: the root's first, then one /30 per overlay node, enough
+ * for any overlay size.  The caller seeds rand () with srand () first:
+ * the same seed gives the same access links, so every configuration of
+ * a sweep runs on the same network.
+ *
+ * \param confFile the BRITE conf file
+ * \param overlayNodes the number of overlay nodes
+ * \param withRoot whether to add a root node besides the overlay nodes
+ * \returns the overlay nodes, the root and their addresses
+ */
+static ScdtBriteTopology
+BuildScdtBriteTopology (std::string confFile, uint32_t overlayNodes, bool withRoot = true)
+{
+  ScdtBriteTopology topology;
+
+  BriteTopologyHelper bth (confFile);
+  bth.AssignStreams (3);
+
+  PointToPointHelper p2p;
+  InternetStackHelper stack;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+
+  bth.BuildBriteTopology (stack);
+  bth.AssignIpv4Addresses (address);
+
+  topology.overlay.Create (overlayNodes);
+  stack.Install (topology.overlay);
+
+  if (withRoot)
+    {
+      NodeContainer rootContainer;
+      rootContainer.Create (1);
+      stack.Install (rootContainer);
+      rootContainer.Add (bth.GetLeafNodeForAs (0, bth.GetNLeafNodesForAs (0) - 1));
+
+      SetRandomAccessLink (p2p);
+      address.SetBase ("11.0.0.0", "255.255.255.252");
+      Ipv4InterfaceContainer rootInterface = address.Assign (p2p.Install (rootContainer));
+      topology.root = rootContainer.Get (0);
+      topology.rootIp = rootInterface.GetAddress (0);
+    }
+
+  uint32_t overlayCounter = 0;
+  uint32_t i = 0;
+  while (overlayCounter != overlayNodes)
+    {
+      if (i == bth.GetNAs ())
+        {
+          i = 0;
+        }
+      uint8_t asCntr = rand () % 5 + 1;
+      for (uint32_t j = 0; j < bth.GetNLeafNodesForAs (i); j++)
+        {
+          if (overlayCounter == overlayNodes || asCntr == 0)
+            {
+              break;
+            }
+          asCntr--;
+
+          NodeContainer conn (topology.overlay.Get (overlayCounter));
+          conn.Add (bth.GetLeafNodeForAs (i, rand () % bth.GetNLeafNodesForAs (i)));
+
+          SetRandomAccessLink (p2p);
+          address.SetBase (Ipv4Address (Ipv4Address ("11.0.0.0").Get () + 4 * (overlayCounter + 1)),
+                           "255.255.255.252");
+          Ipv4InterfaceContainer interfaces = address.Assign (p2p.Install (conn));
+          topology.overlayIps.push_back (interfaces.GetAddress (0));
+
+          overlayCounter++;
+        }
+      i++;
+    }
+  return topology;
+}
+
+/**
+ * Walk the parent pointers of the applications up to the root.
+ *
+ * A node is named by the address of its access link, as its children
+ * know it.  A chain of parents that does not reach the root was broken
+ * by a move or an eviction in flight.
+ *
+ * \param apps the ScdtServer applications of the overlay nodes
+ * \param rootAddr the address of the root on its access link
+ * \returns per application, its depth, or -1 if it is not attached or
+ * its chain of parents does not reach the root
+ */
+static std::vector<int32_t>
+GetScdtTreeDepths (ApplicationContainer apps, Ipv4Address rootAddr)
+{
+  std::map<Ipv4Address, Ipv4Address> parentOf;
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      if (app->IsAttached ())
+        {
+          Ipv4Address self = app->GetNode ()->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+          parentOf[self] = InetSocketAddress::ConvertFrom (app->GetParent ()).GetIpv4 ();
+        }
+    }
+
+  std::vector<int32_t> depths (apps.GetN (), -1);
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      if (!app->IsAttached ())
+        {
+          continue;
+        }
+      Ipv4Address cur = app->GetNode ()->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+      int32_t depth = 0;
+      while (cur != rootAddr && depth <= static_cast<int32_t> (apps.GetN ()) && parentOf.count (cur))
+        {
+          cur = parentOf[cur];
+          depth++;
+        }
+      if (cur == rootAddr)
+        {
+          depths[k] = depth;
+        }
+    }
+  return depths;
+}
+
+} // namespace ns3
+
+#endif /* SCDT_BRITE_TOPOLOGY_H */
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Data outage after node failures, with and without heartbeats.
+//
+// The root streams from 60 s; at 80 s a fraction of the members stop
+// without notice.  Every configuration is run on the same topology,
+// access links and failures (same seed) and only differs by the
+// HeartbeatInterval: 0 disables failure detection, so orphaned subtrees
+// never recover.  The outage of a surviving member is the longest time
+// it went without a chunk after the failures.
+//
+//   ./waf --run "scdt-churn --overlayNodes=200 --failures=0.1"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtChurn");
+
+struct NodeRx
+{
+  Time lastRx; //!< Arrival of the last chunk
+  Time worstGap; //!< Longest time without a chunk since the failures
+  uint64_t chunks; //!< Chunks received since the failures
+};
+
+struct ChurnResult
+{
+  uint32_t survivors;
+  uint32_t attached; //!< Survivors attached at the end
+  double meanOutage; //!< Mean of the survivors' longest gaps, in seconds
+  double worstOutage; //!< Longest gap over the survivors, in seconds
+  double meanChunks; //!< Mean chunks received by a survivor after the failures
+};
+
+static const Time FAILURE_TIME = Seconds (80.0);
+static const Time STOP_TIME = Seconds (120.0);
+
+static void
+ChunkRx (NodeRx *rx, uint32_t seq, Time latency)
+{
+  Time now = Simulator::Now ();
+  if (now < FAILURE_TIME)
+    {
+      rx->lastRx = now;
+      return;
+    }
+  rx->worstGap = std::max (rx->worstGap, now - std::max (rx->lastRx, FAILURE_TIME));
+  rx->lastRx = now;
+  rx->chunks++;
+}
+
+static ChurnResult
+RunConfig (Time heartbeat, std::string confFile, uint32_t overlayNodes, double failures, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (59.0)));
+  rootHelper.SetAttribute ("HeartbeatInterval", TimeValue (heartbeat));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("HeartbeatInterval", TimeValue (heartbeat));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (STOP_TIME);
+  std::vector<NodeRx> rx (apps.GetN ());
+  std::vector<bool> failed (apps.GetN (), false);
+  // Joins spread uniformly over 50 s from 2 s, alike in every configuration
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      failed[k] = rand () < failures * RAND_MAX;
+      apps.Get (k)->SetStopTime (failed[k] ? FAILURE_TIME : STOP_TIME);
+      rx[k].chunks = 0;
+      apps.Get (k)->TraceConnectWithoutContext ("ChunkRx", MakeBoundCallback (&ChunkRx, &rx[k]));
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Run ();
+
+  ChurnResult result = { 0, 0, 0, 0, 0 };
+  double outageSum = 0;
+  double chunkSum = 0;
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      if (failed[k])
+        {
+          continue;
+        }
+      // A node that never got a chunk again was out until the end
+      Time gap = std::max (rx[k].worstGap, STOP_TIME - std::max (rx[k].lastRx, FAILURE_TIME));
+      result.survivors++;
+      result.attached += apps.Get (k)->GetObject<ScdtServer> ()->IsAttached () ? 1 : 0;
+      outageSum += gap.GetSeconds ();
+      result.worstOutage = std::max (result.worstOutage, gap.GetSeconds ());
+      chunkSum += rx[k].chunks;
+    }
+  result.meanOutage = result.survivors ? outageSum / result.survivors : 0;
+  result.meanChunks = result.survivors ? chunkSum / result.survivors : 0;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 200;
+  double failures = 0.1;
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("failures", "Fraction of the members that fail at 80 s", failures);
+  cmd.AddValue ("seed", "Seed for the topology, access links, join times and failures", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  Time heartbeats[] = { Seconds (0), Seconds (1.0), MilliSeconds (250) };
+
+  std::cout << std::left << std::setw (12) << "heartbeat" << std::right
+            << std::setw (11) << "survivors" << std::setw (10) << "attached"
+            << std::setw (15) << "meanOutage(s)" << std::setw (16) << "worstOutage(s)"
+            << std::setw (12) << "chunks" << std::endl;
+  for (uint32_t c = 0; c < sizeof (heartbeats) / sizeof (heartbeats[0]); c++)
+    {
+      ChurnResult r = RunConfig (heartbeats[c], confFile, overlayNodes, failures, seed);
+      std::ostringstream label;
+      if (heartbeats[c].IsZero ())
+        {
+          label << "off";
+        }
+      else
+        {
+          label << heartbeats[c].GetSeconds () << "s";
+        }
+      std::cout << std::left << std::setw (12) << label.str () << std::right << std::setw (11) << r.survivors << std::setw (10) << r.attached
+                << std::fixed << std::setprecision (3)
+                << std::setw (15) << r.meanOutage << std::setw (16) << r.worstOutage
+                << std::setprecision (1) << std::setw (12) << r.meanChunks << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,209 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Compare SCDT tree depth and chunk latency for fixed and
+// capacity-aware fan-out on the scdt.conf BRITE topology.
+//
+// Every configuration is run on the same topology and access links
+// (same seed), so only the fan-out policy differs from the fixed-4
+// baseline.  Latencies are per chunk, from its creation at the root;
+// --byDepth breaks them down per tree depth.
+//
+//   ./waf --run "scdt-fanout-sweep --overlayNodes=50 --seed=1 --byDepth=1"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+#include <map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtFanoutSweep");
+
+struct SweepConfig
+{
+  std::string name;
+  uint32_t maxFanout;
+  std::string streamRate;
+};
+
+struct DepthStats
+{
+  uint32_t nodes;
+  double p50Sum; //!< Sum of the node p50s, in seconds
+  double worstP99; //!< Largest node p99, in seconds
+  double worstMax; //!< Largest chunk latency, in seconds
+};
+
+struct SweepResult
+{
+  uint32_t attached;
+  uint32_t maxDepth;
+  double meanDepth;
+  double meanP50;
+  double worstP99;
+  std::map<uint32_t, DepthStats> byDepth;
+};
+
+static SweepResult
+RunConfig (const SweepConfig &config, std::string confFile, uint32_t overlayNodes,
+           uint64_t streamBytes, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (config.maxFanout));
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (config.streamRate)));
+  // Joins are spread over the first 51 s; stream once they are done
+  Time streamStart = Seconds (60.0);
+  rootHelper.SetAttribute ("StreamStart", TimeValue (streamStart));
+  rootHelper.SetAttribute ("StreamBytes", UintegerValue (streamBytes));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("MaxFanout", UintegerValue (config.maxFanout));
+  scdtServerHelper.SetAttribute ("StreamRate", DataRateValue (DataRate (config.streamRate)));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  Time rootStart = Seconds (1.0);
+  rootApps.Start (rootStart);
+  rootApps.Stop (Seconds (120.0));
+  // Joins spread uniformly over 50 s from 1 s, alike in every configuration
+  scdtServerHelper.SetArrivals (ScdtServerHelper::ARRIVAL_UNIFORM, Seconds (1), Seconds (50));
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (Seconds (120.0));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Run ();
+
+  std::vector<int32_t> depths = GetScdtTreeDepths (apps, Ipv4Address::ConvertFrom (rootIp));
+
+  SweepResult result = { 0, 0, 0, 0, 0, std::map<uint32_t, DepthStats> () };
+  double depthSum = 0;
+  double p50Sum = 0;
+  uint32_t received = 0;
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      if (depths[k] < 0)
+        {
+          continue;
+        }
+      uint32_t depth = depths[k];
+      result.attached++;
+      result.maxDepth = std::max (result.maxDepth, depth);
+      depthSum += depth;
+      const ScdtLatencyHistogram &latency = app->GetLatencyHistogram ();
+      if (latency.GetCount () > 0)
+        {
+          double p50 = latency.GetQuantile (0.5).GetSeconds ();
+          double p99 = latency.GetQuantile (0.99).GetSeconds ();
+          p50Sum += p50;
+          result.worstP99 = std::max (result.worstP99, p99);
+          received++;
+
+          DepthStats &stats = result.byDepth[depth];
+          stats.nodes++;
+          stats.p50Sum += p50;
+          stats.worstP99 = std::max (stats.worstP99, p99);
+          stats.worstMax = std::max (stats.worstMax, latency.GetMax ().GetSeconds ());
+        }
+    }
+  result.meanDepth = result.attached ? depthSum / result.attached : 0;
+  result.meanP50 = received ? p50Sum / received : 0;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 50;
+  uint64_t streamBytes = 100000;
+  unsigned seed = 1;
+  bool byDepth = false;
+  std::string queuePolicy = "DropOldest";
+  bool bandwidthProbe = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("streamBytes", "Bytes streamed by the root", streamBytes);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.AddValue ("byDepth", "Print the latencies per tree depth", byDepth);
+  cmd.AddValue ("queuePolicy", "Child queue policy: Block, DropOldest or SkipToLatest", queuePolicy);
+  cmd.AddValue ("bandwidthProbe", "Select parents on RTT and packet-pair bandwidth", bandwidthProbe);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  Config::SetDefault ("ns3::ScdtServer::ChildQueuePolicy", StringValue (queuePolicy));
+  Config::SetDefault ("ns3::ScdtServer::BandwidthProbe", BooleanValue (bandwidthProbe));
+
+  SweepConfig configs[] = {
+    { "fixed-4", 4, "1Mbps" },
+    { "fixed-2", 2, "1Mbps" },
+    { "fixed-8", 8, "1Mbps" },
+    { "auto-1Mbps", 0, "1Mbps" },
+    { "auto-2Mbps", 0, "2Mbps" },
+    { "auto-500kbps", 0, "500kbps" },
+  };
+
+  std::cout << std::left << std::setw (14) << "config" << std::right
+            << std::setw (10) << "attached" << std::setw (10) << "maxDepth"
+            << std::setw (11) << "meanDepth" << std::setw (14) << "meanP50(s)"
+            << std::setw (13) << "worstP99(s)" << std::endl;
+  for (uint32_t c = 0; c < sizeof (configs) / sizeof (configs[0]); c++)
+    {
+      SweepResult r = RunConfig (configs[c], confFile, overlayNodes, streamBytes, seed);
+      std::cout << std::left << std::setw (14) << configs[c].name << std::right
+                << std::setw (10) << r.attached << std::setw (10) << r.maxDepth
+                << std::fixed << std::setprecision (2)
+                << std::setw (11) << r.meanDepth
+                << std::setprecision (4)
+                << std::setw (14) << r.meanP50 << std::setw (13) << r.worstP99
+                << std::endl;
+      if (!byDepth)
+        {
+          continue;
+        }
+      for (std::map<uint32_t, DepthStats>::const_iterator it = r.byDepth.begin ();
+           it != r.byDepth.end (); ++it)
+        {
+          std::cout << "    depth " << std::setw (3) << it->first
+                    << std::setw (7) << it->second.nodes << " nodes"
+                    << "  meanP50 " << it->second.p50Sum / it->second.nodes
+                    << "  worstP99 " << it->second.worstP99
+                    << "  max " << it->second.worstMax << std::endl;
+        }
+    }
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Join cost with and without partial probing of TRY candidates.
+//
+// Every configuration is run on the same topology and access links
+// (same seed) and only differs by how many candidates of a TRY list are
+// probed, and which: "all" probes every candidate; "vivaldi" k sets
+// CoordinateProbes and probes the k candidates with the lowest RTT
+// predicted by the coordinates; "rank" k sets TryProbes and probes the
+// first k of the list, as ranked by the parent.  Control messages are
+// counted over all the nodes, root included, and divided by the number
+// of joiners.
+//
+//   ./waf --run "scdt-join-probes --overlayNodes=10000 --seed=1"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtJoinProbes");
+
+struct JoinResult
+{
+  uint32_t attached;
+  double meanJoin; //!< Mean join latency of the attached nodes, in seconds
+  double worstJoin; //!< Largest join latency, in seconds
+  double controlPerJoin; //!< Control datagrams sent per joiner
+};
+
+static JoinResult
+RunConfig (std::string attribute, uint32_t probes, std::string confFile, uint32_t overlayNodes,
+           uint32_t maxFanout, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  scdtServerHelper.SetAttribute (attribute, UintegerValue (probes));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (Seconds (120.0));
+  // Joins spread uniformly over 50 s from 2 s, alike in every configuration
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (Seconds (120.0));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Run ();
+
+  JoinResult result = { 0, 0, 0, 0 };
+  double joinSum = 0;
+  uint64_t control = rootApps.Get (0)->GetObject<ScdtServer> ()->GetControlTx ();
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      control += app->GetControlTx ();
+      if (app->IsAttached ())
+        {
+          result.attached++;
+          joinSum += app->GetJoinLatency ().GetSeconds ();
+          result.worstJoin = std::max (result.worstJoin, app->GetJoinLatency ().GetSeconds ());
+        }
+    }
+  result.meanJoin = result.attached ? joinSum / result.attached : 0;
+  result.controlPerJoin = static_cast<double> (control) / overlayNodes;
+
+  Simulator::Destroy ();
+  return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 1000;
+  uint32_t maxFanout = 8;
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("maxFanout", "Maximum number of children, i.e. of candidates per TRY", maxFanout);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  uint32_t probes[] = { 0, 1, 2, 3 };
+
+  std::string attributes[] = { "CoordinateProbes", "TryProbes" };
+  std::string labels[] = { "vivaldi ", "rank " };
+
+  std::cout << std::left << std::setw (12) << "probes" << std::right
+            << std::setw (10) << "attached" << std::setw (12) << "ctrl/join"
+            << std::setw (14) << "meanJoin(s)" << std::setw (14) << "worstJoin(s)" << std::endl;
+  for (uint32_t a = 0; a < 2; a++)
+    {
+      for (uint32_t c = 0; c < sizeof (probes) / sizeof (probes[0]); c++)
+        {
+          if (probes[c] >= maxFanout || (a > 0 && probes[c] == 0))
+            {
+              // Probing them all does not depend on the ranking
+              continue;
+            }
+          JoinResult r = RunConfig (attributes[a], probes[c], confFile, overlayNodes, maxFanout, seed);
+          std::cout << std::left << std::setw (12)
+                    << (probes[c] ? labels[a] + std::to_string (probes[c]) : "all") << std::right
+                    << std::setw (10) << r.attached
+                    << std::fixed << std::setprecision (2)
+                    << std::setw (12) << r.controlPerJoin
+                    << std::setprecision (4)
+                    << std::setw (14) << r.meanJoin << std::setw (14) << r.worstJoin
+                    << std::endl;
+        }
+    }
+
+  return 0;
+}
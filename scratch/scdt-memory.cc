@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Memory footprint of an SCDT overlay node.
+//
+// Creates overlayNodes nodes and reports the resident set size they add,
+// in bytes per node, after each step: the bare nodes, the internet
+// stack, and the ScdtServer applications once started (control and data
+// sockets registered, per-child state reserved for the fan-out).  The
+// nodes have no links, so the joins go nowhere; what is measured is the
+// state each node carries, not traffic.  The RSS is read from
+// /proc/self/status, so the numbers are only available on Linux.
+//
+//   ./waf --run "scdt-memory --overlayNodes=100000 --maxFanout=4"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtMemory");
+
+/**
+ * \returns the resident set size of the process in bytes, or 0 if
+ * unknown
+ */
+static uint64_t
+GetRss (void)
+{
+  std::ifstream status ("/proc/self/status");
+  std::string line;
+  while (std::getline (status, line))
+    {
+      if (line.compare (0, 6, "VmRSS:") == 0)
+        {
+          std::istringstream fields (line.substr (6));
+          uint64_t kb = 0;
+          fields >> kb;
+          return kb * 1024;
+        }
+    }
+  return 0;
+}
+
+static void
+Report (std::string step, uint64_t before, uint64_t after, uint32_t nodes)
+{
+  uint64_t added = after > before ? after - before : 0;
+  std::cout << std::left << std::setw (14) << step << std::right
+            << std::setw (14) << added / 1024
+            << std::setw (14) << added / nodes << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t overlayNodes = 10000;
+  uint32_t maxFanout = 4;
+  bool stack = true;
+
+  CommandLine cmd;
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("maxFanout", "Maximum number of children, which sizes the per-child state", maxFanout);
+  cmd.AddValue ("stack", "Install the internet stack and start the applications", stack);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (14) << "step" << std::right
+            << std::setw (14) << "added(KiB)" << std::setw (14) << "bytes/node" << std::endl;
+
+  uint64_t rss = GetRss ();
+  NodeContainer nodes;
+  nodes.Create (overlayNodes);
+  uint64_t now = GetRss ();
+  Report ("nodes", rss, now, overlayNodes);
+  rss = now;
+
+  if (stack)
+    {
+      InternetStackHelper internet;
+      internet.Install (nodes);
+      now = GetRss ();
+      Report ("stack", rss, now, overlayNodes);
+      rss = now;
+    }
+
+  ScdtServerHelper helper (Ipv4Address ("11.0.0.1"), 9, 0);
+  helper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  helper.SetAttribute ("HeartbeatInterval", TimeValue (Seconds (0)));
+  ApplicationContainer apps = helper.Install (nodes);
+  now = GetRss ();
+  Report ("applications", rss, now, overlayNodes);
+  rss = now;
+
+  if (stack)
+    {
+      // Start the applications, then stop before the first ATTACH times out
+      apps.Start (Seconds (0.1));
+      Simulator::Stop (Seconds (0.5));
+      Simulator::Run ();
+      now = GetRss ();
+      Report ("started", rss, now, overlayNodes);
+    }
+
+  std::cout << "total " << GetRss () / overlayNodes << " bytes/node" << std::endl;
+  Simulator::Destroy ();
+  return 0;
+}
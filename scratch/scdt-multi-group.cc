@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Several SCDT groups (channels) over the same overlay.
+//
+// Every overlay node runs one ScdtServer per group; the root of group g
+// is overlay node g.  All the groups of a node share its control and
+// data sockets and its RTT measurements through the node's
+// ScdtSocketMux, so the socket count per node stays at two whatever the
+// number of groups, and PINGs are only sent to peers no other group
+// measured recently.
+//
+//   ./waf --run "scdt-multi-group --overlayNodes=50 --groups=10"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtMultiGroup");
+
+static void
+CountSockets (NodeContainer nodes, uint32_t *maxSockets)
+{
+  for (uint32_t k = 0; k < nodes.GetN (); k++)
+    {
+      Ptr<ScdtSocketMux> mux = nodes.Get (k)->GetObject<ScdtSocketMux> ();
+      if (mux != 0)
+        {
+          *maxSockets = std::max (*maxSockets, mux->GetNSockets ());
+        }
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 50;
+  uint32_t groups = 10;
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("groups", "Number of groups, each rooted at a different overlay node", groups);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+  NS_ABORT_MSG_IF (groups == 0 || groups > overlayNodes, "Need between 1 and overlayNodes groups");
+
+  srand (seed);
+  // The roots are overlay nodes: no separate root node
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes, false);
+  NodeContainer overlayContainer = topology.overlay;
+  const std::vector<Ipv4Address> &overlayIps = topology.overlayIps;
+
+  std::vector<ApplicationContainer> groupApps;
+  for (uint32_t g = 0; g < groups; g++)
+    {
+      ScdtServerHelper rootHelper (overlayIps[g], 9, 1);
+      rootHelper.SetAttribute ("GroupId", UintegerValue (g));
+      rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (60.0)));
+      rootHelper.SetAttribute ("StreamBytes", UintegerValue (100000));
+      ApplicationContainer rootApps = rootHelper.Install (overlayContainer.Get (g));
+      rootApps.Start (Seconds (1.0));
+      rootApps.Stop (Seconds (120.0));
+
+      ScdtServerHelper memberHelper (overlayIps[g], 9, 0);
+      memberHelper.SetAttribute ("GroupId", UintegerValue (g));
+      ApplicationContainer apps;
+      for (uint32_t k = 0; k < overlayNodes; k++)
+        {
+          if (k != g)
+            {
+              apps.Add (memberHelper.Install (overlayContainer.Get (k)));
+            }
+        }
+      // Arrivals only: a node runs one application per group
+      memberHelper.AssignStreams (NodeContainer (), 100 + 2 * g);
+      memberHelper.ScheduleArrivals (apps);
+      apps.Stop (Seconds (120.0));
+      groupApps.push_back (apps);
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // Sockets are released when the groups stop, so count them mid-run
+  uint32_t maxSockets = 0;
+  Simulator::Schedule (Seconds (100.0), &CountSockets, overlayContainer, &maxSockets);
+  Simulator::Run ();
+
+  std::cout << std::setw (6) << "group" << std::setw (10) << "attached" << std::setw (10) << "received"
+            << std::setw (14) << "meanJoin(s)" << std::setw (13) << "p99Lat(s)" << std::endl;
+  for (uint32_t g = 0; g < groups; g++)
+    {
+      uint32_t attached = 0;
+      uint32_t received = 0;
+      double joinSum = 0;
+      double worstP99 = 0;
+      for (uint32_t k = 0; k < groupApps[g].GetN (); k++)
+        {
+          Ptr<ScdtServer> app = groupApps[g].Get (k)->GetObject<ScdtServer> ();
+          if (app->IsAttached ())
+            {
+              attached++;
+              joinSum += app->GetJoinLatency ().GetSeconds ();
+            }
+          if (app->GetLatencyHistogram ().GetCount () > 0)
+            {
+              received++;
+              worstP99 = std::max (worstP99, app->GetLatencyHistogram ().GetQuantile (0.99).GetSeconds ());
+            }
+        }
+      std::cout << std::setw (6) << g << std::setw (10) << attached << std::setw (10) << received
+                << std::fixed << std::setprecision (4)
+                << std::setw (14) << (attached ? joinSum / attached : 0)
+                << std::setw (13) << worstP99 << std::endl;
+    }
+  std::cout << "sockets per node (shared listening/control): at most " << maxSockets << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Convergence of the tree under background optimization.
+//
+// The same session (same seed, topology, access links and join times)
+// is run without optimization and with the given OptimizeInterval.  The
+// tree is sampled every sampleInterval once the joins are over: mean
+// depth, mean stream delay (the smoothed chunk latency of each member),
+// parent switches so far and control datagrams sent so far per member,
+// so the overhead of the rounds shows next to what they gain.
+//
+//   ./waf --run "scdt-optimize --overlayNodes=200 --optimizeInterval=10s"
+
+#include <string>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/brite-module.h"
+#include "scdt-brite-topology.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtOptimize");
+
+static void
+Sample (std::string label, ApplicationContainer apps, Ptr<ScdtServer> root, Ipv4Address rootAddr,
+        Time interval, Time stop)
+{
+  std::vector<int32_t> depths = GetScdtTreeDepths (apps, rootAddr);
+
+  uint32_t attached = 0;
+  uint32_t measured = 0;
+  double depthSum = 0;
+  double delaySum = 0;
+  uint32_t switches = 0;
+  uint64_t control = root->GetControlTx ();
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> app = apps.Get (k)->GetObject<ScdtServer> ();
+      control += app->GetControlTx ();
+      switches += app->GetParentSwitches ();
+      if (depths[k] < 0)
+        {
+          continue;
+        }
+      uint32_t depth = depths[k];
+      attached++;
+      depthSum += depth;
+      if (app->GetStreamDelay () != Time::Max ())
+        {
+          delaySum += app->GetStreamDelay ().GetSeconds ();
+          measured++;
+        }
+    }
+
+  std::cout << std::left << std::setw (10) << label << std::right
+            << std::setw (8) << Simulator::Now ().GetSeconds ()
+            << std::setw (10) << attached
+            << std::fixed << std::setprecision (2)
+            << std::setw (11) << (attached ? depthSum / attached : 0)
+            << std::setprecision (4)
+            << std::setw (14) << (measured ? delaySum / measured : 0)
+            << std::setw (10) << switches
+            << std::setprecision (1)
+            << std::setw (12) << static_cast<double> (control) / apps.GetN ()
+            << std::endl;
+  std::cout.unsetf (std::ios::floatfield);
+
+  if (Simulator::Now () + interval < stop)
+    {
+      Simulator::Schedule (interval, &Sample, label, apps, root, rootAddr, interval, stop);
+    }
+}
+
+static void
+RunConfig (std::string label, Time optimizeInterval, double switchThreshold, std::string confFile,
+           uint32_t overlayNodes, uint32_t maxFanout, Time sampleInterval, Time stop, unsigned seed)
+{
+  srand (seed);
+
+  ScdtBriteTopology topology = BuildScdtBriteTopology (confFile, overlayNodes);
+  NodeContainer overlayContainer = topology.overlay;
+  Address rootIp = topology.rootIp;
+
+  ScdtServerHelper rootHelper (rootIp, 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("200kbps")));
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (5.0)));
+  ApplicationContainer rootApps = rootHelper.Install (topology.root);
+
+  ScdtServerHelper scdtServerHelper (rootIp, 9, 0);
+  scdtServerHelper.SetAttribute ("MaxFanout", UintegerValue (maxFanout));
+  scdtServerHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("200kbps")));
+  scdtServerHelper.SetAttribute ("OptimizeInterval", TimeValue (optimizeInterval));
+  scdtServerHelper.SetAttribute ("SwitchThreshold", DoubleValue (switchThreshold));
+  ApplicationContainer apps = scdtServerHelper.Install (overlayContainer);
+
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (stop);
+  // Joins spread uniformly over 50 s from 2 s, alike in every configuration
+  scdtServerHelper.AssignStreams (overlayContainer, 100);
+  scdtServerHelper.ScheduleArrivals (apps);
+  apps.Stop (stop);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Simulator::Schedule (Seconds (60.0), &Sample, label, apps, rootApps.Get (0)->GetObject<ScdtServer> (),
+                       Ipv4Address::ConvertFrom (rootIp), sampleInterval, stop);
+  Simulator::Stop (stop);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string confFile = "src/brite/examples/conf_files/scdt.conf";
+  uint32_t overlayNodes = 200;
+  uint32_t maxFanout = 4;
+  Time optimizeInterval = Seconds (10.0);
+  double switchThreshold = 0.2;
+  Time sampleInterval = Seconds (30.0);
+  Time stop = Seconds (300.0);
+  unsigned seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("confFile", "BRITE conf file", confFile);
+  cmd.AddValue ("overlayNodes", "Number of overlay nodes", overlayNodes);
+  cmd.AddValue ("maxFanout", "Maximum number of children", maxFanout);
+  cmd.AddValue ("optimizeInterval", "Mean time between optimization rounds", optimizeInterval);
+  cmd.AddValue ("switchThreshold", "Stream delay fraction to save before switching parent", switchThreshold);
+  cmd.AddValue ("sampleInterval", "Time between two samples of the tree", sampleInterval);
+  cmd.AddValue ("stop", "End of the session", stop);
+  cmd.AddValue ("seed", "Seed for the topology, access links and join times", seed);
+  cmd.Parse (argc, argv);
+  RngSeedManager::SetRun (seed);
+
+  std::cout << std::left << std::setw (10) << "optimize" << std::right
+            << std::setw (8) << "t(s)" << std::setw (10) << "attached"
+            << std::setw (11) << "meanDepth" << std::setw (14) << "meanDelay(s)"
+            << std::setw (10) << "switches" << std::setw (12) << "ctrl/node" << std::endl;
+  RunConfig ("off", Seconds (0), switchThreshold, confFile, overlayNodes, maxFanout, sampleInterval, stop, seed);
+  std::ostringstream label;
+  label << optimizeInterval.GetSeconds () << "s";
+  RunConfig (label.str (), optimizeInterval, switchThreshold, confFile, overlayNodes, maxFanout,
+             sampleInterval, stop, seed);
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// Summarise the binary file an ScdtStatsCollector writes.
+//
+// Prints the count, minimum, mean and maximum of every column over the
+// rows that have a value, then the session histograms.  With
+// --streamStart, the time the stream started at the root, also prints
+// the completion times of the transfer: when the last node received its
+// last chunk, and the mean over the nodes that received any.
+//
+//   ./waf --run "scdt-stats-summary --file=scdt-stats.bin --streamStart=61"
+
+#include "ns3/core-module.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ScdtStatsSummary");
+
+struct Column
+{
+  std::string name;
+  std::vector<double> values;
+};
+
+static bool
+ReadU32 (std::ifstream & in, uint32_t & value)
+{
+  return static_cast<bool> (in.read (reinterpret_cast<char *> (&value), sizeof (value)));
+}
+
+static bool
+ReadName (std::ifstream & in, std::string & name)
+{
+  uint16_t length;
+  if (!in.read (reinterpret_cast<char *> (&length), sizeof (length)))
+    {
+      return false;
+    }
+  name.resize (length);
+  return length == 0 || static_cast<bool> (in.read (&name[0], length));
+}
+
+static bool
+ReadDoubles (std::ifstream & in, std::vector<double> & values, uint32_t n)
+{
+  values.resize (n);
+  return n == 0 || static_cast<bool> (in.read (reinterpret_cast<char *> (&values[0]), n * sizeof (double)));
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string file = "scdt-stats.bin";
+  double streamStart = -1;
+
+  CommandLine cmd;
+  cmd.AddValue ("file", "Binary file written by ScdtStatsCollector", file);
+  cmd.AddValue ("streamStart", "Time the stream started at the root, in seconds; negative to skip "
+                "the completion times", streamStart);
+  cmd.Parse (argc, argv);
+
+  std::ifstream in (file.c_str (), std::ios::binary);
+  char magic[4];
+  uint32_t version, nColumns, nRows;
+  if (!in.read (magic, 4) || std::string (magic, 4) != "SCDT"
+      || !ReadU32 (in, version) || !ReadU32 (in, nColumns) || !ReadU32 (in, nRows))
+    {
+      std::cerr << file << ": not an SCDT stats file" << std::endl;
+      return 1;
+    }
+  if (version != 1)
+    {
+      std::cerr << file << ": unsupported version " << version << std::endl;
+      return 1;
+    }
+
+  std::vector<Column> columns (nColumns);
+  for (uint32_t c = 0; c < nColumns; c++)
+    {
+      if (!ReadName (in, columns[c].name) || !ReadDoubles (in, columns[c].values, nRows))
+        {
+          std::cerr << file << ": truncated column " << c << std::endl;
+          return 1;
+        }
+    }
+
+  std::cout << nRows << " rows" << std::endl;
+  std::cout << std::left << std::setw (18) << "column" << std::right
+            << std::setw (10) << "count" << std::setw (16) << "min"
+            << std::setw (16) << "mean" << std::setw (16) << "max" << std::endl;
+  for (uint32_t c = 0; c < nColumns; c++)
+    {
+      uint32_t count = 0;
+      double sum = 0;
+      double min = 0;
+      double max = 0;
+      for (uint32_t r = 0; r < nRows; r++)
+        {
+          double v = columns[c].values[r];
+          if (std::isnan (v))
+            {
+              continue;
+            }
+          min = count ? std::min (min, v) : v;
+          max = count ? std::max (max, v) : v;
+          sum += v;
+          count++;
+        }
+      std::cout << std::left << std::setw (18) << columns[c].name << std::right
+                << std::setw (10) << count
+                << std::setprecision (6)
+                << std::setw (16) << min << std::setw (16) << (count ? sum / count : 0)
+                << std::setw (16) << max << std::endl;
+    }
+
+  uint32_t nHistograms;
+  if (ReadU32 (in, nHistograms) && nHistograms > 0)
+    {
+      std::cout << std::endl << std::left << std::setw (18) << "histogram" << std::right
+                << std::setw (10) << "count" << std::setw (12) << "min(s)" << std::setw (12) << "mean(s)"
+                << std::setw (12) << "p50(s)" << std::setw (12) << "p90(s)" << std::setw (12) << "p99(s)"
+                << std::setw (12) << "max(s)" << std::endl;
+      for (uint32_t h = 0; h < nHistograms; h++)
+        {
+          std::string name;
+          std::vector<double> summary;
+          if (!ReadName (in, name) || !ReadDoubles (in, summary, 7))
+            {
+              std::cerr << file << ": truncated histogram " << h << std::endl;
+              return 1;
+            }
+          std::cout << std::left << std::setw (18) << name << std::right
+                    << std::setw (10) << static_cast<uint64_t> (summary[0]) << std::fixed << std::setprecision (6);
+          for (uint32_t k = 1; k < summary.size (); k++)
+            {
+              std::cout << std::setw (12) << summary[k];
+            }
+          std::cout.unsetf (std::ios::fixed);
+          std::cout << std::endl;
+        }
+    }
+
+  if (streamStart >= 0)
+    {
+      // The columns ScdtServer reports
+      const Column *lastChunk = 0;
+      const Column *root = 0;
+      for (uint32_t c = 0; c < nColumns; c++)
+        {
+          if (columns[c].name == "lastChunk")
+            {
+              lastChunk = &columns[c];
+            }
+          else if (columns[c].name == "root")
+            {
+              root = &columns[c];
+            }
+        }
+      uint32_t nodes = 0;
+      uint32_t received = 0;
+      double sum = 0;
+      double last = 0;
+      for (uint32_t r = 0; r < nRows; r++)
+        {
+          if (root != 0 && root->values[r] != 0)
+            {
+              continue;
+            }
+          nodes++;
+          if (lastChunk == 0 || std::isnan (lastChunk->values[r]))
+            {
+              continue;
+            }
+          received++;
+          sum += lastChunk->values[r] - streamStart;
+          last = std::max (last, lastChunk->values[r]);
+        }
+      std::cout << std::endl << received << " of " << nodes << " nodes received the stream" << std::endl;
+      if (received > 0)
+        {
+          std::cout << "Last chunk at " << last << "s, "
+                    << last - streamStart << "s after the stream started" << std::endl;
+          std::cout << "Mean completion " << sum / received << "s" << std::endl;
+        }
+    }
+
+  return 0;
+}
@@ -21,12 +21,21 @@
 #include "ns3/scdt-server.h"
 #include "ns3/uinteger.h"
 #include "ns3/names.h"
+#include "ns3/ipv4.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
+NS_LOG_COMPONENT_DEFINE ("ScdtServerHelper");
+
 ScdtServerHelper::ScdtServerHelper (Address address, uint16_t port, uint8_t isRoot)
 {
   m_factory.SetTypeId (ScdtServer::GetTypeId ());
+  InitArrivals ();
   SetAttribute ("RemoteAddress", AddressValue (address));
   SetAttribute ("RemotePort", UintegerValue (port));
   SetAttribute ("IsRoot", UintegerValue (isRoot));
@@ -35,6 +44,7 @@ ScdtServerHelper::ScdtServerHelper (Address address, uint16_t port, uint8_t isRo
 ScdtServerHelper::ScdtServerHelper (Address address, uint16_t port)
 {
   m_factory.SetTypeId (ScdtServer::GetTypeId ());
+  InitArrivals ();
   SetAttribute ("RemoteAddress", AddressValue (address));
   SetAttribute ("RemotePort", UintegerValue (port));
 }
@@ -42,9 +52,22 @@ ScdtServerHelper::ScdtServerHelper (Address address, uint16_t port)
 ScdtServerHelper::ScdtServerHelper (Address address)
 {
   m_factory.SetTypeId (ScdtServer::GetTypeId ());
+  InitArrivals ();
   SetAttribute ("RemoteAddress", AddressValue (address));
 }
 
+void
+ScdtServerHelper::InitArrivals (void)
+{
+  m_arrivalModel = ARRIVAL_UNIFORM;
+  m_arrivalStart = Seconds (2);
+  m_arrivalWindow = Seconds (50);
+  m_flashCrowdSize = 0;
+  m_flashCrowdBurst = MilliSeconds (100);
+  m_arrivalUniform = CreateObject<UniformRandomVariable> ();
+  m_arrivalGap = CreateObject<ExponentialRandomVariable> ();
+}
+
 void 
 ScdtServerHelper::SetAttribute (
   std::string name, 
@@ -71,6 +94,154 @@ ScdtServerHelper::SetFill (Ptr<Application> app, uint8_t *fill, uint32_t fillLen
   app->GetObject<ScdtServer>()->SetFill (fill, fillLength, dataLength);
 }
 
+void
+ScdtServerHelper::AddEntryPoint (Ptr<Application> app, Address entry)
+{
+  app->GetObject<ScdtServer>()->AddEntryPoint (entry);
+}
+
+void
+ScdtServerHelper::SetTree (const ScdtTree &tree)
+{
+  m_tree = tree;
+}
+
+void
+ScdtServerHelper::SetArrivals (ArrivalModel model, Time start, Time window)
+{
+  NS_ASSERT_MSG (!start.IsStrictlyNegative () && !window.IsStrictlyNegative (),
+                 "Arrivals cannot start or spread over a negative time");
+  m_arrivalModel = model;
+  m_arrivalStart = start;
+  m_arrivalWindow = window;
+}
+
+void
+ScdtServerHelper::SetArrivals (std::string model, Time start, Time window)
+{
+  if (model == "Uniform")
+    {
+      SetArrivals (ARRIVAL_UNIFORM, start, window);
+    }
+  else if (model == "Poisson")
+    {
+      SetArrivals (ARRIVAL_POISSON, start, window);
+    }
+  else if (model == "FlashCrowd")
+    {
+      SetArrivals (ARRIVAL_FLASH_CROWD, start, window);
+    }
+  else if (model == "Diurnal")
+    {
+      SetArrivals (ARRIVAL_DIURNAL, start, window);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown arrival model " << model
+                      << "; expected Uniform, Poisson, FlashCrowd or Diurnal");
+    }
+}
+
+void
+ScdtServerHelper::SetFlashCrowd (uint32_t size, Time burst)
+{
+  NS_ASSERT_MSG (!burst.IsStrictlyNegative (), "A burst cannot last a negative time");
+  m_flashCrowdSize = size;
+  m_flashCrowdBurst = burst;
+}
+
+Time
+ScdtServerHelper::DrawDiurnal (void)
+{
+  // The rate grows as (1 - cos (pi x)) / 2 over the window, x in [0, 1],
+  // whose CDF x - sin (pi x) / pi is inverted by bisection
+  double u = m_arrivalUniform->GetValue (0, 1);
+  double low = 0;
+  double high = 1;
+  for (uint32_t k = 0; k < 40; k++)
+    {
+      double x = (low + high) / 2;
+      if (x - std::sin (M_PI * x) / M_PI < u)
+        {
+          low = x;
+        }
+      else
+        {
+          high = x;
+        }
+    }
+  return NanoSeconds (static_cast<int64_t> ((low + high) / 2 * m_arrivalWindow.GetNanoSeconds ()));
+}
+
+std::vector<Time>
+ScdtServerHelper::ScheduleArrivals (ApplicationContainer apps)
+{
+  NS_LOG_FUNCTION (this << apps.GetN () << m_arrivalModel);
+  std::vector<Time> starts;
+  double window = m_arrivalWindow.GetSeconds ();
+  uint32_t burst = m_flashCrowdSize == 0 ? apps.GetN () : std::min (m_flashCrowdSize, apps.GetN ());
+  // Poisson process with its n arrivals in the window: n + 1 exponential
+  // gaps, scaled so that the last one ends with the window
+  std::vector<double> arrivals;
+  if (m_arrivalModel == ARRIVAL_POISSON)
+    {
+      double sum = 0;
+      for (uint32_t k = 0; k <= apps.GetN (); k++)
+        {
+          sum += m_arrivalGap->GetValue (1, 0);
+          arrivals.push_back (sum);
+        }
+      for (uint32_t k = 0; k < arrivals.size (); k++)
+        {
+          arrivals[k] *= window / sum;
+        }
+    }
+  for (uint32_t k = 0; k < apps.GetN (); k++)
+    {
+      Time start;
+      switch (m_arrivalModel)
+        {
+        case ARRIVAL_POISSON:
+          start = m_arrivalStart + Seconds (arrivals[k]);
+          break;
+        case ARRIVAL_FLASH_CROWD:
+          start = m_arrivalStart + Seconds (m_arrivalUniform->GetValue (0, k < burst ? m_flashCrowdBurst.GetSeconds () : window));
+          break;
+        case ARRIVAL_DIURNAL:
+          start = m_arrivalStart + DrawDiurnal ();
+          break;
+        case ARRIVAL_UNIFORM:
+        default:
+          start = m_arrivalStart + Seconds (m_arrivalUniform->GetValue (0, window));
+          break;
+        }
+      apps.Get (k)->SetStartTime (start);
+      starts.push_back (start);
+    }
+  return starts;
+}
+
+int64_t
+ScdtServerHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  m_arrivalUniform->SetStream (currentStream++);
+  m_arrivalGap->SetStream (currentStream++);
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = (*i);
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<ScdtServer> server = DynamicCast<ScdtServer> (node->GetApplication (j));
+          if (server)
+            {
+              currentStream += server->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
 ApplicationContainer
 ScdtServerHelper::Install (Ptr<Node> node) const
 {
@@ -99,10 +270,64 @@ ScdtServerHelper::Install (NodeContainer c) const
 Ptr<Application>
 ScdtServerHelper::InstallPriv (Ptr<Node> node) const
 {
-  Ptr<Application> app = m_factory.Create<ScdtServer> ();
+  Ptr<ScdtServer> app = m_factory.Create<ScdtServer> ();
   node->AddApplication (app);
+  if (m_tree.GetN () > 0)
+    {
+      ApplyTree (node, app);
+    }
 
   return app;
 }
 
+void
+ScdtServerHelper::ApplyTree (Ptr<Node> node, Ptr<ScdtServer> server) const
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ipv4Address self;
+  bool found = false;
+  for (uint32_t i = 0; ipv4 != 0 && i < ipv4->GetNInterfaces () && !found; i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i) && !found; j++)
+        {
+          self = ipv4->GetAddress (i, j).GetLocal ();
+          found = self != Ipv4Address::GetLoopback () && m_tree.Contains (self);
+        }
+    }
+  if (!found)
+    {
+      return;
+    }
+
+  // Peers are reached on the control port all the members share
+  UintegerValue port;
+  server->GetAttribute ("RemotePort", port);
+  if (self != m_tree.GetRoot ())
+    {
+      std::vector<Ipv4Address> ancestors = m_tree.GetAncestors (self);
+      std::vector<Address> addresses;
+      for (uint32_t k = 0; k < ancestors.size (); k++)
+        {
+          addresses.push_back (InetSocketAddress (ancestors[k], port.Get ()));
+        }
+      if (!addresses.empty ())
+        {
+          server->SetPresetParent (addresses, m_tree.GetDepth (self), m_tree.GetRootLatency (self));
+        }
+    }
+  std::vector<Ipv4Address> children = m_tree.GetChildren (self);
+  // An automatic fan-out is only known when the application starts,
+  // where StartPreset checks it
+  UintegerValue maxFanout;
+  server->GetAttribute ("MaxFanout", maxFanout);
+  NS_ABORT_MSG_IF (maxFanout.Get () != 0 && children.size () > maxFanout.Get (),
+                   "Node " << self << " has " << children.size () << " children in the tree, more than its MaxFanout of "
+                           << maxFanout.Get ());
+  for (uint32_t k = 0; k < children.size (); k++)
+    {
+      server->AddPresetChild (InetSocketAddress (children[k], port.Get ()),
+                              m_tree.GetRtt (children[k]), m_tree.GetSubtreeSize (children[k]));
+    }
+}
+
 } // namespace ns3
@@ -21,14 +21,21 @@
 #define SCDT_SERVER_HELPER_H
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 #include "ns3/application-container.h"
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "scdt-tree.h"
 
 namespace ns3 {
 
+class ScdtServer;
+
 /**
  * \ingroup udpecho
  * \brief Create an application which sends a UDP packet and waits for an echo of this packet
@@ -36,6 +43,15 @@ namespace ns3 {
 class ScdtServerHelper
 {
 public:
+  /// How the start times of the applications are spread, see SetArrivals
+  enum ArrivalModel
+  {
+    ARRIVAL_UNIFORM,      //!< Independently and uniformly over the window
+    ARRIVAL_POISSON,      //!< Poisson process with its n arrivals in the window, window / (n + 1) apart on average
+    ARRIVAL_FLASH_CROWD,  //!< A burst at the start, the others uniformly over the window
+    ARRIVAL_DIURNAL       //!< Rate ramping up from zero to its peak at the end of the window
+  };
+
   ScdtServerHelper (Address ip, uint16_t port, uint8_t isRoot);
   /**
    * Create ScdtServerHelper which will make life easier for people trying
@@ -114,6 +130,79 @@ public:
    */
   void SetFill (Ptr<Application> app, uint8_t *fill, uint32_t fillLength, uint32_t dataLength);
 
+  /**
+   * Given a pointer to a ScdtServer application, add a node it starts
+   * joining from instead of the root.
+   *
+   * \param app Smart pointer to the application (real type must be ScdtServer).
+   * \param entry The control address (IP and port) of a member of the group.
+   */
+  void AddEntryPoint (Ptr<Application> app, Address entry);
+
+  /**
+   * Install the applications of the nodes of a tree already attached,
+   * skipping the join phase.
+   *
+   * A node is in the tree when one of its IPv4 addresses is.  Its
+   * application starts below its parent, with its children connected
+   * (see ScdtServer::SetPresetParent and ScdtServer::AddPresetChild);
+   * the applications of the other nodes join as usual.  The applications
+   * of the tree must all start at the same time, and share the
+   * RemotePort attribute.  Install aborts on a node with more children
+   * in the tree than its MaxFanout.
+   *
+   * \param tree The tree, from a snapshot of an earlier run or built offline.
+   */
+  void SetTree (const ScdtTree &tree);
+
+  /**
+   * Choose how ScheduleArrivals spreads start times.
+   *
+   * By default applications start uniformly over the 50 s after 2 s.
+   *
+   * \param model The arrival model.
+   * \param start The earliest start time.
+   * \param window The time over which the arrivals are spread.
+   */
+  void SetArrivals (ArrivalModel model, Time start, Time window);
+  /**
+   * Choose the arrival model by name, as given on the command line.
+   *
+   * \param model "Uniform", "Poisson", "FlashCrowd" or "Diurnal".
+   * \param start The earliest start time.
+   * \param window The time over which the arrivals are spread.
+   */
+  void SetArrivals (std::string model, Time start, Time window);
+  /**
+   * Set the burst of ARRIVAL_FLASH_CROWD: the first size applications
+   * of the container start uniformly over the burst time at the start.
+   *
+   * \param size The number of applications in the burst, 0 for all.
+   * \param burst The duration of the burst.
+   */
+  void SetFlashCrowd (uint32_t size, Time burst);
+  /**
+   * Set the start times of applications from the arrival model.
+   *
+   * Draws from the random variable streams of the helper; call
+   * AssignStreams first for start times that do not depend on the
+   * other random variables of the simulation.
+   *
+   * \param apps The applications, in arrival order for the Poisson process
+   *        and the flash crowd.
+   * \returns The start times, in the order of the container.
+   */
+  std::vector<Time> ScheduleArrivals (ApplicationContainer apps);
+  /**
+   * Assign fixed random variable streams to the arrival model, then to
+   * the ScdtServer applications of the nodes.
+   *
+   * \param c The nodes whose ScdtServer applications get streams.
+   * \param stream The first stream index to use.
+   * \returns The number of stream indices used.
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
   /**
    * Create a udp echo client application on the specified node.  The Node
    * is provided as a Ptr<Node>.
@@ -147,6 +236,14 @@ public:
   ApplicationContainer Install (NodeContainer c) const;
 
 private:
+  /**
+   * Set the default arrival model and create its random variables.
+   */
+  void InitArrivals (void);
+  /**
+   * \returns A start time offset from the diurnal ramp, in [0, window].
+   */
+  Time DrawDiurnal (void);
   /**
    * Install an ns3::ScdtServer on the node configured with all the
    * attributes set with SetAttribute.
@@ -155,7 +252,22 @@ private:
    * \returns Ptr to the application installed.
    */
   Ptr<Application> InstallPriv (Ptr<Node> node) const;
+  /**
+   * Give an application its place in the tree, if its node is in it.
+   *
+   * \param node The node of the application.
+   * \param server The application.
+   */
+  void ApplyTree (Ptr<Node> node, Ptr<ScdtServer> server) const;
   ObjectFactory m_factory; //!< Object factory.
+  ScdtTree m_tree; //!< Tree to install, empty for none.
+  ArrivalModel m_arrivalModel; //!< How start times are spread.
+  Time m_arrivalStart; //!< Earliest start time.
+  Time m_arrivalWindow; //!< Time the arrivals are spread over.
+  uint32_t m_flashCrowdSize; //!< Applications in the burst, 0 for all.
+  Time m_flashCrowdBurst; //!< Duration of the burst.
+  Ptr<UniformRandomVariable> m_arrivalUniform; //!< Uniform draws of the arrival models.
+  Ptr<ExponentialRandomVariable> m_arrivalGap; //!< Gaps of the Poisson process.
 };
 
 } // namespace ns3
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "scdt-tree-snapshot-helper.h"
+#include "ns3/scdt-server.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include <map>
+#include <iomanip>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtTreeSnapshotHelper");
+
+ScdtTreeSnapshotHelper::ScdtTreeSnapshotHelper ()
+  : m_interval (Seconds (1.0)),
+    m_stop (Seconds (0)),
+    m_snapshots (0)
+{
+}
+
+ScdtTreeSnapshotHelper::~ScdtTreeSnapshotHelper ()
+{
+  Simulator::Cancel (m_event);
+}
+
+void
+ScdtTreeSnapshotHelper::Add (ApplicationContainer apps)
+{
+  m_apps.Add (apps);
+}
+
+void
+ScdtTreeSnapshotHelper::EnableJson (std::string fileName)
+{
+  m_json = Create<OutputStreamWrapper> (fileName, std::ios::out);
+}
+
+void
+ScdtTreeSnapshotHelper::EnableDot (std::string fileName)
+{
+  m_dot = Create<OutputStreamWrapper> (fileName, std::ios::out);
+}
+
+void
+ScdtTreeSnapshotHelper::SetInterval (Time interval)
+{
+  NS_ASSERT_MSG (interval.IsStrictlyPositive (), "The snapshot interval must be positive");
+  m_interval = interval;
+}
+
+void
+ScdtTreeSnapshotHelper::Start (Time start)
+{
+  Simulator::Cancel (m_event);
+  m_event = Simulator::Schedule (start, &ScdtTreeSnapshotHelper::Periodic, this);
+}
+
+void
+ScdtTreeSnapshotHelper::Stop (Time stop)
+{
+  m_stop = stop;
+}
+
+uint32_t
+ScdtTreeSnapshotHelper::GetNSnapshots (void) const
+{
+  return m_snapshots;
+}
+
+void
+ScdtTreeSnapshotHelper::Periodic (void)
+{
+  if (!m_stop.IsZero () && Simulator::Now () > m_stop)
+    {
+      return;
+    }
+  Snapshot ();
+  m_event = Simulator::Schedule (m_interval, &ScdtTreeSnapshotHelper::Periodic, this);
+}
+
+void
+ScdtTreeSnapshotHelper::Snapshot (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<NodeRecord> records;
+  std::map<Ipv4Address, uint32_t> index;
+  for (uint32_t k = 0; k < m_apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> server = m_apps.Get (k)->GetObject<ScdtServer> ();
+      if (server == 0)
+        {
+          continue;
+        }
+      NodeRecord record;
+      record.server = server;
+      record.nodeId = server->GetNode ()->GetId ();
+      record.root = server->IsRoot ();
+      record.attached = record.root || server->IsAttached ();
+      record.parent = -1;
+      record.rtt = Seconds (-1);
+      // Any of its addresses may be the one its parent knows it by
+      Ptr<Ipv4> ipv4 = server->GetNode ()->GetObject<Ipv4> ();
+      for (uint32_t i = 0; ipv4 != 0 && i < ipv4->GetNInterfaces (); i++)
+        {
+          for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+            {
+              Ipv4Address local = ipv4->GetAddress (i, j).GetLocal ();
+              if (local == Ipv4Address::GetLoopback ())
+                {
+                  continue;
+                }
+              if (index.find (local) == index.end ())
+                {
+                  index[local] = records.size ();
+                }
+              if (record.address == Ipv4Address ())
+                {
+                  record.address = local;
+                }
+            }
+        }
+      records.push_back (record);
+    }
+
+  for (uint32_t k = 0; k < records.size (); k++)
+    {
+      NodeRecord &record = records[k];
+      if (record.root || !record.attached
+          || !InetSocketAddress::IsMatchingType (record.server->GetParent ()))
+        {
+          continue;
+        }
+      Ipv4Address parent = InetSocketAddress::ConvertFrom (record.server->GetParent ()).GetIpv4 ();
+      std::map<Ipv4Address, uint32_t>::const_iterator it = index.find (parent);
+      if (it == index.end ())
+        {
+          continue;
+        }
+      record.parent = it->second;
+      Ptr<ScdtServer> server = records[it->second].server;
+      for (uint32_t c = 0; c < server->GetNChildren (); c++)
+        {
+          std::map<Ipv4Address, uint32_t>::const_iterator child =
+            index.find (InetSocketAddress::ConvertFrom (server->GetChild (c)).GetIpv4 ());
+          if (child != index.end () && child->second == k)
+            {
+              record.rtt = server->GetChildRtt (c);
+              break;
+            }
+        }
+    }
+
+  if (m_json != 0)
+    {
+      WriteJson (records);
+    }
+  if (m_dot != 0)
+    {
+      WriteDot (records);
+    }
+  m_snapshots++;
+}
+
+void
+ScdtTreeSnapshotHelper::WriteJson (const std::vector<NodeRecord> & records) const
+{
+  uint32_t attached = 0;
+  uint32_t maxDepth = 0;
+  for (uint32_t k = 0; k < records.size (); k++)
+    {
+      if (records[k].attached)
+        {
+          attached++;
+          maxDepth = std::max<uint32_t> (maxDepth, records[k].server->GetDepth ());
+        }
+    }
+  std::ostream &os = *m_json->GetStream ();
+  os << std::setprecision (9);
+  os << "{\"time\":" << Simulator::Now ().GetSeconds ()
+     << ",\"attached\":" << attached << ",\"maxDepth\":" << maxDepth << ",\"nodes\":[";
+  for (uint32_t k = 0; k < records.size (); k++)
+    {
+      const NodeRecord &record = records[k];
+      Ptr<ScdtServer> server = record.server;
+      os << (k ? "," : "") << "{\"node\":" << record.nodeId
+         << ",\"address\":\"" << record.address << "\""
+         << ",\"root\":" << (record.root ? "true" : "false")
+         << ",\"attached\":" << (record.attached ? "true" : "false");
+      if (record.parent >= 0)
+        {
+          os << ",\"parent\":\"" << records[record.parent].address << "\"";
+        }
+      else
+        {
+          os << ",\"parent\":null";
+        }
+      if (record.attached)
+        {
+          os << ",\"depth\":" << server->GetDepth ();
+        }
+      else
+        {
+          os << ",\"depth\":null";
+        }
+      if (!record.rtt.IsStrictlyNegative ())
+        {
+          os << ",\"rttToParent\":" << record.rtt.GetSeconds ();
+        }
+      else
+        {
+          os << ",\"rttToParent\":null";
+        }
+      os << ",\"subtree\":" << server->GetSubtreeSize () << ",\"children\":[";
+      for (uint32_t c = 0; c < server->GetNChildren (); c++)
+        {
+          os << (c ? "," : "") << "\"" << InetSocketAddress::ConvertFrom (server->GetChild (c)).GetIpv4 () << "\"";
+        }
+      os << "]}";
+    }
+  os << "]}" << std::endl;
+}
+
+void
+ScdtTreeSnapshotHelper::WriteDot (const std::vector<NodeRecord> & records) const
+{
+  std::ostream &os = *m_dot->GetStream ();
+  os << std::setprecision (9);
+  os << "digraph \"scdt-" << m_snapshots << "\" {\n"
+     << "  label=\"t=" << Simulator::Now ().GetSeconds () << "s\";\n";
+  for (uint32_t k = 0; k < records.size (); k++)
+    {
+      const NodeRecord &record = records[k];
+      if (!record.attached)
+        {
+          continue;
+        }
+      os << "  \"" << record.address << "\" [label=\"" << record.address
+         << "\\nd=" << record.server->GetDepth () << " s=" << record.server->GetSubtreeSize () << "\""
+         << (record.root ? ",shape=box" : "") << "];\n";
+    }
+  for (uint32_t k = 0; k < records.size (); k++)
+    {
+      const NodeRecord &record = records[k];
+      if (record.parent < 0)
+        {
+          continue;
+        }
+      os << "  \"" << records[record.parent].address << "\" -> \"" << record.address << "\"";
+      if (!record.rtt.IsStrictlyNegative ())
+        {
+          os << " [label=\"" << record.rtt.GetMilliSeconds () << "ms\"]";
+        }
+      os << ";\n";
+    }
+  os << "}" << std::endl;
+}
+
+} // namespace ns3
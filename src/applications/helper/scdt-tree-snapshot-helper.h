@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SCDT_TREE_SNAPSHOT_HELPER_H
+#define SCDT_TREE_SNAPSHOT_HELPER_H
+
+#include "ns3/application-container.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class ScdtServer;
+
+/**
+ * \ingroup applications
+ * \brief Write the shape of an SCDT tree at regular intervals.
+ *
+ * Every Interval from Start to Stop, the helper walks the ScdtServer
+ * applications added to it and writes one record per snapshot:
+ *
+ * - to the JSON file, one line per snapshot: the time, the number of
+ *   attached nodes, the largest depth and, per node, its address,
+ *   parent, depth, RTT to the parent (as measured by the parent),
+ *   subtree size and children;
+ * - to the DOT file, one digraph per snapshot, edges from parent to
+ *   child labelled with their RTT, which "dot" renders one graph per
+ *   page.
+ *
+ * Nodes are named by their first IPv4 address, and children are matched
+ * to the applications by IPv4 address, so the applications should all
+ * belong to the same group.  Records are flushed as they are written,
+ * so the files of an interrupted run are usable.  The helper schedules
+ * its own events: it must live until the simulation ends.
+ */
+class ScdtTreeSnapshotHelper
+{
+public:
+  ScdtTreeSnapshotHelper ();
+  ~ScdtTreeSnapshotHelper ();
+
+  /**
+   * \brief Add the applications to take snapshots of.
+   * \param apps ScdtServer applications, root included
+   */
+  void Add (ApplicationContainer apps);
+  /**
+   * \brief Write JSON lines records.
+   * \param fileName the file to write, overwritten
+   */
+  void EnableJson (std::string fileName);
+  /**
+   * \brief Write DOT records.
+   * \param fileName the file to write, overwritten
+   */
+  void EnableDot (std::string fileName);
+  /**
+   * \param interval time between two snapshots, 1 s by default
+   */
+  void SetInterval (Time interval);
+  /**
+   * \brief Take the first snapshot at the given time, then one every
+   * interval.
+   * \param start the time of the first snapshot
+   */
+  void Start (Time start);
+  /**
+   * \brief Take no snapshot after the given time.
+   * \param stop the time of the last possible snapshot
+   */
+  void Stop (Time stop);
+  /**
+   * \brief Take a snapshot now.
+   */
+  void Snapshot (void);
+  /**
+   * \returns the number of snapshots taken so far
+   */
+  uint32_t GetNSnapshots (void) const;
+
+private:
+  /// What a snapshot records of a node
+  struct NodeRecord
+  {
+    Ptr<ScdtServer> server; //!< The application
+    uint32_t nodeId; //!< Id of its node
+    Ipv4Address address; //!< Name of the node
+    bool root; //!< True at the root
+    bool attached; //!< True at the root and the attached nodes
+    int32_t parent; //!< Index of the parent record, -1 if unknown
+    Time rtt; //!< RTT to the parent as measured by the parent, negative if unknown
+  };
+
+  /**
+   * \brief Take a snapshot and schedule the next one.
+   */
+  void Periodic (void);
+  /**
+   * \param records the nodes of a snapshot, parents resolved
+   */
+  void WriteJson (const std::vector<NodeRecord> & records) const;
+  /**
+   * \param records the nodes of a snapshot, parents resolved
+   */
+  void WriteDot (const std::vector<NodeRecord> & records) const;
+
+  ApplicationContainer m_apps; //!< Applications to take snapshots of
+  Ptr<OutputStreamWrapper> m_json; //!< JSON lines output, if enabled
+  Ptr<OutputStreamWrapper> m_dot; //!< DOT output, if enabled
+  Time m_interval; //!< Time between two snapshots
+  Time m_stop; //!< Time of the last possible snapshot, zero for none
+  EventId m_event; //!< Next snapshot
+  uint32_t m_snapshots; //!< Snapshots taken
+};
+
+} // namespace ns3
+
+#endif /* SCDT_TREE_SNAPSHOT_HELPER_H */
@@ -0,0 +1,407 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "scdt-tree.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtTree");
+
+namespace {
+
+/**
+ * \param object the text of a JSON object
+ * \param key a key of the object
+ * \param value the text of its value, quotes removed from a string
+ * \returns false if the object has no such key
+ */
+bool
+FindJsonValue (const std::string & object, const std::string & key, std::string & value)
+{
+  std::string::size_type pos = object.find ("\"" + key + "\":");
+  if (pos == std::string::npos)
+    {
+      return false;
+    }
+  pos += key.size () + 3;
+  if (pos < object.size () && object[pos] == '"')
+    {
+      std::string::size_type end = object.find ('"', pos + 1);
+      if (end == std::string::npos)
+        {
+          return false;
+        }
+      value = object.substr (pos + 1, end - pos - 1);
+      return true;
+    }
+  std::string::size_type end = object.find_first_of (",}]", pos);
+  value = object.substr (pos, end == std::string::npos ? std::string::npos : end - pos);
+  return true;
+}
+
+/**
+ * \param text an IPv4 address in dotted-quad notation
+ * \param address the address read
+ * \returns false unless the text is four numbers of 0 to 255 separated by dots
+ */
+bool
+ParseIpv4 (const std::string & text, Ipv4Address & address)
+{
+  uint32_t value = 0;
+  uint32_t byte = 0;
+  uint32_t digits = 0;
+  uint32_t dots = 0;
+  for (std::string::size_type k = 0; k <= text.size (); k++)
+    {
+      if (k == text.size () || text[k] == '.')
+        {
+          if (digits == 0 || byte > 255)
+            {
+              return false;
+            }
+          value = (value << 8) | byte;
+          byte = 0;
+          digits = 0;
+          dots += k < text.size () ? 1 : 0;
+        }
+      else if (text[k] >= '0' && text[k] <= '9' && digits < 3)
+        {
+          byte = byte * 10 + (text[k] - '0');
+          digits++;
+        }
+      else
+        {
+          return false;
+        }
+    }
+  if (dots != 3)
+    {
+      return false;
+    }
+  address = Ipv4Address (value);
+  return true;
+}
+
+} // anonymous namespace
+
+ScdtTree::ScdtTree ()
+{
+}
+
+void
+ScdtTree::Clear (void)
+{
+  m_nodes.clear ();
+  m_root = Ipv4Address ();
+}
+
+ScdtTree::Entry &
+ScdtTree::GetEntry (Ipv4Address node)
+{
+  std::map<Ipv4Address, Entry>::iterator it = m_nodes.find (node);
+  if (it == m_nodes.end ())
+    {
+      it = m_nodes.insert (std::make_pair (node, Entry ())).first;
+      it->second.rtt = Seconds (0);
+    }
+  return it->second;
+}
+
+const ScdtTree::Entry &
+ScdtTree::Find (Ipv4Address node) const
+{
+  std::map<Ipv4Address, Entry>::const_iterator it = m_nodes.find (node);
+  NS_ASSERT_MSG (it != m_nodes.end (), "Node " << node << " is not in the tree");
+  return it->second;
+}
+
+void
+ScdtTree::SetRoot (Ipv4Address root)
+{
+  NS_LOG_FUNCTION (this << root);
+  m_root = root;
+  GetEntry (root);
+}
+
+void
+ScdtTree::Add (Ipv4Address node, Ipv4Address parent, Time rtt)
+{
+  NS_LOG_FUNCTION (this << node << parent << rtt);
+  NS_ASSERT_MSG (node != parent, "Node " << node << " cannot be its own parent");
+  Entry &entry = GetEntry (node);
+  if (m_nodes.find (entry.parent) != m_nodes.end () && entry.parent != Ipv4Address ())
+    {
+      std::vector<Ipv4Address> &siblings = m_nodes[entry.parent].children;
+      siblings.erase (std::remove (siblings.begin (), siblings.end (), node), siblings.end ());
+    }
+  entry.parent = parent;
+  entry.rtt = rtt;
+  GetEntry (parent).children.push_back (node);
+}
+
+bool
+ScdtTree::LoadText (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ifstream in (fileName.c_str ());
+  if (!in)
+    {
+      NS_LOG_ERROR ("Cannot read " << fileName);
+      return false;
+    }
+  Clear ();
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (in, line))
+    {
+      lineNumber++;
+      line = line.substr (0, line.find ('#'));
+      std::istringstream fields (line);
+      std::string node, parent;
+      if (!(fields >> node))
+        {
+          continue;
+        }
+      Ipv4Address nodeAddress;
+      if (!ParseIpv4 (node, nodeAddress))
+        {
+          NS_LOG_ERROR (fileName << ":" << lineNumber << ": bad node address " << node);
+          return false;
+        }
+      if (!(fields >> parent))
+        {
+          NS_LOG_ERROR (fileName << ":" << lineNumber << ": no parent");
+          return false;
+        }
+      if (parent == "-")
+        {
+          SetRoot (nodeAddress);
+          continue;
+        }
+      Ipv4Address parentAddress;
+      if (!ParseIpv4 (parent, parentAddress))
+        {
+          NS_LOG_ERROR (fileName << ":" << lineNumber << ": bad parent address " << parent);
+          return false;
+        }
+      double rtt;
+      if (!(fields >> rtt))
+        {
+          NS_LOG_ERROR (fileName << ":" << lineNumber << ": no RTT");
+          return false;
+        }
+      Add (nodeAddress, parentAddress, Seconds (rtt));
+    }
+  NS_LOG_INFO ("Read " << m_nodes.size () << " nodes from " << fileName);
+  return true;
+}
+
+bool
+ScdtTree::SaveText (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ofstream out (fileName.c_str (), std::ios::trunc);
+  if (!out)
+    {
+      NS_LOG_ERROR ("Cannot write " << fileName);
+      return false;
+    }
+  out << std::setprecision (9);
+  out << "# node parent rtt(s)\n";
+  if (m_nodes.find (m_root) != m_nodes.end ())
+    {
+      out << m_root << " -\n";
+    }
+  // Parents before their children, so the file reads in order
+  std::vector<Ipv4Address> pending (1, m_root);
+  for (uint32_t k = 0; k < pending.size (); k++)
+    {
+      std::map<Ipv4Address, Entry>::const_iterator it = m_nodes.find (pending[k]);
+      if (it == m_nodes.end ())
+        {
+          continue;
+        }
+      for (uint32_t c = 0; c < it->second.children.size (); c++)
+        {
+          Ipv4Address child = it->second.children[c];
+          out << child << " " << pending[k] << " " << Find (child).rtt.GetSeconds () << "\n";
+          pending.push_back (child);
+        }
+    }
+  return true;
+}
+
+bool
+ScdtTree::LoadSnapshot (std::string fileName, int32_t index)
+{
+  NS_LOG_FUNCTION (this << fileName << index);
+  std::ifstream in (fileName.c_str ());
+  if (!in)
+    {
+      NS_LOG_ERROR ("Cannot read " << fileName);
+      return false;
+    }
+  std::string line;
+  std::string snapshot;
+  int32_t count = 0;
+  while (std::getline (in, line))
+    {
+      if (line.empty ())
+        {
+          continue;
+        }
+      if (index < 0 || count == index)
+        {
+          snapshot = line;
+        }
+      count++;
+    }
+  if (snapshot.empty () || index >= count)
+    {
+      NS_LOG_ERROR (fileName << ": no snapshot " << index << " in " << count);
+      return false;
+    }
+
+  Clear ();
+  const std::string marker = "{\"node\":";
+  std::string::size_type pos = snapshot.find (marker);
+  while (pos != std::string::npos)
+    {
+      std::string::size_type next = snapshot.find (marker, pos + 1);
+      std::string object = snapshot.substr (pos, next == std::string::npos ? std::string::npos : next - pos);
+      pos = next;
+      std::string address, root, parent, rtt;
+      if (!FindJsonValue (object, "address", address))
+        {
+          continue;
+        }
+      if (FindJsonValue (object, "root", root) && root == "true")
+        {
+          SetRoot (Ipv4Address (address.c_str ()));
+          continue;
+        }
+      if (!FindJsonValue (object, "parent", parent) || parent == "null")
+        {
+          continue;
+        }
+      // The parent may not have measured the RTT yet
+      double seconds = 0;
+      if (FindJsonValue (object, "rttToParent", rtt) && rtt != "null")
+        {
+          seconds = std::atof (rtt.c_str ());
+        }
+      Add (Ipv4Address (address.c_str ()), Ipv4Address (parent.c_str ()), Seconds (seconds));
+    }
+  NS_LOG_INFO ("Read " << m_nodes.size () << " nodes from snapshot "
+               << (index < 0 ? count - 1 : index) << " of " << fileName);
+  return true;
+}
+
+uint32_t
+ScdtTree::GetN (void) const
+{
+  return m_nodes.size ();
+}
+
+Ipv4Address
+ScdtTree::GetRoot (void) const
+{
+  return m_root;
+}
+
+bool
+ScdtTree::Contains (Ipv4Address node) const
+{
+  return m_nodes.find (node) != m_nodes.end ();
+}
+
+Ipv4Address
+ScdtTree::GetParent (Ipv4Address node) const
+{
+  return Find (node).parent;
+}
+
+Time
+ScdtTree::GetRtt (Ipv4Address node) const
+{
+  return Find (node).rtt;
+}
+
+std::vector<Ipv4Address>
+ScdtTree::GetChildren (Ipv4Address node) const
+{
+  return Find (node).children;
+}
+
+std::vector<Ipv4Address>
+ScdtTree::GetAncestors (Ipv4Address node) const
+{
+  std::vector<Ipv4Address> ancestors;
+  Ipv4Address parent = Find (node).parent;
+  // Bounded by the node count in case the description has a cycle
+  while (Contains (parent) && node != m_root && ancestors.size () < m_nodes.size ())
+    {
+      ancestors.push_back (parent);
+      if (parent == m_root)
+        {
+          break;
+        }
+      parent = Find (parent).parent;
+    }
+  return ancestors;
+}
+
+uint16_t
+ScdtTree::GetDepth (Ipv4Address node) const
+{
+  return std::min<size_t> (GetAncestors (node).size (), 0xffff);
+}
+
+Time
+ScdtTree::GetRootLatency (Ipv4Address node) const
+{
+  int64_t latency = 0;
+  std::vector<Ipv4Address> ancestors = GetAncestors (node);
+  Ipv4Address current = node;
+  for (uint32_t k = 0; k < ancestors.size (); k++)
+    {
+      latency += Find (current).rtt.GetNanoSeconds () / 2;
+      current = ancestors[k];
+    }
+  return NanoSeconds (latency);
+}
+
+uint32_t
+ScdtTree::GetSubtreeSize (Ipv4Address node) const
+{
+  uint32_t size = 0;
+  std::vector<Ipv4Address> pending (1, node);
+  for (uint32_t k = 0; k < pending.size () && k < m_nodes.size (); k++)
+    {
+      size++;
+      const std::vector<Ipv4Address> &children = Find (pending[k]).children;
+      pending.insert (pending.end (), children.begin (), children.end ());
+    }
+  return size;
+}
+
+} // namespace ns3
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SCDT_TREE_H
+#define SCDT_TREE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ * \brief The shape of an SCDT tree, to install with ScdtServerHelper::SetTree.
+ *
+ * Nodes are named by an IPv4 address of theirs, and each edge carries
+ * the RTT from the parent to the child, from which the depths and root
+ * latencies of the nodes are derived.  A tree is built with Add, or read
+ * from:
+ *
+ * - a text file, one node per line: "node parent rtt", the RTT in
+ *   seconds, and "node -" for the root; '#' starts a comment;
+ * - a JSON lines file written by ScdtTreeSnapshotHelper, of which one
+ *   snapshot is taken; nodes that were not attached are left out.
+ */
+class ScdtTree
+{
+public:
+  ScdtTree ();
+
+  /**
+   * \brief Set the root.
+   * \param root the root
+   */
+  void SetRoot (Ipv4Address root);
+  /**
+   * \brief Add a node below a parent.
+   *
+   * Adding a node again moves it below the new parent.
+   *
+   * \param node the node
+   * \param parent its parent, added already or later
+   * \param rtt the RTT from the parent to the node
+   */
+  void Add (Ipv4Address node, Ipv4Address parent, Time rtt);
+
+  /**
+   * \brief Read a tree from a text file, replacing this one.
+   * \param fileName the file to read
+   * \returns false if the file cannot be read or a line is malformed,
+   * for instance an address is not a dotted quad
+   */
+  bool LoadText (std::string fileName);
+  /**
+   * \brief Write the tree as a text file LoadText reads.
+   * \param fileName the file to write, overwritten
+   * \returns false if the file cannot be written
+   */
+  bool SaveText (std::string fileName) const;
+  /**
+   * \brief Read a tree from a snapshot, replacing this one.
+   * \param fileName a JSON lines file written by ScdtTreeSnapshotHelper
+   * \param index the snapshot to read, from 0; negative for the last one
+   * \returns false if the file cannot be read or has no such snapshot
+   */
+  bool LoadSnapshot (std::string fileName, int32_t index = -1);
+
+  /**
+   * \returns the number of nodes, root included
+   */
+  uint32_t GetN (void) const;
+  /**
+   * \returns the root, the any address if none was set
+   */
+  Ipv4Address GetRoot (void) const;
+  /**
+   * \param node a node
+   * \returns true if the tree holds the node
+   */
+  bool Contains (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns its parent, the any address at the root
+   */
+  Ipv4Address GetParent (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns the RTT from its parent to it, zero at the root
+   */
+  Time GetRtt (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns its children, in the order they were added
+   */
+  std::vector<Ipv4Address> GetChildren (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns its ancestors, parent first, root last
+   */
+  std::vector<Ipv4Address> GetAncestors (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns its depth, 0 at the root
+   */
+  uint16_t GetDepth (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns half the RTTs summed along the path from the root
+   */
+  Time GetRootLatency (Ipv4Address node) const;
+  /**
+   * \param node a node of the tree
+   * \returns the number of nodes in its subtree, itself included
+   */
+  uint32_t GetSubtreeSize (Ipv4Address node) const;
+
+private:
+  /// A node of the tree
+  struct Entry
+  {
+    Ipv4Address parent; //!< Parent, the any address at the root
+    Time rtt; //!< RTT from the parent
+    std::vector<Ipv4Address> children; //!< Children, in the order added
+  };
+
+  /**
+   * \param node a node
+   * \returns its entry, created if needed
+   */
+  Entry & GetEntry (Ipv4Address node);
+  /**
+   * \param node a node
+   * \returns its entry, which must exist
+   */
+  const Entry & Find (Ipv4Address node) const;
+  /**
+   * \brief Forget all nodes.
+   */
+  void Clear (void);
+
+  std::map<Ipv4Address, Entry> m_nodes; //!< Nodes by address
+  Ipv4Address m_root; //!< The root
+};
+
+} // namespace ns3
+
+#endif /* SCDT_TREE_H */
@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "scdt-admission-policy.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtAdmissionPolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtAdmissionPolicy);
+
+const int32_t ScdtAdmissionPolicy::REDIRECT;
+
+TypeId
+ScdtAdmissionPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtAdmissionPolicy")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+  ;
+  return tid;
+}
+
+ScdtAdmissionPolicy::ScdtAdmissionPolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ScdtAdmissionPolicy::~ScdtAdmissionPolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtLowestRttAdmissionPolicy);
+
+TypeId
+ScdtLowestRttAdmissionPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtLowestRttAdmissionPolicy")
+    .SetParent<ScdtAdmissionPolicy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtLowestRttAdmissionPolicy> ()
+  ;
+  return tid;
+}
+
+int32_t
+ScdtLowestRttAdmissionPolicy::SelectEviction (const Member & joiner, const std::vector<Member> & children)
+{
+  NS_LOG_FUNCTION (this << joiner.rtt);
+  int32_t farthest = REDIRECT;
+  for (uint32_t i = 0; i < children.size (); i++)
+    {
+      if (farthest == REDIRECT || children[i].rtt > children[farthest].rtt)
+        {
+          farthest = i;
+        }
+    }
+  if (farthest != REDIRECT && joiner.rtt < children[farthest].rtt)
+    {
+      return farthest;
+    }
+  return REDIRECT;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtDepthBalancedAdmissionPolicy);
+
+TypeId
+ScdtDepthBalancedAdmissionPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtDepthBalancedAdmissionPolicy")
+    .SetParent<ScdtAdmissionPolicy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtDepthBalancedAdmissionPolicy> ()
+  ;
+  return tid;
+}
+
+int32_t
+ScdtDepthBalancedAdmissionPolicy::SelectEviction (const Member & joiner, const std::vector<Member> & children)
+{
+  NS_LOG_FUNCTION (this << joiner.rtt << joiner.subtree);
+  int32_t smallest = REDIRECT;
+  for (uint32_t i = 0; i < children.size (); i++)
+    {
+      if (smallest == REDIRECT || children[i].subtree < children[smallest].subtree
+          || (children[i].subtree == children[smallest].subtree && children[i].rtt > children[smallest].rtt))
+        {
+          smallest = i;
+        }
+    }
+  if (smallest == REDIRECT)
+    {
+      return REDIRECT;
+    }
+  const Member &victim = children[smallest];
+  if (joiner.subtree > victim.subtree || (joiner.subtree == victim.subtree && joiner.rtt < victim.rtt))
+    {
+      return smallest;
+    }
+  return REDIRECT;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtBandwidthWeightedAdmissionPolicy);
+
+TypeId
+ScdtBandwidthWeightedAdmissionPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtBandwidthWeightedAdmissionPolicy")
+    .SetParent<ScdtAdmissionPolicy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtBandwidthWeightedAdmissionPolicy> ()
+    .AddAttribute ("Weight",
+                   "Exponent of the fan-out in the score RTT / fanout ^ Weight; 0 "
+                   "scores on RTT alone",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&ScdtBandwidthWeightedAdmissionPolicy::m_weight),
+                   MakeDoubleChecker<double> (0))
+  ;
+  return tid;
+}
+
+double
+ScdtBandwidthWeightedAdmissionPolicy::Score (const Member & member) const
+{
+  return member.rtt.GetSeconds () / std::pow (std::max<double> (1, member.fanout), m_weight);
+}
+
+int32_t
+ScdtBandwidthWeightedAdmissionPolicy::SelectEviction (const Member & joiner, const std::vector<Member> & children)
+{
+  NS_LOG_FUNCTION (this << joiner.rtt << static_cast<uint32_t> (joiner.fanout));
+  int32_t worst = REDIRECT;
+  for (uint32_t i = 0; i < children.size (); i++)
+    {
+      if (worst == REDIRECT || Score (children[i]) > Score (children[worst]))
+        {
+          worst = i;
+        }
+    }
+  if (worst != REDIRECT && Score (joiner) < Score (children[worst]))
+    {
+      return worst;
+    }
+  return REDIRECT;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtNeverEvictAdmissionPolicy);
+
+TypeId
+ScdtNeverEvictAdmissionPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtNeverEvictAdmissionPolicy")
+    .SetParent<ScdtAdmissionPolicy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtNeverEvictAdmissionPolicy> ()
+  ;
+  return tid;
+}
+
+int32_t
+ScdtNeverEvictAdmissionPolicy::SelectEviction (const Member & joiner, const std::vector<Member> & children)
+{
+  NS_LOG_FUNCTION (this);
+  return REDIRECT;
+}
+
+} // namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_ADMISSION_POLICY_H
+#define SCDT_ADMISSION_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Decides whether a full ScdtServer makes room for a joiner.
+ *
+ * A node with a free child slot always accepts a joiner.  Once its
+ * fan-out is used up, the policy either picks a child to evict in favour
+ * of the joiner, which is sent REATTACH and rejoins through its backup
+ * parents, or lets the joiner go on down the tree with a TRY list.
+ *
+ * The ScdtServer AdmissionPolicy attribute selects the policy by TypeId.
+ */
+class ScdtAdmissionPolicy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  ScdtAdmissionPolicy ();
+  virtual ~ScdtAdmissionPolicy ();
+
+  /// What a parent knows of one of its children, or of a joiner
+  struct Member
+  {
+    Time rtt; //!< Shortest RTT measured from the parent
+    uint8_t fanout; //!< Maximum number of children it takes
+    uint32_t subtree; //!< Number of nodes in its subtree, itself included
+  };
+
+  /// Returned by SelectEviction to send the joiner a TRY list
+  static const int32_t REDIRECT = -1;
+
+  /**
+   * \brief Decide what to do with a joiner when every child slot is taken.
+   * \param joiner the joiner
+   * \param children the current children, in child slot order
+   * \returns the index of the child to evict in favour of the joiner, or
+   * REDIRECT
+   */
+  virtual int32_t SelectEviction (const Member & joiner, const std::vector<Member> & children) = 0;
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Evicts the child with the largest RTT if the joiner is closer.
+ *
+ * The original SCDT policy: the children of a node converge to the
+ * closest joiners it has seen.
+ */
+class ScdtLowestRttAdmissionPolicy : public ScdtAdmissionPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual int32_t SelectEviction (const Member & joiner, const std::vector<Member> & children);
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Keeps the largest subtrees closest to the root.
+ *
+ * Evicts the child with the smallest subtree, the farthest of those on a
+ * tie, if the joiner carries a larger subtree, or as large a subtree and
+ * a smaller RTT.  A node rejoining with its subtree after a repair or an
+ * optimization switch thus displaces a leaf rather than going deeper,
+ * and the tree stays shallow.  Subtree sizes are reported in the
+ * HEARTBEATs, so without them every child counts as a leaf.
+ */
+class ScdtDepthBalancedAdmissionPolicy : public ScdtAdmissionPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual int32_t SelectEviction (const Member & joiner, const std::vector<Member> & children);
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Keeps the nodes that can feed the most children closest to the
+ * root.
+ *
+ * Scores each node RTT / fanout ^ Weight and evicts the child with the
+ * worst score if the joiner scores better.  Since the fan-out follows the
+ * access link rate when MaxFanout is 0, high bandwidth nodes move up and
+ * the tree gets wider and shallower.
+ */
+class ScdtBandwidthWeightedAdmissionPolicy : public ScdtAdmissionPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual int32_t SelectEviction (const Member & joiner, const std::vector<Member> & children);
+
+private:
+  /**
+   * \param member a child or the joiner
+   * \returns its score, lower is better
+   */
+  double Score (const Member & member) const;
+
+  double m_weight; //!< Exponent of the fan-out in the score
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Never evicts: a full node redirects every joiner.
+ *
+ * Children keep their place for the whole session, so no subtree is ever
+ * disrupted by a join, at the cost of a tree shaped by the join order.
+ */
+class ScdtNeverEvictAdmissionPolicy : public ScdtAdmissionPolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual int32_t SelectEviction (const Member & joiner, const std::vector<Member> & children);
+};
+
+} // namespace ns3
+
+#endif /* SCDT_ADMISSION_POLICY_H */
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "scdt-endpoint.h"
+
+namespace ns3 {
+
+ScdtEndpoint::ScdtEndpoint ()
+  : m_ip (0),
+    m_port (0)
+{
+}
+
+ScdtEndpoint::ScdtEndpoint (const Address & address)
+{
+  NS_ASSERT_MSG (InetSocketAddress::IsMatchingType (address), "Not an IPv4 endpoint: " << address);
+  InetSocketAddress inet = InetSocketAddress::ConvertFrom (address);
+  m_ip = inet.GetIpv4 ().Get ();
+  m_port = inet.GetPort ();
+}
+
+ScdtEndpoint::ScdtEndpoint (const InetSocketAddress & address)
+  : m_ip (address.GetIpv4 ().Get ()),
+    m_port (address.GetPort ())
+{
+}
+
+Ipv4Address
+ScdtEndpoint::GetIpv4 (void) const
+{
+  return Ipv4Address (m_ip);
+}
+
+uint16_t
+ScdtEndpoint::GetPort (void) const
+{
+  return m_port;
+}
+
+InetSocketAddress
+ScdtEndpoint::GetInet (void) const
+{
+  return InetSocketAddress (Ipv4Address (m_ip), m_port);
+}
+
+ScdtEndpoint::operator Address () const
+{
+  return GetInet ();
+}
+
+bool
+ScdtEndpoint::IsEqual (const Address & address) const
+{
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      return false;
+    }
+  InetSocketAddress inet = InetSocketAddress::ConvertFrom (address);
+  return inet.GetIpv4 ().Get () == m_ip && inet.GetPort () == m_port;
+}
+
+bool
+operator == (const ScdtEndpoint &a, const ScdtEndpoint &b)
+{
+  return a.m_ip == b.m_ip && a.m_port == b.m_port;
+}
+
+bool
+operator != (const ScdtEndpoint &a, const ScdtEndpoint &b)
+{
+  return !(a == b);
+}
+
+bool
+operator < (const ScdtEndpoint &a, const ScdtEndpoint &b)
+{
+  return a.m_ip < b.m_ip || (a.m_ip == b.m_ip && a.m_port < b.m_port);
+}
+
+std::ostream &
+operator << (std::ostream &os, const ScdtEndpoint &endpoint)
+{
+  os << endpoint.GetIpv4 () << ":" << endpoint.GetPort ();
+  return os;
+}
+
+} // namespace ns3
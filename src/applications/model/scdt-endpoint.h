@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_ENDPOINT_H
+#define SCDT_ENDPOINT_H
+
+#include "ns3/address.h"
+#include "ns3/inet-socket-address.h"
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief IPv4 address and port of an SCDT peer, in 8 bytes.
+ *
+ * An ns3::Address is a type tag and a 20 bytes buffer, and comparing two
+ * of them walks the buffer.  The per-child state of an ScdtServer keeps
+ * its peers as ScdtEndpoint instead, and converts to an Address only
+ * where a socket or a trace needs one.
+ */
+class ScdtEndpoint
+{
+public:
+  ScdtEndpoint ();
+  /**
+   * \param address an InetSocketAddress
+   */
+  explicit ScdtEndpoint (const Address & address);
+  /**
+   * \param address an IPv4 address and port
+   */
+  explicit ScdtEndpoint (const InetSocketAddress & address);
+
+  /**
+   * \returns the IPv4 address
+   */
+  Ipv4Address GetIpv4 (void) const;
+  /**
+   * \returns the port
+   */
+  uint16_t GetPort (void) const;
+  /**
+   * \returns the endpoint as an InetSocketAddress
+   */
+  InetSocketAddress GetInet (void) const;
+  /**
+   * \returns the endpoint as a generic Address
+   */
+  operator Address () const;
+
+  /**
+   * \param address an InetSocketAddress
+   * \returns true if the address is this endpoint
+   */
+  bool IsEqual (const Address & address) const;
+
+private:
+  friend bool operator == (const ScdtEndpoint &a, const ScdtEndpoint &b);
+  friend bool operator < (const ScdtEndpoint &a, const ScdtEndpoint &b);
+
+  uint32_t m_ip; //!< IPv4 address, host order
+  uint16_t m_port; //!< Port
+};
+
+/**
+ * \param a an endpoint
+ * \param b another endpoint
+ * \returns true if they are the same endpoint
+ */
+bool operator == (const ScdtEndpoint &a, const ScdtEndpoint &b);
+/**
+ * \param a an endpoint
+ * \param b another endpoint
+ * \returns true if they are different endpoints
+ */
+bool operator != (const ScdtEndpoint &a, const ScdtEndpoint &b);
+/**
+ * \param a an endpoint
+ * \param b another endpoint
+ * \returns true if a sorts before b, by address then port
+ */
+bool operator < (const ScdtEndpoint &a, const ScdtEndpoint &b);
+/**
+ * \param os the output stream
+ * \param endpoint the endpoint
+ * \returns the output stream, with the endpoint as address:port
+ */
+std::ostream & operator << (std::ostream &os, const ScdtEndpoint &endpoint);
+
+} // namespace ns3
+
+#endif /* SCDT_ENDPOINT_H */
@@ -0,0 +1,828 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/header.h"
+#include "ns3/simulator.h"
+#include "scdt-header.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtHeader");
+
+namespace {
+/**
+ * \param latency a root latency
+ * \returns the latency in 32bits microseconds, clamped to about an hour
+ */
+uint32_t
+LatencyToMicroSeconds (Time latency)
+{
+  return static_cast<uint32_t> (std::max<int64_t> (0, std::min<int64_t> (latency.GetMicroSeconds (), 0xffffffff)));
+}
+} // anonymous namespace
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtHeader);
+
+ScdtHeader::ScdtHeader ()
+  : m_type (DATA),
+    m_seq (0),
+    m_ts (Simulator::Now ().GetTimeStep ()),
+    m_groupId (0),
+    m_length (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtHeader::SetType (uint8_t type)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (type));
+  m_type = type;
+}
+uint8_t
+ScdtHeader::GetType (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_type;
+}
+
+void
+ScdtHeader::SetSeq (uint32_t seq)
+{
+  NS_LOG_FUNCTION (this << seq);
+  m_seq = seq;
+}
+uint32_t
+ScdtHeader::GetSeq (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_seq;
+}
+
+void
+ScdtHeader::SetTs (Time ts)
+{
+  NS_LOG_FUNCTION (this << ts);
+  m_ts = ts.GetTimeStep ();
+}
+Time
+ScdtHeader::GetTs (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return TimeStep (m_ts);
+}
+
+void
+ScdtHeader::SetGroupId (uint32_t groupId)
+{
+  NS_LOG_FUNCTION (this << groupId);
+  m_groupId = groupId;
+}
+uint32_t
+ScdtHeader::GetGroupId (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_groupId;
+}
+
+void
+ScdtHeader::SetLength (uint16_t length)
+{
+  NS_LOG_FUNCTION (this << length);
+  m_length = length;
+}
+uint16_t
+ScdtHeader::GetLength (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_length;
+}
+
+TypeId
+ScdtHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(type=" << static_cast<uint32_t> (m_type) << " seq=" << m_seq
+     << " time=" << TimeStep (m_ts).GetSeconds () << " group=" << m_groupId
+     << " length=" << m_length << ")";
+}
+uint32_t
+ScdtHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 1+4+8+4+2;
+}
+
+void
+ScdtHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_type);
+  i.WriteHtonU32 (m_seq);
+  i.WriteHtonU64 (m_ts);
+  i.WriteHtonU32 (m_groupId);
+  i.WriteHtonU16 (m_length);
+}
+uint32_t
+ScdtHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_type = i.ReadU8 ();
+  m_seq = i.ReadNtohU32 ();
+  m_ts = i.ReadNtohU64 ();
+  m_groupId = i.ReadNtohU32 ();
+  m_length = i.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtTryHeader);
+
+ScdtTryHeader::ScdtTryHeader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtTryHeader::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_candidates.clear ();
+  m_coordinates.clear ();
+  m_depths.clear ();
+  m_latencies.clear ();
+}
+
+void
+ScdtTryHeader::AddCandidate (InetSocketAddress candidate, const ScdtVivaldiCoordinate & coordinate,
+                             uint16_t depth, Time latency)
+{
+  NS_LOG_FUNCTION (this << candidate.GetIpv4 () << candidate.GetPort () << coordinate << depth << latency);
+  NS_ASSERT_MSG (m_candidates.size () < 255, "Too many candidates in TRY");
+  m_candidates.push_back (candidate);
+  m_coordinates.push_back (coordinate);
+  m_depths.push_back (depth);
+  m_latencies.push_back (latency);
+}
+
+uint8_t
+ScdtTryHeader::GetNCandidates (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_candidates.size ();
+}
+
+InetSocketAddress
+ScdtTryHeader::GetCandidate (uint8_t i) const
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i));
+  NS_ASSERT (i < m_candidates.size ());
+  return m_candidates[i];
+}
+
+const ScdtVivaldiCoordinate &
+ScdtTryHeader::GetCandidateCoordinate (uint8_t i) const
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i));
+  NS_ASSERT (i < m_coordinates.size ());
+  return m_coordinates[i];
+}
+
+uint16_t
+ScdtTryHeader::GetCandidateDepth (uint8_t i) const
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i));
+  NS_ASSERT (i < m_depths.size ());
+  return m_depths[i];
+}
+
+Time
+ScdtTryHeader::GetCandidateLatency (uint8_t i) const
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i));
+  NS_ASSERT (i < m_latencies.size ());
+  return m_latencies[i];
+}
+
+TypeId
+ScdtTryHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtTryHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtTryHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtTryHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtTryHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(";
+  for (uint32_t i = 0; i < m_candidates.size (); i++)
+    {
+      os << (i ? " " : "") << m_candidates[i].GetIpv4 () << ":" << m_candidates[i].GetPort ()
+         << m_coordinates[i] << "@" << m_depths[i] << "/" << m_latencies[i].GetSeconds () << "s";
+    }
+  os << ")";
+}
+uint32_t
+ScdtTryHeader::GetSerializedSize (uint8_t nCandidates)
+{
+  return 1 + nCandidates * (4+2+ScdtVivaldiCoordinate::GetSerializedSize ()+2+4);
+}
+uint32_t
+ScdtTryHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return GetSerializedSize (m_candidates.size ());
+}
+
+void
+ScdtTryHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_candidates.size ());
+  for (uint32_t k = 0; k < m_candidates.size (); k++)
+    {
+      i.WriteHtonU32 (m_candidates[k].GetIpv4 ().Get ());
+      i.WriteHtonU16 (m_candidates[k].GetPort ());
+      m_coordinates[k].Serialize (i);
+      i.WriteHtonU16 (m_depths[k]);
+      i.WriteHtonU32 (LatencyToMicroSeconds (m_latencies[k]));
+    }
+}
+uint32_t
+ScdtTryHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  Clear ();
+  uint8_t n = i.ReadU8 ();
+  for (uint8_t k = 0; k < n; k++)
+    {
+      Ipv4Address ip (i.ReadNtohU32 ());
+      uint16_t port = i.ReadNtohU16 ();
+      m_candidates.push_back (InetSocketAddress (ip, port));
+      ScdtVivaldiCoordinate coordinate;
+      coordinate.Deserialize (i);
+      m_coordinates.push_back (coordinate);
+      m_depths.push_back (i.ReadNtohU16 ());
+      m_latencies.push_back (MicroSeconds (i.ReadNtohU32 ()));
+    }
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtPositionHeader);
+
+ScdtPositionHeader::ScdtPositionHeader ()
+  : m_depth (0),
+    m_latency (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtPositionHeader::SetDepth (uint16_t depth)
+{
+  NS_LOG_FUNCTION (this << depth);
+  m_depth = depth;
+}
+
+uint16_t
+ScdtPositionHeader::GetDepth (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_depth;
+}
+
+void
+ScdtPositionHeader::SetLatency (Time latency)
+{
+  NS_LOG_FUNCTION (this << latency);
+  m_latency = latency;
+}
+
+Time
+ScdtPositionHeader::GetLatency (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_latency;
+}
+
+TypeId
+ScdtPositionHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtPositionHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtPositionHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtPositionHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtPositionHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(depth=" << m_depth << " latency=" << m_latency.GetSeconds () << "s)";
+}
+uint32_t
+ScdtPositionHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 2+4;
+}
+
+void
+ScdtPositionHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteHtonU16 (m_depth);
+  i.WriteHtonU32 (LatencyToMicroSeconds (m_latency));
+}
+uint32_t
+ScdtPositionHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_depth = i.ReadNtohU16 ();
+  m_latency = MicroSeconds (i.ReadNtohU32 ());
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtCoordinateHeader);
+
+ScdtCoordinateHeader::ScdtCoordinateHeader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtCoordinateHeader::SetCoordinate (const ScdtVivaldiCoordinate & coordinate)
+{
+  NS_LOG_FUNCTION (this << coordinate);
+  m_coordinate = coordinate;
+}
+
+const ScdtVivaldiCoordinate &
+ScdtCoordinateHeader::GetCoordinate (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_coordinate;
+}
+
+TypeId
+ScdtCoordinateHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtCoordinateHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtCoordinateHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtCoordinateHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtCoordinateHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << m_coordinate;
+}
+uint32_t
+ScdtCoordinateHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return ScdtVivaldiCoordinate::GetSerializedSize ();
+}
+
+void
+ScdtCoordinateHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_coordinate.Serialize (i);
+}
+uint32_t
+ScdtCoordinateHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_coordinate.Deserialize (i);
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtStreamDelayHeader);
+
+ScdtStreamDelayHeader::ScdtStreamDelayHeader ()
+  : m_delay (Time::Max ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtStreamDelayHeader::SetDelay (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  m_delay = delay;
+}
+
+Time
+ScdtStreamDelayHeader::GetDelay (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_delay;
+}
+
+TypeId
+ScdtStreamDelayHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtStreamDelayHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtStreamDelayHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtStreamDelayHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtStreamDelayHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  if (m_delay == Time::Max ())
+    {
+      os << "(delay=unknown)";
+    }
+  else
+    {
+      os << "(delay=" << m_delay.GetSeconds () << "s)";
+    }
+}
+uint32_t
+ScdtStreamDelayHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 4;
+}
+
+void
+ScdtStreamDelayHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint32_t unknown = 0xffffffff;
+  if (m_delay == Time::Max ())
+    {
+      i.WriteHtonU32 (unknown);
+      return;
+    }
+  // Clamped just below the unknown marker, a bit over an hour
+  int64_t us = std::max<int64_t> (0, m_delay.GetMicroSeconds ());
+  i.WriteHtonU32 (static_cast<uint32_t> (std::min<int64_t> (us, unknown - 1)));
+}
+uint32_t
+ScdtStreamDelayHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint32_t us = i.ReadNtohU32 ();
+  m_delay = us == 0xffffffff ? Time::Max () : MicroSeconds (us);
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtMemberHeader);
+
+ScdtMemberHeader::ScdtMemberHeader ()
+  : m_fanout (1),
+    m_subtree (1),
+    m_freeSlots (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtMemberHeader::SetFanout (uint8_t fanout)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (fanout));
+  m_fanout = fanout;
+}
+
+uint8_t
+ScdtMemberHeader::GetFanout (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fanout;
+}
+
+void
+ScdtMemberHeader::SetSubtreeSize (uint32_t subtree)
+{
+  NS_LOG_FUNCTION (this << subtree);
+  m_subtree = subtree;
+}
+
+uint32_t
+ScdtMemberHeader::GetSubtreeSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_subtree;
+}
+
+void
+ScdtMemberHeader::SetFreeSlots (uint8_t slots)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (slots));
+  m_freeSlots = slots;
+}
+
+uint8_t
+ScdtMemberHeader::GetFreeSlots (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_freeSlots;
+}
+
+TypeId
+ScdtMemberHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtMemberHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtMemberHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtMemberHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtMemberHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(fanout=" << static_cast<uint32_t> (m_fanout) << " subtree=" << m_subtree
+     << " free=" << static_cast<uint32_t> (m_freeSlots) << ")";
+}
+uint32_t
+ScdtMemberHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 1+4+1;
+}
+
+void
+ScdtMemberHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_fanout);
+  i.WriteHtonU32 (m_subtree);
+  i.WriteU8 (m_freeSlots);
+}
+uint32_t
+ScdtMemberHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_fanout = i.ReadU8 ();
+  m_subtree = i.ReadNtohU32 ();
+  m_freeSlots = i.ReadU8 ();
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtProbeTrainHeader);
+
+ScdtProbeTrainHeader::ScdtProbeTrainHeader ()
+  : m_length (2),
+    m_packetSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtProbeTrainHeader::SetLength (uint8_t length)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (length));
+  m_length = length;
+}
+
+uint8_t
+ScdtProbeTrainHeader::GetLength (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_length;
+}
+
+void
+ScdtProbeTrainHeader::SetPacketSize (uint16_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_packetSize = size;
+}
+
+uint16_t
+ScdtProbeTrainHeader::GetPacketSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_packetSize;
+}
+
+TypeId
+ScdtProbeTrainHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtProbeTrainHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtProbeTrainHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtProbeTrainHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtProbeTrainHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(length=" << static_cast<uint32_t> (m_length) << " size=" << m_packetSize << ")";
+}
+uint32_t
+ScdtProbeTrainHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 1+2;
+}
+
+void
+ScdtProbeTrainHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_length);
+  i.WriteHtonU16 (m_packetSize);
+}
+uint32_t
+ScdtProbeTrainHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_length = i.ReadU8 ();
+  m_packetSize = i.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtChunkHeader);
+
+ScdtChunkHeader::ScdtChunkHeader ()
+  : m_length (0),
+    m_seq (0),
+    m_ts (Simulator::Now ().GetTimeStep ())
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtChunkHeader::SetLength (uint32_t length)
+{
+  NS_LOG_FUNCTION (this << length);
+  m_length = length;
+}
+
+uint32_t
+ScdtChunkHeader::GetLength (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_length;
+}
+
+void
+ScdtChunkHeader::SetSeq (uint32_t seq)
+{
+  NS_LOG_FUNCTION (this << seq);
+  m_seq = seq;
+}
+uint32_t
+ScdtChunkHeader::GetSeq (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_seq;
+}
+
+void
+ScdtChunkHeader::SetTs (Time ts)
+{
+  NS_LOG_FUNCTION (this << ts);
+  m_ts = ts.GetTimeStep ();
+}
+Time
+ScdtChunkHeader::GetTs (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return TimeStep (m_ts);
+}
+
+TypeId
+ScdtChunkHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtChunkHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtChunkHeader> ()
+  ;
+  return tid;
+}
+TypeId
+ScdtChunkHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+void
+ScdtChunkHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(length=" << m_length << " seq=" << m_seq
+     << " time=" << TimeStep (m_ts).GetSeconds () << ")";
+}
+uint32_t
+ScdtChunkHeader::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 4+4+8;
+}
+
+void
+ScdtChunkHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_length);
+  i.WriteHtonU32 (m_seq);
+  i.WriteHtonU64 (m_ts);
+}
+uint32_t
+ScdtChunkHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_length = i.ReadNtohU32 ();
+  m_seq = i.ReadNtohU32 ();
+  m_ts = i.ReadNtohU64 ();
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
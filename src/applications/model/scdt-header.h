@@ -0,0 +1,507 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_HEADER_H
+#define SCDT_HEADER_H
+
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/inet-socket-address.h"
+#include "scdt-vivaldi-coordinate.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Control header carried by every SCDT datagram.
+ *
+ * The header is made of a one byte message type, a 32bits sequence
+ * number, a 64bits time stamp, a 32bits group id and the 16bits length
+ * of the payload (e.g. the candidate list of a TRY message), which
+ * follows the header.  The length lets several messages for the same
+ * node share one datagram, each header followed by its own payload.
+ */
+class ScdtHeader : public Header
+{
+public:
+  /**
+   * \brief SCDT control message types.
+   *
+   * The values index ScdtServer's dispatch table, so new types must be
+   * appended before MESSAGE_TYPE_COUNT.
+   */
+  enum MessageType
+  {
+    ATTACH = 0,     //!< Request to join below the receiver, carries an ScdtCoordinateHeader then an ScdtMemberHeader
+    PING = 1,       //!< RTT probe
+    PING_RESP = 2,  //!< Answer to a PING, echoes its sequence number and time stamp and carries an ScdtCoordinateHeader, an ScdtStreamDelayHeader and an ScdtMemberHeader
+    TRY = 3,        //!< Receiver is full, carries the list of children to try next, best first
+    ATTACH_SUC = 4, //!< Receiver has been accepted as a child of the sender, carries its ScdtPositionHeader then the sender's ancestors in an ScdtTryHeader
+    REATTACH = 5,   //!< Receiver has been evicted and must join again
+    DATA = 6,       //!< Opens a data connection; dropped on the control socket
+    PING_TRAIN = 7, //!< PING that also asks for a packet train, carries an ScdtProbeTrainHeader
+    TRAIN = 8,      //!< Packet of a bandwidth probe train, carries the PING's sequence number
+    HEARTBEAT = 9,  //!< Periodic liveness message between a parent and each of its children; a child's carries an ScdtMemberHeader, a parent's an ScdtPositionHeader
+    LEAVE = 10,     //!< Sender moved to another parent and is no longer a child of the receiver
+    MESSAGE_TYPE_COUNT
+  };
+
+  ScdtHeader ();
+
+  /**
+   * \param type the message type
+   */
+  void SetType (uint8_t type);
+  /**
+   * \return the message type
+   */
+  uint8_t GetType (void) const;
+  /**
+   * \param seq the sequence number
+   */
+  void SetSeq (uint32_t seq);
+  /**
+   * \return the sequence number
+   */
+  uint32_t GetSeq (void) const;
+  /**
+   * \param ts the time stamp
+   */
+  void SetTs (Time ts);
+  /**
+   * \return the time stamp
+   */
+  Time GetTs (void) const;
+  /**
+   * \param groupId the id of the group (tree) the message belongs to
+   */
+  void SetGroupId (uint32_t groupId);
+  /**
+   * \return the id of the group (tree) the message belongs to
+   */
+  uint32_t GetGroupId (void) const;
+  /**
+   * \param length the length of the payload following the header
+   */
+  void SetLength (uint16_t length);
+  /**
+   * \return the length of the payload following the header
+   */
+  uint16_t GetLength (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_type; //!< Message type
+  uint32_t m_seq; //!< Sequence number
+  uint64_t m_ts; //!< Timestamp
+  uint32_t m_groupId; //!< Group id
+  uint16_t m_length; //!< Payload length
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Payload of a TRY message: the candidates a joiner should probe next.
+ *
+ * The payload is made of a one byte candidate count followed by, for
+ * each candidate, its 32bits IPv4 address, 16bits port, Vivaldi
+ * coordinate, 16bits depth and 32bits root latency in microseconds.  The
+ * joiner ranks the candidates by predicted RTT before probing them, and
+ * skips those too deep or too far from the root for the MaxDepth and
+ * MaxLatency bounds.
+ */
+class ScdtTryHeader : public Header
+{
+public:
+  ScdtTryHeader ();
+
+  /**
+   * \brief Remove all candidates.
+   */
+  void Clear (void);
+  /**
+   * \param candidate the address of a node the joiner should try next
+   * \param coordinate the last known coordinate of the candidate
+   * \param depth the depth of the candidate in the tree, 0 at the root
+   * \param latency the estimated latency from the root to the candidate
+   */
+  void AddCandidate (InetSocketAddress candidate,
+                     const ScdtVivaldiCoordinate & coordinate = ScdtVivaldiCoordinate (),
+                     uint16_t depth = 0, Time latency = Seconds (0));
+  /**
+   * \return the number of candidates
+   */
+  uint8_t GetNCandidates (void) const;
+  /**
+   * \param i the index of the candidate
+   * \return the address of the i-th candidate
+   */
+  InetSocketAddress GetCandidate (uint8_t i) const;
+  /**
+   * \param i the index of the candidate
+   * \return the coordinate of the i-th candidate
+   */
+  const ScdtVivaldiCoordinate & GetCandidateCoordinate (uint8_t i) const;
+  /**
+   * \param i the index of the candidate
+   * \return the depth of the i-th candidate
+   */
+  uint16_t GetCandidateDepth (uint8_t i) const;
+  /**
+   * \param i the index of the candidate
+   * \return the root latency of the i-th candidate
+   */
+  Time GetCandidateLatency (uint8_t i) const;
+  /**
+   * \param nCandidates the number of candidates
+   * \return the serialized size of a header carrying that many candidates
+   */
+  static uint32_t GetSerializedSize (uint8_t nCandidates);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  std::vector<InetSocketAddress> m_candidates; //!< Candidates to try
+  std::vector<ScdtVivaldiCoordinate> m_coordinates; //!< Coordinates of the candidates
+  std::vector<uint16_t> m_depths; //!< Depths of the candidates
+  std::vector<Time> m_latencies; //!< Root latencies of the candidates
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Position of the receiver in the tree, carried by ATTACH_SUC
+ * (before the ancestors) and by the HEARTBEATs of a parent.
+ *
+ * The parent knows the RTT to its child, so it works out the child's
+ * depth, one more than its own, and its root latency, its own plus half
+ * that RTT; the HEARTBEATs keep them current when a node above moves.
+ * The payload is made of the 16bits depth and the 32bits root latency in
+ * microseconds.
+ */
+class ScdtPositionHeader : public Header
+{
+public:
+  ScdtPositionHeader ();
+
+  /**
+   * \param depth the depth of the receiver, 0 at the root
+   */
+  void SetDepth (uint16_t depth);
+  /**
+   * \return the depth of the receiver
+   */
+  uint16_t GetDepth (void) const;
+  /**
+   * \param latency the estimated latency from the root to the receiver
+   */
+  void SetLatency (Time latency);
+  /**
+   * \return the estimated latency from the root to the receiver
+   */
+  Time GetLatency (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint16_t m_depth; //!< Depth of the receiver
+  Time m_latency; //!< Root latency of the receiver
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Vivaldi coordinate of the sender, carried by ATTACH and PING_RESP.
+ *
+ * A PING_RESP gives the pinger both an RTT sample and the coordinate to
+ * update its own against; an ATTACH tells the parent the coordinate to
+ * advertise the joiner with in its TRY lists.
+ */
+class ScdtCoordinateHeader : public Header
+{
+public:
+  ScdtCoordinateHeader ();
+
+  /**
+   * \param coordinate the coordinate of the sender
+   */
+  void SetCoordinate (const ScdtVivaldiCoordinate & coordinate);
+  /**
+   * \return the coordinate of the sender
+   */
+  const ScdtVivaldiCoordinate & GetCoordinate (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  ScdtVivaldiCoordinate m_coordinate; //!< Coordinate of the sender
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Stream delay of the sender, carried by PING_RESP after its
+ * ScdtCoordinateHeader.
+ *
+ * The delay is how long chunks take from the root to the sender, 0 at
+ * the root; a node probing a candidate parent adds half the RTT to it to
+ * predict its own delay below that candidate.  It is sent as 32bits
+ * microseconds, all ones while the sender has not received any chunk.
+ */
+class ScdtStreamDelayHeader : public Header
+{
+public:
+  ScdtStreamDelayHeader ();
+
+  /**
+   * \param delay the stream delay of the sender, Time::Max () if unknown
+   */
+  void SetDelay (Time delay);
+  /**
+   * \return the stream delay of the sender, Time::Max () if unknown
+   */
+  Time GetDelay (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  Time m_delay; //!< Stream delay of the sender
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Capacity and load of the sender, for the admission policy of
+ * its (future) parent.
+ *
+ * Carried by ATTACH and PING_RESP, so that a full parent can weigh a
+ * joiner against its children, and by the HEARTBEATs of a child, which
+ * keep its parent up to date, and rank it in the TRY lists.  The payload
+ * is made of the one byte fan-out of the sender, the 32bits size of its
+ * subtree, itself included, and the one byte number of child slots it
+ * has left.
+ */
+class ScdtMemberHeader : public Header
+{
+public:
+  ScdtMemberHeader ();
+
+  /**
+   * \param fanout the maximum number of children of the sender
+   */
+  void SetFanout (uint8_t fanout);
+  /**
+   * \return the maximum number of children of the sender
+   */
+  uint8_t GetFanout (void) const;
+  /**
+   * \param subtree the number of nodes in the subtree of the sender
+   */
+  void SetSubtreeSize (uint32_t subtree);
+  /**
+   * \return the number of nodes in the subtree of the sender
+   */
+  uint32_t GetSubtreeSize (void) const;
+  /**
+   * \param slots the number of children the sender can still take
+   */
+  void SetFreeSlots (uint8_t slots);
+  /**
+   * \return the number of children the sender can still take
+   */
+  uint8_t GetFreeSlots (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_fanout; //!< Maximum number of children of the sender
+  uint32_t m_subtree; //!< Subtree size of the sender
+  uint8_t m_freeSlots; //!< Child slots the sender has left
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Payload of a PING_TRAIN message: the shape of the train to send back.
+ *
+ * The payload is made of a one byte train length (number of packets)
+ * and the 16bits size of each TRAIN packet, SCDT header included.
+ */
+class ScdtProbeTrainHeader : public Header
+{
+public:
+  ScdtProbeTrainHeader ();
+
+  /**
+   * \param length the number of TRAIN packets to send back
+   */
+  void SetLength (uint8_t length);
+  /**
+   * \return the number of TRAIN packets to send back
+   */
+  uint8_t GetLength (void) const;
+  /**
+   * \param size the size of each TRAIN packet
+   */
+  void SetPacketSize (uint16_t size);
+  /**
+   * \return the size of each TRAIN packet
+   */
+  uint16_t GetPacketSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_length; //!< Train length
+  uint16_t m_packetSize; //!< Size of each train packet
+};
+
+/**
+ * \ingroup applications
+ *
+ * \brief Framing header of a chunk on an SCDT data connection.
+ *
+ * The data connections are TCP byte streams; every chunk is prefixed
+ * with its 32bits payload length so that receivers can cut the stream
+ * back into chunks whatever the segment boundaries were.  The length is
+ * followed by the 32bits sequence number of the chunk in the stream and
+ * the 64bits time stamp of its creation at the root, which hops forward
+ * unchanged.
+ */
+class ScdtChunkHeader : public Header
+{
+public:
+  ScdtChunkHeader ();
+
+  /**
+   * \param length the number of payload bytes following the header
+   */
+  void SetLength (uint32_t length);
+  /**
+   * \return the number of payload bytes following the header
+   */
+  uint32_t GetLength (void) const;
+  /**
+   * \param seq the sequence number of the chunk in the stream
+   */
+  void SetSeq (uint32_t seq);
+  /**
+   * \return the sequence number of the chunk in the stream
+   */
+  uint32_t GetSeq (void) const;
+  /**
+   * \param ts the time the chunk was created at the root
+   */
+  void SetTs (Time ts);
+  /**
+   * \return the time the chunk was created at the root
+   */
+  Time GetTs (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint32_t m_length; //!< Payload length
+  uint32_t m_seq; //!< Chunk sequence number
+  uint64_t m_ts; //!< Origin timestamp
+};
+
+} // namespace ns3
+
+#endif /* SCDT_HEADER_H */
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "scdt-latency-histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtLatencyHistogram");
+
+ScdtLatencyHistogram::ScdtLatencyHistogram ()
+  : m_count (0),
+    m_min (0),
+    m_max (0),
+    m_sum (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+ScdtLatencyHistogram::GetBucket (uint64_t ns)
+{
+  if (ns < 16)
+    {
+      return ns;
+    }
+  uint32_t msb = 0;
+  for (uint64_t v = ns; v > 1; v >>= 1)
+    {
+      msb++;
+    }
+  // 8 buckets per power of two, indexed by the 3 bits below the msb
+  uint32_t mantissa = (ns >> (msb - 3)) & 7;
+  return (msb - 2) * 8 + mantissa;
+}
+
+uint64_t
+ScdtLatencyHistogram::GetBucketMax (uint32_t bucket)
+{
+  if (bucket < 16)
+    {
+      return bucket;
+    }
+  uint32_t msb = bucket / 8 + 2;
+  uint64_t mantissa = bucket % 8;
+  uint64_t lower = (8 + mantissa) << (msb - 3);
+  return lower + ((static_cast<uint64_t> (1) << (msb - 3)) - 1);
+}
+
+void
+ScdtLatencyHistogram::Add (Time latency)
+{
+  NS_LOG_FUNCTION (this << latency);
+  int64_t signedNs = latency.GetNanoSeconds ();
+  uint64_t ns = signedNs < 0 ? 0 : signedNs;
+  uint32_t bucket = GetBucket (ns);
+  if (bucket >= m_buckets.size ())
+    {
+      m_buckets.resize (bucket + 1, 0);
+    }
+  m_buckets[bucket]++;
+  m_min = (m_count == 0) ? ns : std::min (m_min, ns);
+  m_max = std::max (m_max, ns);
+  m_sum += ns;
+  m_count++;
+}
+
+void
+ScdtLatencyHistogram::Merge (const ScdtLatencyHistogram & other)
+{
+  NS_LOG_FUNCTION (this << other.m_count);
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  if (other.m_buckets.size () > m_buckets.size ())
+    {
+      m_buckets.resize (other.m_buckets.size (), 0);
+    }
+  for (uint32_t i = 0; i < other.m_buckets.size (); i++)
+    {
+      m_buckets[i] += other.m_buckets[i];
+    }
+  m_min = (m_count == 0) ? other.m_min : std::min (m_min, other.m_min);
+  m_max = std::max (m_max, other.m_max);
+  m_sum += other.m_sum;
+  m_count += other.m_count;
+}
+
+void
+ScdtLatencyHistogram::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_buckets.clear ();
+  m_count = 0;
+  m_min = 0;
+  m_max = 0;
+  m_sum = 0;
+}
+
+uint64_t
+ScdtLatencyHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+Time
+ScdtLatencyHistogram::GetMin (void) const
+{
+  return NanoSeconds (m_min);
+}
+
+Time
+ScdtLatencyHistogram::GetMax (void) const
+{
+  return NanoSeconds (m_max);
+}
+
+Time
+ScdtLatencyHistogram::GetMean (void) const
+{
+  if (m_count == 0)
+    {
+      return Time (0);
+    }
+  return NanoSeconds (static_cast<int64_t> (m_sum / m_count));
+}
+
+Time
+ScdtLatencyHistogram::GetQuantile (double q) const
+{
+  NS_LOG_FUNCTION (this << q);
+  if (m_count == 0)
+    {
+      return Time (0);
+    }
+  q = std::max (0.0, std::min (q, 1.0));
+  uint64_t rank = std::max<uint64_t> (1, static_cast<uint64_t> (std::ceil (q * m_count)));
+  uint64_t seen = 0;
+  for (uint32_t b = 0; b < m_buckets.size (); b++)
+    {
+      seen += m_buckets[b];
+      if (seen >= rank)
+        {
+          return NanoSeconds (std::min (GetBucketMax (b), m_max));
+        }
+    }
+  return NanoSeconds (m_max);
+}
+
+} // namespace ns3
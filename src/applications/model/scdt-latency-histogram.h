@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_LATENCY_HISTOGRAM_H
+#define SCDT_LATENCY_HISTOGRAM_H
+
+#include "ns3/nstime.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Online histogram of chunk latencies with logarithmic buckets.
+ *
+ * Latencies are bucketed on their nanosecond value: every power of two
+ * is split in 8 buckets, so quantiles are known within 12.5% whatever
+ * the scale, and values below 16 ns are exact.  Adding a sample is O(1)
+ * and the memory grows with the logarithm of the largest latency seen,
+ * a few hundred bytes for latencies in seconds.  The minimum, maximum
+ * and mean are exact.
+ */
+class ScdtLatencyHistogram
+{
+public:
+  ScdtLatencyHistogram ();
+
+  /**
+   * \brief Record a latency sample.
+   * \param latency the sample; negative values are counted as zero
+   */
+  void Add (Time latency);
+  /**
+   * \brief Add the samples of another histogram to this one.
+   * \param other the histogram to merge
+   */
+  void Merge (const ScdtLatencyHistogram & other);
+  /**
+   * \brief Forget all samples.
+   */
+  void Reset (void);
+  /**
+   * \returns the number of samples
+   */
+  uint64_t GetCount (void) const;
+  /**
+   * \returns the smallest sample, zero if there are none
+   */
+  Time GetMin (void) const;
+  /**
+   * \returns the largest sample, zero if there are none
+   */
+  Time GetMax (void) const;
+  /**
+   * \returns the mean of the samples, zero if there are none
+   */
+  Time GetMean (void) const;
+  /**
+   * \brief Get a quantile of the samples.
+   *
+   * The result is the upper bound of the bucket holding the quantile,
+   * capped by the largest sample, so it overestimates by at most 12.5%.
+   *
+   * \param q the quantile, between 0 and 1 (e.g. 0.99 for the p99)
+   * \returns the quantile, zero if there are no samples
+   */
+  Time GetQuantile (double q) const;
+
+private:
+  /**
+   * \param ns a latency in nanoseconds
+   * \returns the index of its bucket
+   */
+  static uint32_t GetBucket (uint64_t ns);
+  /**
+   * \param bucket the index of a bucket
+   * \returns the largest latency in nanoseconds the bucket holds
+   */
+  static uint64_t GetBucketMax (uint32_t bucket);
+
+  std::vector<uint32_t> m_buckets; //!< Sample count per bucket, grown on demand
+  uint64_t m_count; //!< Number of samples
+  uint64_t m_min; //!< Smallest sample in nanoseconds
+  uint64_t m_max; //!< Largest sample in nanoseconds
+  double m_sum; //!< Sum of the samples in nanoseconds
+};
+
+} // namespace ns3
+
+#endif /* SCDT_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "scdt-probe-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtProbeTable");
+
+ScdtProbeTable::ScdtProbeTable ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ScdtProbeTable::Key
+ScdtProbeTable::MakeKey (const InetSocketAddress &peer, uint32_t seq)
+{
+  Key key;
+  key.ip = peer.GetIpv4 ().Get ();
+  key.port = peer.GetPort ();
+  key.seq = seq;
+  return key;
+}
+
+void
+ScdtProbeTable::Insert (const InetSocketAddress &peer, uint32_t seq, Time sent, ProbeKind kind)
+{
+  NS_LOG_FUNCTION (this << peer.GetIpv4 () << seq << sent << kind);
+  Key key = MakeKey (peer, seq);
+  Probe probe;
+  probe.sent = sent;
+  probe.kind = kind;
+  m_probes[key] = probe;
+
+  Pending pending;
+  pending.key = key;
+  pending.sent = sent;
+  m_sendOrder.push_back (pending);
+}
+
+bool
+ScdtProbeTable::Remove (const InetSocketAddress &peer, uint32_t seq, Probe &probe)
+{
+  NS_LOG_FUNCTION (this << peer.GetIpv4 () << seq);
+  std::unordered_map<Key, Probe, KeyHash>::iterator it = m_probes.find (MakeKey (peer, seq));
+  if (it == m_probes.end ())
+    {
+      return false;
+    }
+  probe = it->second;
+  m_probes.erase (it);
+  return true;
+}
+
+uint32_t
+ScdtProbeTable::Expire (Time sentBefore)
+{
+  NS_LOG_FUNCTION (this << sentBefore);
+  uint32_t expired = 0;
+  while (!m_sendOrder.empty () && m_sendOrder.front ().sent < sentBefore)
+    {
+      // The probe may already have been answered; erase is then a no-op
+      expired += m_probes.erase (m_sendOrder.front ().key);
+      m_sendOrder.pop_front ();
+    }
+  // Answered probes stay queued until they reach the front; once
+  // everything has been answered the whole queue is stale.
+  if (m_probes.empty ())
+    {
+      m_sendOrder.clear ();
+    }
+  return expired;
+}
+
+uint32_t
+ScdtProbeTable::GetSize (void) const
+{
+  return m_probes.size ();
+}
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_PROBE_TABLE_H
+#define SCDT_PROBE_TABLE_H
+
+#include "ns3/nstime.h"
+#include "ns3/inet-socket-address.h"
+#include <unordered_map>
+#include <deque>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Outstanding PINGs of an ScdtServer.
+ *
+ * Probes are keyed by (peer endpoint, probe sequence number), so a
+ * PING_RESP can only ever be matched to the PING it answers.  Insert,
+ * lookup and removal are O(1); expiry is amortized O(1) because probes
+ * are expired in the order they were sent.
+ */
+class ScdtProbeTable
+{
+public:
+  /**
+   * \brief What the probe was sent for.
+   */
+  enum ProbeKind
+  {
+    CHILD_PROBE,    //!< Probe of a node asking to attach below us
+    PARENT_PROBE,   //!< Probe of a candidate parent from a TRY list
+    OPTIMIZE_PROBE  //!< Probe of a better parent during an optimization round
+  };
+
+  /**
+   * \brief An outstanding probe.
+   */
+  struct Probe
+  {
+    Time sent;      //!< Time the PING was sent
+    ProbeKind kind; //!< What the probe was sent for
+  };
+
+  ScdtProbeTable ();
+
+  /**
+   * \brief Record a PING that has just been sent.
+   * \param peer the probed endpoint
+   * \param seq the sequence number carried by the PING
+   * \param sent the time the PING was sent
+   * \param kind what the probe was sent for
+   */
+  void Insert (const InetSocketAddress &peer, uint32_t seq, Time sent, ProbeKind kind);
+  /**
+   * \brief Match a PING_RESP against its PING and forget the probe.
+   * \param peer the endpoint the PING_RESP came from
+   * \param seq the sequence number echoed in the PING_RESP
+   * \param probe filled with the matched probe
+   * \returns false if no such probe is outstanding (stale or duplicate answer)
+   */
+  bool Remove (const InetSocketAddress &peer, uint32_t seq, Probe &probe);
+  /**
+   * \brief Forget all probes sent before a given time.
+   * \param sentBefore expiry horizon
+   * \returns the number of probes expired
+   */
+  uint32_t Expire (Time sentBefore);
+  /**
+   * \returns the number of outstanding probes
+   */
+  uint32_t GetSize (void) const;
+
+private:
+  /// Table key: probed endpoint and probe sequence number
+  struct Key
+  {
+    uint32_t ip;   //!< IPv4 address of the peer
+    uint16_t port; //!< Port of the peer
+    uint32_t seq;  //!< Probe sequence number
+
+    /**
+     * \param o the other key
+     * \returns true if both keys are equal
+     */
+    bool operator== (const Key &o) const
+    {
+      return ip == o.ip && port == o.port && seq == o.seq;
+    }
+  };
+  /// Hash functor for Key
+  struct KeyHash
+  {
+    /**
+     * \param k the key
+     * \returns the hash of the key
+     */
+    size_t operator() (const Key &k) const
+    {
+      uint64_t h = (static_cast<uint64_t> (k.ip) << 16) | k.port;
+      return static_cast<size_t> ((h * 0x9e3779b97f4a7c15ULL) ^ k.seq);
+    }
+  };
+  /// Expiry queue entry
+  struct Pending
+  {
+    Key key;   //!< Probe key
+    Time sent; //!< Time the PING was sent
+  };
+
+  /**
+   * \param peer the endpoint
+   * \param seq the sequence number
+   * \returns the table key
+   */
+  static Key MakeKey (const InetSocketAddress &peer, uint32_t seq);
+
+  std::unordered_map<Key, Probe, KeyHash> m_probes; //!< Outstanding probes
+  std::deque<Pending> m_sendOrder; //!< Probes in send order, for expiry
+};
+
+} // namespace ns3
+
+#endif /* SCDT_PROBE_TABLE_H */
@@ -28,32 +28,47 @@
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
 #include "scdt-server.h"
+#include "scdt-socket-mux.h"
 #include "ns3/applications-module.h"
 #include "ns3/core-module.h"
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/network-module.h"
 #include "ns3/ipv4.h"
+#include "ns3/data-rate.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/object-factory.h"
+#include "ns3/pointer.h"
 
-#include <iostream>
-#include <fstream>
+#include <cmath>
+#include <algorithm>
 
-#define SENDTCPTIME 300 
-#define PACKSIZE 100
+#include <iostream>
 
 namespace ns3 {
 
-const uint8_t ATTACH[] = "ATTACH";
-const uint8_t PING[] = "PING";
-const uint8_t PING_RESP[] = "PINGRESPONSE";
-const uint8_t TRY_RESP[] = "TRY";
-const uint8_t ATTACH_SUC[] = "ATTACHSUCCESS";
-const uint8_t REATTACH[] = "REATTACH";
 bool m_connected = false;
 
 NS_LOG_COMPONENT_DEFINE ("ScdtServerApplication");
 
 NS_OBJECT_ENSURE_REGISTERED (ScdtServer);
 
+const ScdtServer::ControlHandler ScdtServer::m_controlHandlers[ScdtHeader::MESSAGE_TYPE_COUNT] = {
+  &ScdtServer::HandleAttach,        // ATTACH
+  &ScdtServer::HandlePing,          // PING
+  &ScdtServer::HandlePingResponse,  // PING_RESP
+  &ScdtServer::HandleTry,           // TRY
+  &ScdtServer::HandleAttachSuccess, // ATTACH_SUC
+  &ScdtServer::HandleReattach,      // REATTACH
+  &ScdtServer::DropData,            // DATA
+  &ScdtServer::HandlePingTrain,     // PING_TRAIN
+  &ScdtServer::HandleTrain,         // TRAIN
+  &ScdtServer::HandleHeartbeat,     // HEARTBEAT
+  &ScdtServer::HandleLeave,         // LEAVE
+};
+
 TypeId
 ScdtServer::GetTypeId (void)
 {
@@ -90,9 +105,248 @@ ScdtServer::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&ScdtServer::m_isRoot),
                    MakeUintegerChecker<uint8_t> ())
-    .AddTraceSource ("Tx", "A new packet is created and is sent",
+    .AddAttribute ("ProbeTimeout",
+                   "Time to wait for the answers to an ATTACH or to the PINGs of a "
+                   "TRY round before retrying; doubled on every retry",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&ScdtServer::m_probeTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("ProbeRetries",
+                   "Number of times an unanswered ATTACH or TRY round is retried "
+                   "before falling back to the root",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&ScdtServer::m_probeRetries),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxFanout",
+                   "Maximum number of children; 0 derives it from the DataRate of the "
+                   "access link and the StreamRate",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&ScdtServer::m_maxFanout),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("StatsCollector",
+                   "The ScdtStatsCollector the node reports its counters and chunk "
+                   "latencies to when it stops; none if null",
+                   PointerValue (),
+                   MakePointerAccessor (&ScdtServer::m_stats),
+                   MakePointerChecker<ScdtStatsCollector> ())
+    .AddAttribute ("AdmissionPolicy",
+                   "TypeId of the ScdtAdmissionPolicy deciding whether a node whose "
+                   "child slots are all taken evicts a child for a joiner or sends "
+                   "the joiner a TRY list",
+                   TypeIdValue (ScdtLowestRttAdmissionPolicy::GetTypeId ()),
+                   MakeTypeIdAccessor (&ScdtServer::m_admissionPolicyTid),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("StreamRate",
+                   "Bit rate of the stream each child must be fed at; the root "
+                   "produces data at this rate, and it sizes the fan-out when "
+                   "MaxFanout is 0.  A rate of 0 makes the root send StreamBytes "
+                   "as fast as each connection accepts them",
+                   DataRateValue (DataRate ("1Mbps")),
+                   MakeDataRateAccessor (&ScdtServer::m_streamRate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("StreamBytes",
+                   "Number of bytes the root streams; 0 streams until the "
+                   "application stops",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScdtServer::m_streamBytes),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("StreamStart",
+                   "Delay after the root starts before it streams data; children "
+                   "that attach later are served as soon as they connect",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&ScdtServer::m_streamStart),
+                   MakeTimeChecker ())
+    .AddAttribute ("ChildQueueSize",
+                   "Maximum number of chunks queued for a child whose connection "
+                   "cannot take them yet",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&ScdtServer::m_queueSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ChildQueuePolicy",
+                   "What to do with a new chunk when a child queue is full: Block "
+                   "stops reading from the parent until the queue drains, DropOldest "
+                   "drops the oldest queued chunk, SkipToLatest drops all queued "
+                   "chunks.  The root never stops its source; with Block a slow "
+                   "child is served the whole stream, late",
+                   EnumValue (ScdtServer::QUEUE_DROP_OLDEST),
+                   MakeEnumAccessor (&ScdtServer::m_queuePolicy),
+                   MakeEnumChecker (ScdtServer::QUEUE_BLOCK, "Block",
+                                    ScdtServer::QUEUE_DROP_OLDEST, "DropOldest",
+                                    ScdtServer::QUEUE_SKIP_TO_LATEST, "SkipToLatest"))
+    .AddAttribute ("BandwidthProbe",
+                   "Ask candidate parents for a packet train along with the PING and "
+                   "score them on RTT and estimated bandwidth",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ScdtServer::m_bandwidthProbe),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProbeTrainLength",
+                   "Number of packets in a bandwidth probe train; 2 is a packet pair",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&ScdtServer::m_trainLength),
+                   MakeUintegerChecker<uint8_t> (2, 16))
+    .AddAttribute ("ProbeTrainPacketSize",
+                   "Size of each packet of a bandwidth probe train",
+                   UintegerValue (1000),
+                   MakeUintegerAccessor (&ScdtServer::m_trainPacketSize),
+                   MakeUintegerChecker<uint16_t> (100, 1400))
+    .AddAttribute ("BandwidthWeight",
+                   "Exponent of the bandwidth penalty of the default parent score "
+                   "RTT * max (1, StreamRate / bandwidth) ^ BandwidthWeight; 0 "
+                   "scores on RTT alone",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&ScdtServer::m_bandwidthWeight),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("CoordinateProbes",
+                   "Number of candidates of a TRY list probed, those with the lowest "
+                   "RTT predicted by the Vivaldi coordinates; 0 probes them all.  "
+                   "Every candidate is probed while the node has no coordinate yet",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScdtServer::m_coordinateProbes),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("ControlAggregation",
+                   "Send the control messages generated for one destination in one "
+                   "event as a single datagram, and skip the HEARTBEAT to a child "
+                   "the stream fed since the last one while our position holds",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&ScdtServer::m_controlAggregation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TryProbes",
+                   "Number of candidates probed from the head of a TRY list, which "
+                   "the parent ranks by free child slots, then RTT to itself, then "
+                   "subtree size; 0 probes them all.  Applied before CoordinateProbes",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScdtServer::m_tryProbes),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("MaxEntryPoints",
+                   "Number of nearest ancestors learned from ATTACH_SUC that a node "
+                   "rejoins from, at random, after a REATTACH; without any, a node "
+                   "with no children rejoins from the configured entry points and "
+                   "one with children from the root, since an entry point may lie "
+                   "in its own subtree",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&ScdtServer::m_maxEntryPoints),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("MaxBackupParents",
+                   "Number of runners-up of the last TRY round kept to rejoin from, "
+                   "before the ancestors, when the parent is lost",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&ScdtServer::m_maxBackupParents),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("HeartbeatInterval",
+                   "Time between the HEARTBEATs a node sends to its parent and "
+                   "children; 0 disables failure detection",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&ScdtServer::m_heartbeatInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("HeartbeatMisses",
+                   "Number of HEARTBEAT intervals without news from the parent or a "
+                   "child before it is declared lost",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&ScdtServer::m_heartbeatMisses),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("OptimizeInterval",
+                   "Mean time between background optimization rounds, in which an "
+                   "attached node probes a few nodes near its parent and moves below "
+                   "one that would lower its stream delay; each interval is drawn "
+                   "within 50% of the mean.  0 disables optimization",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&ScdtServer::m_optimizeInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("OptimizeProbes",
+                   "Number of candidates probed per optimization round, drawn among "
+                   "the ancestors above the parent and the backup parents",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&ScdtServer::m_optimizeProbes),
+                   MakeUintegerChecker<uint8_t> (1))
+    .AddAttribute ("SwitchThreshold",
+                   "Fraction of its stream delay a node must save below a candidate "
+                   "before moving there, so that it does not flap between parents "
+                   "of similar delay",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&ScdtServer::m_switchThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("MaxDepth",
+                   "Deepest position a node may take in the tree, the root being at "
+                   "depth 0: joiners pass over candidates whose children would be "
+                   "deeper, and a node pushed deeper moves up.  0 for no bound",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScdtServer::m_maxDepth),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("MaxLatency",
+                   "Largest estimated latency from the root a node may have, the sum "
+                   "of half the RTTs along its path: joiners pass over candidates that "
+                   "cannot meet it, a node past it moves up, and chunks arriving later "
+                   "than it are not forwarded.  0 for no bound",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&ScdtServer::m_maxLatency),
+                   MakeTimeChecker ())
+    .AddAttribute ("BoundRetryInterval",
+                   "Least time between a join and the first relocation of a node "
+                   "outside MaxDepth or MaxLatency, and between two relocations",
+                   TimeValue (Seconds (10.0)),
+                   MakeTimeAccessor (&ScdtServer::m_boundRetryInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("DataPort",
+                   "TCP port parents open data connections to; shared by all the "
+                   "groups of a node",
+                   UintegerValue (500),
+                   MakeUintegerAccessor (&ScdtServer::m_dataPort),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("GroupId", "Id of the group (tree) this application belongs to; "
+                   "several groups can run on a node, sharing its sockets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScdtServer::m_groupId),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddTraceSource ("Tx",
+                     "A packet is sent: a control datagram, as flushed from the "
+                     "outbox, or a chunk or opening header on a data connection",
                      MakeTraceSourceAccessor (&ScdtServer::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("ChunkRx",
+                     "A complete stream chunk has been received from the parent",
+                     MakeTraceSourceAccessor (&ScdtServer::m_chunkRxTrace),
+                     "ns3::ScdtServer::ChunkRxTracedCallback")
+    .AddTraceSource ("ChildQueueDepth",
+                     "The number of chunks waiting for a child changed",
+                     MakeTraceSourceAccessor (&ScdtServer::m_childQueueDepthTrace),
+                     "ns3::ScdtServer::ChildQueueTracedCallback")
+    .AddTraceSource ("ChildQueueDrop",
+                     "Chunks were dropped for a child by the queue policy",
+                     MakeTraceSourceAccessor (&ScdtServer::m_childQueueDropTrace),
+                     "ns3::ScdtServer::ChildQueueTracedCallback")
+    .AddTraceSource ("ChunkForward",
+                     "A chunk received from the parent is passed on to the children",
+                     MakeTraceSourceAccessor (&ScdtServer::m_chunkForwardTrace),
+                     "ns3::ScdtServer::ChunkRxTracedCallback")
+    .AddTraceSource ("ProbeSent",
+                     "A PING has been sent",
+                     MakeTraceSourceAccessor (&ScdtServer::m_probeSentTrace),
+                     "ns3::ScdtServer::ProbeSentTracedCallback")
+    .AddTraceSource ("ProbeAnswered",
+                     "A PING_RESP matched an outstanding PING",
+                     MakeTraceSourceAccessor (&ScdtServer::m_probeAnsweredTrace),
+                     "ns3::ScdtServer::ProbeAnsweredTracedCallback")
+    .AddTraceSource ("Attach",
+                     "A join or rejoin completed with an ATTACH_SUC",
+                     MakeTraceSourceAccessor (&ScdtServer::m_attachTrace),
+                     "ns3::ScdtServer::AttachTracedCallback")
+    .AddTraceSource ("ParentChange",
+                     "The parent changed: an empty old address for a join, an empty "
+                     "new address when the parent is lost or evicts us",
+                     MakeTraceSourceAccessor (&ScdtServer::m_parentChangeTrace),
+                     "ns3::ScdtServer::AddressPairTracedCallback")
+    .AddTraceSource ("Eviction",
+                     "A child was sent REATTACH to make room for a joiner",
+                     MakeTraceSourceAccessor (&ScdtServer::m_evictionTrace),
+                     "ns3::ScdtServer::AddressPairTracedCallback")
+    .AddTraceSource ("ChildAdded",
+                     "A child took a slot",
+                     MakeTraceSourceAccessor (&ScdtServer::m_childAddedTrace),
+                     "ns3::ScdtServer::ChildTracedCallback")
+    .AddTraceSource ("ChildRemoved",
+                     "A child left its slot: lost, moved away or evicted",
+                     MakeTraceSourceAccessor (&ScdtServer::m_childRemovedTrace),
+                     "ns3::ScdtServer::ChildTracedCallback")
   ;
   return tid;
 }
@@ -106,22 +360,32 @@ ScdtServer::ScdtServer ()
   m_data = 0;
   m_dataSize = 0;
 
-  Address m_rootIp (m_peerAddress);
-  m_rootPort = m_peerPort;
-
-  m_children = new Address[MAX_FANOUT];
-  m_childrenPorts = new uint16_t[MAX_FANOUT];
-  m_shortestPing = new double[MAX_FANOUT];
-  m_childrenSockets = new Ptr<Socket>[MAX_FANOUT];
-
-  m_pings = new Address[MAX_PINGS];
-  m_pingStartTime = new double[MAX_PINGS];
-  m_pingTime = new double[MAX_PINGS];
-  m_numPings = 0;
-  m_numChildren = 0;
-
-  m_serializedChildrenSize = 1;
-  m_serializedChildren = new uint8_t[1];
+  m_rootPort = 0;
+  m_fanout = 0;
+
+  m_nextProbeSeq = 0;
+  m_possibleParentsCntr = 0;
+  m_attachAttempts = 0;
+  m_probeAttempts = 0;
+  m_groupId = 0;
+  m_attached = false;
+  m_streaming = false;
+  m_streamProduced = 0;
+  m_rxBytes = 0;
+  m_rxChunks = 0;
+  m_controlTx = 0;
+  m_controlMessages = 0;
+  m_positionChanged = false;
+  m_streamDelay = Time::Max ();
+  m_parentSwitches = 0;
+  m_depth = 0;
+  m_rootLatency = Seconds (0);
+  m_relocating = false;
+  m_relocations = 0;
+  m_lateChunks = 0;
+  m_rxBuffer = Create<Packet> ();
+  m_parentScore = MakeCallback (&ScdtServer::ScoreParent, this);
+  m_entryRng = CreateObject<UniformRandomVariable> ();
 }
 
 ScdtServer::~ScdtServer()
@@ -132,14 +396,6 @@ ScdtServer::~ScdtServer()
   delete [] m_data;
   m_data = 0;
   m_dataSize = 0;
-
-  delete [] m_children;
-  delete [] m_childrenPorts;
-  delete [] m_shortestPing;
-  delete [] m_pings;
-  delete [] m_pingStartTime;
-  delete [] m_pingTime;
-  delete [] m_serializedChildren;
 }
 
 void
@@ -147,21 +403,11 @@ ScdtServer::SetRemote (Address rootIp, uint16_t rootPort, bool isRoot)
 {
   m_rootIp = Address(rootIp);
   m_rootPort = rootPort;
-  
-  m_children = new Address[MAX_FANOUT];
-  m_childrenPorts = new uint16_t[MAX_FANOUT];
-  m_shortestPing = new double[MAX_FANOUT];
 
   m_isRoot = isRoot;
 
-  m_pings = new Address[MAX_PINGS];
-  m_pingStartTime = new double[MAX_PINGS];
-  m_pingTime = new double[MAX_PINGS];
-  m_numPings = 0;
-  m_numChildren = 0;
-
-  m_serializedChildrenSize = 1;
-  m_serializedChildren = new uint8_t[1];
+  m_children.clear ();
+  m_tryList = 0;
 }
 
 void 
@@ -183,30 +429,168 @@ void
 ScdtServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_admissionPolicy = 0;
   Application::DoDispose ();
 }
 
 void
 ScdtServer::DoSetup (void)
 {
-  memcpy (&m_rootIp, &m_peerAddress, sizeof (Address));
+  m_rootIp = m_peerAddress;
   m_rootPort = m_peerPort;
 
-  latencyDiff = 0;
-  m_children = new Address[MAX_FANOUT];
-  m_childrenPorts = new uint16_t[MAX_FANOUT];
-  m_shortestPing = new double[MAX_FANOUT];
+  m_fanout = ComputeFanout ();
+  NS_LOG_LOGIC ("Node " << GetNode ()->GetId () << " accepts up to " << static_cast<uint32_t> (m_fanout) << " children");
+
+  // One allocation for the lifetime of the application: an attach only
+  // adds a child below the fan-out, and StartPreset refuses more
+  std::vector<Child> ().swap (m_children);
+  m_children.reserve (m_fanout);
+  m_tryList = 0;
+
+  if (m_admissionPolicy == 0)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (m_admissionPolicyTid);
+      m_admissionPolicy = factory.Create<ScdtAdmissionPolicy> ();
+    }
+}
+
+uint8_t
+ScdtServer::ComputeFanout (void) const
+{
+  if (m_maxFanout != 0)
+    {
+      return m_maxFanout;
+    }
+
+  // Automatic mode: as many children as the uplink can feed at the
+  // stream rate, but always at least one so the tree can grow.
+  NS_ABORT_MSG_IF (m_streamRate.GetBitRate () == 0, "Automatic fan-out needs a non-zero StreamRate");
+  DataRateValue rate;
+  Ptr<Ipv4> ipv4 = GetNode ()->GetObject<Ipv4> ();
+  if (ipv4 == 0 || ipv4->GetNInterfaces () < 2
+      || !ipv4->GetNetDevice (1)->GetAttributeFailSafe ("DataRate", rate))
+    {
+      NS_LOG_WARN ("Node " << GetNode ()->GetId () << " has no access link DataRate, using a fan-out of 1");
+      return 1;
+    }
+  uint64_t fanout = rate.Get ().GetBitRate () / m_streamRate.GetBitRate ();
+  return std::max<uint64_t> (1, std::min<uint64_t> (fanout, 255));
+}
+
+uint8_t
+ScdtServer::GetFanout (void) const
+{
+  return m_fanout;
+}
+
+Address
+ScdtServer::GetParent (void) const
+{
+  return m_parentIp;
+}
+
+bool
+ScdtServer::IsAttached (void) const
+{
+  return m_attached;
+}
+
+bool
+ScdtServer::IsRoot (void) const
+{
+  return m_isRoot;
+}
+
+uint32_t
+ScdtServer::GetNChildren (void) const
+{
+  return m_children.size ();
+}
+
+Address
+ScdtServer::GetChild (uint32_t i) const
+{
+  NS_ASSERT (i < m_children.size ());
+  return m_children[i].addr;
+}
+
+Time
+ScdtServer::GetChildRtt (uint32_t i) const
+{
+  NS_ASSERT (i < m_children.size ());
+  return m_children[i].rtt;
+}
+
+uint64_t
+ScdtServer::GetRxBytes (void) const
+{
+  return m_rxBytes;
+}
+
+uint64_t
+ScdtServer::GetRxChunks (void) const
+{
+  return m_rxChunks;
+}
+
+const ScdtLatencyHistogram &
+ScdtServer::GetLatencyHistogram (void) const
+{
+  return m_latency;
+}
+
+uint64_t
+ScdtServer::GetControlTx (void) const
+{
+  return m_controlTx;
+}
+
+uint64_t
+ScdtServer::GetControlMessages (void) const
+{
+  return m_controlMessages;
+}
+
+Time
+ScdtServer::GetStreamDelay (void) const
+{
+  if (m_isRoot)
+    {
+      return Seconds (0);
+    }
+  return m_streamDelay;
+}
+
+uint32_t
+ScdtServer::GetParentSwitches (void) const
+{
+  return m_parentSwitches;
+}
+
+uint16_t
+ScdtServer::GetDepth (void) const
+{
+  return m_depth;
+}
 
-  m_pings = new Address[MAX_PINGS];
-  m_pingStartTime = new double[MAX_PINGS];
-  m_pingTime = new double[MAX_PINGS];
-  m_numPings = 0;
-  m_numChildren = 0;
+Time
+ScdtServer::GetRootLatency (void) const
+{
+  return m_rootLatency;
+}
 
-  m_serializedChildrenSize = 1;
-  m_serializedChildren = new uint8_t[1];
+uint32_t
+ScdtServer::GetRelocations (void) const
+{
+  return m_relocations;
+}
 
-  m_nextPotentialParentPing = 9999999;
+uint64_t
+ScdtServer::GetLateChunks (void) const
+{
+  return m_lateChunks;
 }
 
 void 
@@ -215,16 +599,12 @@ ScdtServer::StartApplication (void)
   NS_LOG_FUNCTION (this);
   if (m_socket == 0)
     {
-      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
       ScdtServer::DoSetup();
-      m_socket = Socket::CreateSocket (GetNode (), tid);
       if (Ipv4Address::IsMatchingType(m_rootIp) == true)
         {
-          InetSocketAddress local = InetSocketAddress (Ipv4Address::GetAny (), m_rootPort);
-          if (m_socket->Bind (local) == -1) 
-            {
-              NS_FATAL_ERROR ("Failed to bind socket");
-            }
+          // The control socket is shared with the other groups of the node
+          m_mux = ScdtSocketMux::GetMux (GetNode ());
+          m_socket = m_mux->RegisterControl (m_groupId, m_rootPort, this);
         }
       else
         {
@@ -237,264 +617,588 @@ ScdtServer::StartApplication (void)
         }
     }
 
-  m_socket->SetRecvCallback (MakeCallback (&ScdtServer::HandleRead, this));
-  m_socket->SetAllowBroadcast (true);
-  
   if (!m_isRoot) 
     {
       m_parentIp = m_rootIp;
       m_parentPort = m_rootPort;
      
-      //Simulator::Schedule(Seconds(3.5), &ScdtServer::SetTcpReceiveSocket, this);
-      m_socket->SendTo (ATTACH, 7, 0, InetSocketAddress (Ipv4Address::ConvertFrom (m_rootIp), m_rootPort));
-
-      Simulator::Schedule (Seconds(SENDTCPTIME-20), &ScdtServer::SetTcpReceiveSocket, this);
-      //std::string cmd ("ATTACH");
-      //ScdtServer::SetFill(cmd);
-      //ScheduleTransmit (Seconds (0.), &ScdtServer::TryAttach);
+      // Listen before joining so the parent can connect on ATTACH_SUC
+      ScdtServer::SetTcpReceiveSocket ();
+      if (m_presetAncestors.empty ())
+        {
+          StartJoin ();
+        }
     }
   else 
     {
-      Simulator::Schedule (Seconds (SENDTCPTIME), &ScdtServer::rootSendData, this);
+      m_streamEvent = Simulator::Schedule (m_streamStart, &ScdtServer::rootSendData, this);
+    }
+  StartPreset ();
+  if (!m_heartbeatInterval.IsZero ())
+    {
+      m_heartbeatEvent = Simulator::Schedule (m_heartbeatInterval, &ScdtServer::Heartbeat, this);
+    }
+  if (!m_isRoot && !m_optimizeInterval.IsZero ())
+    {
+      m_optimizeEvent = Simulator::Schedule (m_optimizeInterval, &ScdtServer::Optimize, this);
     }
-  Simulator::Schedule (Seconds (SENDTCPTIME-10), &ScdtServer::SetSockets, this);
   //NS_LOG_INFO ("Successfully started application");
 }
 
 void
 ScdtServer::SetTcpReceiveSocket() {
-      TypeId tid = TcpSocketFactory::GetTypeId ();
-      InetSocketAddress local =  InetSocketAddress (Ipv4Address::GetAny (), 500);
-      m_parentSocket = Socket::CreateSocket (GetNode(), tid);
-      if (m_parentSocket->Bind (local) == -1) {
-          NS_FATAL_ERROR ("Failed to bind socket to parent");
-      }
-      m_parentSocket->Listen();
-      m_parentSocket->ShutdownSend();
-      m_parentSocket->SetRecvCallback(MakeCallback (&ScdtServer::HandleTcpRead, this));
-      m_parentSocket->SetAcceptCallback(MakeNullCallback<bool, Ptr<Socket>, const Address &> (), MakeCallback (&ScdtServer::HandleAccept, this));
+      m_mux->RegisterData (m_groupId, m_dataPort);
 }
 
 void
 ScdtServer::HandleAccept(Ptr<Socket> s, const Address& from) {
+    // A new connection means our parent changed; drop the old stream
+    if (m_parentDataSocket != 0)
+      {
+        m_parentDataSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+        m_parentDataSocket->Close ();
+      }
+    m_parentDataSocket = s;
+    // A partial chunk of the old stream can never be completed
+    m_rxBuffer = Create<Packet> ();
     s->SetRecvCallback (MakeCallback (&ScdtServer::HandleTcpRead, this));
+    if (s->GetRxAvailable () > 0)
+      {
+        // Chunks that arrived with the opening header
+        HandleTcpRead (s);
+      }
 }
 
 void
 ScdtServer::HandleTcpRead(Ptr<Socket> socket)
 {
-    Address from;
-    Ptr<Packet> packet = socket->RecvFrom(from);
-    //std::cout << "Handling read";
-    endTime = Simulator::Now ().GetSeconds();
-    ScdtServer::SendData(packet);
+    // Read no further than the end of the current chunk: while a child
+    // queue blocks us, the rest of the stream stays in TCP's receive
+    // buffer and throttles our parent
+    ScdtChunkHeader chunkHeader;
+    uint32_t headerSize = chunkHeader.GetSerializedSize ();
+    while (!IsBlocked ())
+      {
+        uint32_t chunkSize = headerSize;
+        if (m_rxBuffer->GetSize () >= headerSize)
+          {
+            m_rxBuffer->PeekHeader (chunkHeader);
+            chunkSize += chunkHeader.GetLength ();
+            if (m_rxBuffer->GetSize () == chunkSize)
+              {
+                Ptr<Packet> chunk = m_rxBuffer;
+                m_rxBuffer = Create<Packet> ();
+                HandleChunk (chunk, chunkHeader);
+                continue;
+              }
+          }
+        Ptr<Packet> packet = socket->Recv (chunkSize - m_rxBuffer->GetSize (), 0);
+        if (packet == 0 || packet->GetSize () == 0)
+          {
+            break;
+          }
+        m_rxBuffer->AddAtEnd (packet);
+      }
 }
 
 void
-ScdtServer::SendData (Ptr<Packet> packet) 
+ScdtServer::HandleChunk (Ptr<Packet> chunk, const ScdtChunkHeader & chunkHeader)
 {
-      
-  for (int i = 0; i < m_numChildren; i++) {
-    ScdtServer::SendTcp(m_childrenSockets[i], packet);
+  Time latency = Simulator::Now () - chunkHeader.GetTs ();
+  m_rxChunks++;
+  m_rxBytes += chunkHeader.GetLength ();
+  m_latency.Add (latency);
+  // Smoothed with a gain of 1/8, as TCP does its RTT
+  m_streamDelay = m_streamDelay == Time::Max () ? latency
+    : NanoSeconds ((m_streamDelay.GetNanoSeconds () * 7 + latency.GetNanoSeconds ()) / 8);
+  m_chunkRxTrace (chunkHeader.GetSeq (), latency);
+  if (m_controlAggregation && m_attached)
+    {
+      // The stream stands in for the parent's HEARTBEATs
+      m_parentHeard = Simulator::Now ();
     }
+  m_lastChunk = Simulator::Now ();
+  if (!m_maxLatency.IsZero () && latency > m_maxLatency)
+    {
+      // Already too late for us, so too late for everyone below
+      NS_LOG_LOGIC ("Chunk " << chunkHeader.GetSeq () << " late by "
+                    << (latency - m_maxLatency).GetSeconds () << "s, not forwarded");
+      m_lateChunks++;
+      return;
+    }
+  if (!m_children.empty ())
+    {
+      m_chunkForwardTrace (chunkHeader.GetSeq (), latency);
+    }
+  ScdtServer::SendData (chunk);
 }
 
 void
-ScdtServer::SetSockets() {
-   TypeId tid = TcpSocketFactory::GetTypeId ();
-  for (int i = 0; i < m_numChildren; i++) 
+ScdtServer::SendData (Ptr<Packet> packet) 
+{
+  for (uint32_t i = 0; i < m_children.size (); i++)
     {
-        m_childrenSockets[i] = Socket::CreateSocket (GetNode (), tid);
-        //InetSocketAddress local =  InetSocketAddress (InetSocketAddress::ConvertFrom (m_children[i]).GetIpv4 (), 500);
-
-        //NS_LOG_INFO("Sending data to child: " << InetSocketAddress::ConvertFrom(m_children[i]).GetIpv4());
-      // Fatal error if socket type is not NS3_SOCK_STREAM or NS3_SOCK_SEQPACKET
-        if (m_childrenSockets[i]->GetSocketType () != Socket::NS3_SOCK_STREAM &&
-          m_childrenSockets[i]->GetSocketType () != Socket::NS3_SOCK_SEQPACKET)
-          {
-            NS_FATAL_ERROR ("Using BulkSend with an incompatible socket type. "
-                            "BulkSend requires SOCK_STREAM or SOCK_SEQPACKET. "
-                            "In other words, use TCP instead of UDP.");
-          }
-
-        if (Inet6SocketAddress::IsMatchingType (m_children[i]))
-          {
-            std::cout << "NOT GOOD\n";
-            if (m_childrenSockets[i]->Bind6 () == -1)
-              {
-                NS_FATAL_ERROR ("Failed to bind socket");
-              }
-          }
-        else if (InetSocketAddress::IsMatchingType (m_children[i]))
-          {
-            if (m_childrenSockets[i]->Bind () == -1)
-              {
-                NS_FATAL_ERROR ("Failed to bind socket");
-              }
-          }
-
-        m_childrenSockets[i]->ShutdownRecv ();
-        //m_childrenSockets[i]->SetConnectCallback (
-      //    MakeCallback (&ScdtServer::ConnectionSucceeded, this),
-       //   MakeCallback (&ScdtServer::ConnectionFailed, this));
-        m_childrenSockets[i]->SetSendCallback (
-          MakeCallback (&ScdtServer::DataSend, this));
-        m_childrenSockets[i]->Connect (InetSocketAddress(InetSocketAddress::ConvertFrom(m_children[i]).GetIpv4 (), 500));
+      if (m_children[i].socket != 0)
+        {
+          EnqueueChunk (i, packet);
+          DrainChild (i);
         }
-   
+    }
 }
+
 void
-ScdtServer::rootSendData () 
+ScdtServer::EnqueueChunk (uint8_t i, Ptr<Packet> chunk)
 {
-    uint8_t buf[PACKSIZE];
-    double curTime = Simulator::Now().GetSeconds();
-    memcpy(buf, &curTime, sizeof(double));
-    Ptr<Packet> packet = Create<Packet> (buf, PACKSIZE);
-    
-    
-  for (int i = 0; i < m_numChildren; i++) {
-    //NS_LOG_INFO("Starting up TCP streams");
-    for (int j = 0; j < 1000; j++) {
-     ScdtServer::SendTcp(m_childrenSockets[i], packet);
-    }
+  std::list<Ptr<Packet> > &queue = m_children[i].queue;
+  if (queue.size () >= m_queueSize)
+    {
+      uint32_t dropped = 0;
+      switch (m_queuePolicy)
+        {
+        case QUEUE_DROP_OLDEST:
+          queue.pop_front ();
+          dropped = 1;
+          break;
+        case QUEUE_SKIP_TO_LATEST:
+          dropped = queue.size ();
+          queue.clear ();
+          break;
+        case QUEUE_BLOCK:
+        default:
+          // HandleTcpRead does not read while a queue is full
+          break;
+        }
+      if (dropped > 0)
+        {
+          m_childQueueDropTrace (m_children[i].addr, dropped);
+        }
     }
+  queue.push_back (chunk);
+  m_childQueueDepthTrace (m_children[i].addr, queue.size ());
 }
 
-void 
-ScdtServer::StopApplication ()
+void
+ScdtServer::DrainChild (uint8_t i)
 {
-  NS_LOG_FUNCTION (this);
-  if (!m_isRoot) {
-      
-        
-        std::ofstream file;
-        file.open("times.txt", std::fstream::app);
-        file << endTime << "\n";
-        file.close();
-    if (latencyDiff == 0) {
-        NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": curAddress: " << GetNode()->GetObject<Ipv4>()->GetAddress(1,0).GetLocal() << " NO PACKET");
-     } 
-  }
-  int childCount = (int) m_numChildren;
-  std::ofstream tile;
-  tile.open("child.txt", std::fstream::app);
-  tile << childCount << "\n";
-  tile.close();
-
-  NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": curAddress: " << GetNode()->GetObject<Ipv4>()->GetAddress(1,0).GetLocal());
-     
-
-  for (int i = 0; i < m_numChildren; i++) 
+  Ptr<Socket> socket = m_children[i].socket;
+  std::list<Ptr<Packet> > &queue = m_children[i].queue;
+  uint32_t before = queue.size ();
+  // TCP takes a packet whole or not at all, so the framing of the
+  // stream towards the child is kept
+  while (socket != 0 && !queue.empty ()
+         && socket->GetTxAvailable () >= queue.front ()->GetSize ())
     {
-
-      InetSocketAddress curChild = InetSocketAddress::ConvertFrom (m_children[i]);
-      NS_LOG_INFO ("-- " << curChild.GetIpv4 ());
+      if (SendTcp (socket, queue.front ()) < 0)
+        {
+          break;
+        }
+      queue.pop_front ();
+      m_children[i].fed = true;
     }
-
-  if (m_socket != 0) 
+  if (queue.size () != before)
     {
-      m_socket->Close ();
-      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-      m_socket = 0;
+      m_childQueueDepthTrace (m_children[i].addr, queue.size ());
     }
-
-  Simulator::Cancel (m_sendEvent);
 }
 
-void 
-ScdtServer::SetDataSize (uint32_t dataSize)
+void
+ScdtServer::ResumeReading (bool blocked)
 {
-  NS_LOG_FUNCTION (this << dataSize);
-
-  //
-  // If the client is setting the echo packet data size this way, we infer
-  // that she doesn't care about the contents of the packet at all, so 
-  // neither will we.
-  //
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
-  m_size = dataSize;
+  if (blocked && !IsBlocked () && m_parentDataSocket != 0)
+    {
+      // The parent filled our receive window while we were blocked, so
+      // no receive callback will come: read the chunks left in it
+      HandleTcpRead (m_parentDataSocket);
+    }
 }
 
-uint32_t 
-ScdtServer::GetDataSize (void) const
+bool
+ScdtServer::IsBlocked (void) const
 {
-  NS_LOG_FUNCTION (this);
-  return m_size;
+  if (m_queuePolicy != QUEUE_BLOCK)
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      if (m_children[i].socket != 0 && m_children[i].queue.size () >= m_queueSize)
+        {
+          return true;
+        }
+    }
+  return false;
 }
 
-void 
-ScdtServer::SetFill (std::string fill)
+void
+ScdtServer::ConnectChild (uint8_t i)
 {
-  NS_LOG_FUNCTION (this << fill);
-
-  uint32_t dataSize = fill.size () + 1;
-
-  if (dataSize != m_dataSize)
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i) << m_children[i].addr);
+  if (m_children[i].socket != 0)
     {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
+      // Repeated ATTACH from an existing child: reuse the connection
+      return;
     }
-
-  memcpy (m_data, fill.c_str (), dataSize);
-
-  //
-  // Overwrite packet size attribute.
-  //
-  m_size = dataSize;
+  TypeId tid = TcpSocketFactory::GetTypeId ();
+  Ptr<Socket> socket = Socket::CreateSocket (GetNode (), tid);
+  if (socket->Bind () == -1)
+    {
+      NS_FATAL_ERROR ("Failed to bind socket");
+    }
+  socket->ShutdownRecv ();
+  socket->SetConnectCallback (
+    MakeCallback (&ScdtServer::ConnectionSucceeded, this),
+    MakeCallback (&ScdtServer::ConnectionFailed, this));
+  socket->SetSendCallback (
+    MakeCallback (&ScdtServer::DataSend, this));
+  socket->Connect (InetSocketAddress (m_children[i].addr.GetIpv4 (), m_dataPort));
+  m_children[i].socket = socket;
+  // Sent ahead of any chunk: the child's mux hands the connection to
+  // our group on this header
+  ScdtHeader opening;
+  opening.SetType (ScdtHeader::DATA);
+  opening.SetGroupId (m_groupId);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (opening);
+  SendTcp (socket, p);
+  // A live stream is joined at its current position; a fixed-size
+  // transfer is sent to every child in full
+  m_children[i].streamOffset = m_streamRate.GetBitRate () != 0 ? m_streamProduced : 0;
 }
 
-void 
-ScdtServer::SetFill (uint8_t fill, uint32_t dataSize)
+void
+ScdtServer::DisconnectChild (uint8_t i)
 {
-  NS_LOG_FUNCTION (this << fill << dataSize);
-  if (dataSize != m_dataSize)
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i) << m_children[i].addr);
+  if (m_children[i].socket == 0)
     {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
+      return;
     }
-
-  memset (m_data, fill, dataSize);
-
-  //
-  // Overwrite packet size attribute.
-  //
-  m_size = dataSize;
+  m_children[i].socket->SetConnectCallback (MakeNullCallback<void, Ptr<Socket> > (),
+                                            MakeNullCallback<void, Ptr<Socket> > ());
+  m_children[i].socket->SetSendCallback (MakeNullCallback<void, Ptr<Socket>, uint32_t> ());
+  m_children[i].socket->Close ();
+  m_children[i].socket = 0;
+  m_children[i].queue.clear ();
 }
 
-void 
-ScdtServer::SetFill (uint8_t *fill, uint32_t fillSize, uint32_t dataSize)
+void
+ScdtServer::rootSendData () 
 {
-  NS_LOG_FUNCTION (this << fill << fillSize << dataSize);
-  if (dataSize != m_dataSize)
+  NS_LOG_FUNCTION (this);
+  m_streaming = true;
+  m_streamStartTime = Simulator::Now ();
+  m_streamProduced = 0;
+  for (uint32_t i = 0; i < m_children.size (); i++)
     {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
+      m_children[i].streamOffset = 0;
     }
-
-  if (fillSize >= dataSize)
+  if (m_streamRate.GetBitRate () == 0)
     {
-      memcpy (m_data, fill, dataSize);
-      m_size = dataSize;
+      // Total-bytes mode: everything is available at once
+      NS_ABORT_MSG_IF (m_streamBytes == 0, "A StreamRate of 0 needs a non-zero StreamBytes");
+      m_streamProduced = m_streamBytes;
+      FillChildren ();
       return;
     }
+  m_streamEvent = Simulator::Schedule (m_streamRate.CalculateBytesTxTime (m_size),
+                                       &ScdtServer::ProduceStream, this);
+}
 
-  //
-  // Do all but the final fill.
-  //
-  uint32_t filled = 0;
-  while (filled + fillSize < dataSize)
+void
+ScdtServer::ProduceStream (void)
+{
+  NS_LOG_FUNCTION (this << m_streamProduced);
+  m_streamProduced += m_size;
+  if (m_streamBytes != 0 && m_streamProduced >= m_streamBytes)
     {
-      memcpy (&m_data[filled], fill, fillSize);
-      filled += fillSize;
+      m_streamProduced = m_streamBytes;
     }
-
-  //
-  // Last fill may be partial
+  else
+    {
+      m_streamEvent = Simulator::Schedule (m_streamRate.CalculateBytesTxTime (m_size),
+                                           &ScdtServer::ProduceStream, this);
+    }
+  FillChildren ();
+}
+
+void
+ScdtServer::FillChildren (void)
+{
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      FillChild (i);
+    }
+}
+
+void
+ScdtServer::FillChild (uint8_t i)
+{
+  Ptr<Socket> socket = m_children[i].socket;
+  if (socket == 0)
+    {
+      return;
+    }
+  // The chunks a child has not been sent yet form its queue at the root
+  uint64_t queueBytes = static_cast<uint64_t> (m_queueSize) * m_size;
+  if (m_streamRate.GetBitRate () != 0 && m_queuePolicy != QUEUE_BLOCK
+      && m_streamProduced - m_children[i].streamOffset > queueBytes)
+    {
+      uint64_t keep = m_queuePolicy == QUEUE_DROP_OLDEST ? queueBytes : m_size;
+      uint64_t offset = m_streamProduced - keep;
+      offset -= offset % m_size;
+      m_childQueueDropTrace (m_children[i].addr, (offset - m_children[i].streamOffset) / m_size);
+      m_children[i].streamOffset = offset;
+    }
+  while (m_children[i].streamOffset < m_streamProduced)
+    {
+      uint32_t chunk = std::min<uint64_t> (m_size, m_streamProduced - m_children[i].streamOffset);
+      ScdtChunkHeader chunkHeader;
+      chunkHeader.SetLength (chunk);
+      chunkHeader.SetSeq (m_children[i].streamOffset / m_size);
+      chunkHeader.SetTs (GetChunkOrigin (chunkHeader.GetSeq ()));
+      if (socket->GetTxAvailable () < chunkHeader.GetSerializedSize () + chunk)
+        {
+          // Resumed from DataSend once the connection drains
+          break;
+        }
+      Ptr<Packet> p = Create<Packet> (chunk);
+      p->AddHeader (chunkHeader);
+      if (SendTcp (socket, p) < 0)
+        {
+          break;
+        }
+      m_children[i].streamOffset += chunk;
+      m_children[i].fed = true;
+    }
+  m_childQueueDepthTrace (m_children[i].addr, (m_streamProduced - m_children[i].streamOffset + m_size - 1) / m_size);
+}
+
+Time
+ScdtServer::GetChunkOrigin (uint32_t seq) const
+{
+  if (m_streamRate.GetBitRate () == 0)
+    {
+      return m_streamStartTime;
+    }
+  // Chunk seq is produced by the (seq + 1)-th ProduceStream
+  return m_streamStartTime + m_streamRate.CalculateBytesTxTime (m_size) * (static_cast<int64_t> (seq) + 1);
+}
+
+int32_t
+ScdtServer::FindChild (const Address & addr) const
+{
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      if (m_children[i].addr.IsEqual (addr))
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+int32_t
+ScdtServer::GetChildIndex (Ptr<Socket> socket) const
+{
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      if (m_children[i].socket == socket)
+        {
+          return i;
+        }
+    }
+  return -1;
+}
+
+void 
+ScdtServer::StopApplication ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_isRoot && m_rxChunks == 0)
+    {
+      NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": curAddress: " << GetNode()->GetObject<Ipv4>()->GetAddress(1,0).GetLocal() << " NO PACKET");
+    }
+  if (m_stats != 0)
+    {
+      ReportStats ();
+    }
+
+  NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": curAddress: " << GetNode()->GetObject<Ipv4>()->GetAddress(1,0).GetLocal());
+  if (!m_isRoot)
+    {
+      NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": join latency " << m_joinLatency.GetSeconds () << "s");
+      NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": " << m_latency.GetCount () << " chunks, latency"
+                   << " p50 " << m_latency.GetQuantile (0.5).GetSeconds () << "s"
+                   << " p90 " << m_latency.GetQuantile (0.9).GetSeconds () << "s"
+                   << " p99 " << m_latency.GetQuantile (0.99).GetSeconds () << "s"
+                   << " max " << m_latency.GetMax ().GetSeconds () << "s");
+    }
+     
+
+  for (uint32_t i = 0; i < m_children.size (); i++) 
+    {
+
+      NS_LOG_INFO ("-- " << m_children[i].addr.GetIpv4 ());
+    }
+
+  if (m_socket != 0) 
+    {
+      FlushControl ();
+      m_mux->Unregister (m_groupId);
+      m_socket = 0;
+    }
+
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      DisconnectChild (i);
+    }
+  if (m_parentDataSocket != 0)
+    {
+      m_parentDataSocket->Close ();
+      m_parentDataSocket = 0;
+    }
+
+  Simulator::Cancel (m_sendEvent);
+  Simulator::Cancel (m_streamEvent);
+  Simulator::Cancel (m_attachEvent);
+  Simulator::Cancel (m_probeEvent);
+  Simulator::Cancel (m_heartbeatEvent);
+  Simulator::Cancel (m_optimizeEvent);
+  Simulator::Cancel (m_optimizeDeadline);
+  Simulator::Cancel (m_flushEvent);
+  m_outbox.clear ();
+}
+
+void
+ScdtServer::ReportStats (void)
+{
+  uint32_t row = m_stats->Register (GetNode ()->GetId ());
+  m_stats->Set (row, "group", m_groupId);
+  m_stats->Set (row, "root", m_isRoot);
+  m_stats->Set (row, "attached", m_isRoot || m_attached);
+  m_stats->Set (row, "depth", m_depth);
+  m_stats->Set (row, "fanout", m_fanout);
+  m_stats->Set (row, "children", m_children.size ());
+  m_stats->Set (row, "subtree", GetSubtreeSize ());
+  m_stats->Set (row, "rxChunks", m_rxChunks);
+  m_stats->Set (row, "rxBytes", m_rxBytes);
+  m_stats->Set (row, "lateChunks", m_lateChunks);
+  m_stats->Set (row, "controlTx", m_controlTx);
+  m_stats->Set (row, "controlMessages", m_controlMessages);
+  m_stats->Set (row, "parentSwitches", m_parentSwitches);
+  m_stats->Set (row, "relocations", m_relocations);
+  if (!m_isRoot && !m_joinLatency.IsZero ())
+    {
+      m_stats->Set (row, "joinLatency", m_joinLatency.GetSeconds ());
+      ScdtLatencyHistogram join;
+      join.Add (m_joinLatency);
+      m_stats->Merge ("joinLatency", join);
+    }
+  // Left empty for the nodes that received nothing
+  if (m_rxChunks > 0)
+    {
+      m_stats->Set (row, "lastChunk", m_lastChunk.GetSeconds ());
+      m_stats->Set (row, "p50", m_latency.GetQuantile (0.5).GetSeconds ());
+      m_stats->Set (row, "p99", m_latency.GetQuantile (0.99).GetSeconds ());
+      m_stats->Set (row, "maxLatency", m_latency.GetMax ().GetSeconds ());
+    }
+  m_stats->Merge ("chunkLatency", m_latency);
+}
+
+void 
+ScdtServer::SetDataSize (uint32_t dataSize)
+{
+  NS_LOG_FUNCTION (this << dataSize);
+
+  //
+  // If the client is setting the echo packet data size this way, we infer
+  // that she doesn't care about the contents of the packet at all, so 
+  // neither will we.
+  //
+  delete [] m_data;
+  m_data = 0;
+  m_dataSize = 0;
+  m_size = dataSize;
+}
+
+uint32_t 
+ScdtServer::GetDataSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size;
+}
+
+void 
+ScdtServer::SetFill (std::string fill)
+{
+  NS_LOG_FUNCTION (this << fill);
+
+  uint32_t dataSize = fill.size () + 1;
+
+  if (dataSize != m_dataSize)
+    {
+      delete [] m_data;
+      m_data = new uint8_t [dataSize];
+      m_dataSize = dataSize;
+    }
+
+  memcpy (m_data, fill.c_str (), dataSize);
+
+  //
+  // Overwrite packet size attribute.
+  //
+  m_size = dataSize;
+}
+
+void 
+ScdtServer::SetFill (uint8_t fill, uint32_t dataSize)
+{
+  NS_LOG_FUNCTION (this << fill << dataSize);
+  if (dataSize != m_dataSize)
+    {
+      delete [] m_data;
+      m_data = new uint8_t [dataSize];
+      m_dataSize = dataSize;
+    }
+
+  memset (m_data, fill, dataSize);
+
+  //
+  // Overwrite packet size attribute.
+  //
+  m_size = dataSize;
+}
+
+void 
+ScdtServer::SetFill (uint8_t *fill, uint32_t fillSize, uint32_t dataSize)
+{
+  NS_LOG_FUNCTION (this << fill << fillSize << dataSize);
+  if (dataSize != m_dataSize)
+    {
+      delete [] m_data;
+      m_data = new uint8_t [dataSize];
+      m_dataSize = dataSize;
+    }
+
+  if (fillSize >= dataSize)
+    {
+      memcpy (m_data, fill, dataSize);
+      m_size = dataSize;
+      return;
+    }
+
+  //
+  // Do all but the final fill.
+  //
+  uint32_t filled = 0;
+  while (filled + fillSize < dataSize)
+    {
+      memcpy (&m_data[filled], fill, fillSize);
+      filled += fillSize;
+    }
+
+  //
+  // Last fill may be partial
   //
   memcpy (&m_data[filled], fill, dataSize - filled);
 
@@ -577,270 +1281,1446 @@ ScdtServer::Send (void)
 }
 
 
-uint32_t
-ScdtServer::SendPing (Ptr<Socket> socket, Address & dest) 
+void
+ScdtServer::SendControl (Ptr<Packet> payload, uint8_t type, const Address & to, uint32_t seq)
 {
-  //NS_LOG_INFO ("Sending ping...");
-  uint32_t curNumPings = m_numPings;      
-
-  memcpy (&m_pings[m_numPings], &dest, sizeof (Address));
-  m_pingStartTime[m_numPings] = Simulator::Now ().GetSeconds ();
-  m_pingTime[m_numPings++] = 99999999;
-  socket->SendTo (PING, 5, 0, dest);
-
-  m_numPings = m_numPings % MAX_PINGS;
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (type) << to << seq);
+  ScdtHeader header;
+  header.SetType (type);
+  header.SetSeq (seq);
+  header.SetGroupId (m_groupId);
+  QueueControl (header, payload, to);
+}
 
-  return curNumPings;
+void
+ScdtServer::SendControl (uint8_t type, const Address & to, uint32_t seq)
+{
+  SendControl (Create<Packet> (), type, to, seq);
 }
 
 void
-ScdtServer::InterpretPacket (Ptr<Socket> socket, Address & from, uint8_t* contents, uint32_t size) 
+ScdtServer::QueueControl (ScdtHeader header, Ptr<Packet> payload, const Address & to)
 {
-  // Handle attach request
-  if (memcmp (contents, ATTACH, 7) == 0) 
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (header.GetType ()) << to);
+  NS_ASSERT (payload->GetSize () <= 0xffff);
+  header.SetLength (payload->GetSize ());
+  payload->AddHeader (header);
+  m_controlMessages++;
+  if (!m_controlAggregation || !InetSocketAddress::IsMatchingType (to))
     {
-      ScdtServer::SendPing (socket, from);
+      SendDatagram (payload, to);
+      return;
     }
-  // Handle ping request by sending a ping response
-  else if (memcmp (contents, PING, 5) == 0) 
+  Ptr<Packet> &outbox = m_outbox[ScdtEndpoint (to)];
+  if (outbox != 0 && outbox->GetSize () + payload->GetSize () > 1400)
     {
-      //NS_LOG_INFO ("Returning ping...");
-      socket->SendTo (PING_RESP, 13, 0, from);
+      // Keep the datagrams within a common MTU
+      SendDatagram (outbox, to);
+      outbox = 0;
     }
-  // Handle response to initiated ping
-  else if (memcmp (contents, PING_RESP, 13) == 0) 
+  if (outbox == 0)
     {
-      NS_LOG_LOGIC ("Received ping response");
-          
-      for (uint32_t i = 0; i < m_numPings; i++) 
-        {
-          if (m_pings[i] == from) 
-            {
-              // TODO: Convert to a priority queue?
-              m_pingTime[i] = Simulator::Now ().GetSeconds () - m_pingStartTime[i];
-              if (m_possibleParentsSet.count (i) != 0) 
-                {
-                  m_possibleParentsCntr--;
-                  m_possibleParentsSet.erase (i);
-                }
-              else 
-                {
-                  ScdtServer::UpdateChildren (m_pings[i], m_pingTime[i]);
-                  break;
-                }
-              if (m_possibleParentsCntr == 0) 
-                {
-                  int32_t curBestIndex = -1;
-                  std::stack <uint32_t> discardedParents;
-                  while (m_possibleParentsStk.size() != 0) 
-                    {
-                      uint32_t curIndex = m_possibleParentsStk.top();
-                      m_possibleParentsStk.pop();
-                      //NS_LOG_INFO ("PING TIME: " << m_pingTime[curIndex]);
-
-                      if (m_pingTime[curIndex] < m_nextPotentialParentPing) 
-                        {
-                          if (curBestIndex != -1) 
-                            {
-                              discardedParents.push(curBestIndex);
-                            }
-                          curBestIndex = curIndex;
-                          memcpy (&m_nextPotentialParent, &m_pings[curIndex], sizeof (Address));
-                          m_nextPotentialParentPing = m_pingTime[curIndex];
-                        } 
-                    }
-                  while (discardedParents.size () != 0) 
-                    {
-                      m_possibleParentsStk.push (discardedParents.top());
-                      discardedParents.pop();
-                    }
-                  m_nextPotentialParentPing = 9999999;
-                  socket->SendTo (ATTACH, 7, 0, m_nextPotentialParent); 
-                }
-              break;
-            }
-        }
-    } else if (memcmp (contents, REATTACH, 8) == 0) {
-        m_parentIp = m_rootIp; 
-        //NS_LOG_INFO("HAHAHAHAHAH");
-        //m_parentSocket->Close();
-        m_socket->SendTo (ATTACH, 7, 0, InetSocketAddress (Ipv4Address::ConvertFrom (m_rootIp), m_rootPort));
+      outbox = payload;
     }
-  // Handle addresses of additional attach points to try
-  else if (memcmp (contents, TRY_RESP, 3) == 0)
+  else
     {
-      //NS_LOG_INFO(this << "\nhandling Try");
-      uint32_t cntr = 4;
-      m_possibleParentsCntr = contents[3];
-      while (cntr < size) 
-        {
-          uint32_t childSize = contents[cntr+1];
-          Address curAddr;
-          curAddr.CopyAllFrom (&contents[cntr], childSize + 2);
-          cntr += childSize + 2;
-          //InetSocketAddress curChild = InetSocketAddress::ConvertFrom (curAddr);
-          //NS_LOG_INFO ("possible parent -- " << curChild.GetIpv4 ());
-
-          uint32_t index = ScdtServer::SendPing (m_socket, curAddr);
-          m_possibleParentsStk.push (index); 
-          m_possibleParentsSet.insert (index);
-        }
+      outbox->AddAtEnd (payload);
     }
-  // Set our parent now that we've successfully attached
-  else if (memcmp (contents, ATTACH_SUC, 14) == 0) 
+  if (!m_flushEvent.IsRunning ())
     {
-      memcpy(&m_parentIp, &from, sizeof (Address));
+      // After whatever else the current event has to say
+      m_flushEvent = Simulator::ScheduleNow (&ScdtServer::FlushControl, this);
     }
-  else 
+}
+
+void
+ScdtServer::FlushControl (void)
+{
+  NS_LOG_FUNCTION (this << m_outbox.size ());
+  Simulator::Cancel (m_flushEvent);
+  std::map<ScdtEndpoint, Ptr<Packet> > outbox;
+  outbox.swap (m_outbox);
+  for (std::map<ScdtEndpoint, Ptr<Packet> >::iterator it = outbox.begin (); it != outbox.end (); ++it)
     {
-      // Forward packet to all children
-      //NS_LOG_INFO ("Received packet to forward with contents: " << contents);
-      for (int i = 0; i < m_numChildren; i++) 
+      if (it->second != 0)
         {
-          m_socket->SendTo(contents, size, 0, m_children[i]);
+          SendDatagram (it->second, it->first);
         }
     }
 }
 
 void
-ScdtServer::HandleRead (Ptr<Socket> socket)
+ScdtServer::SendDatagram (Ptr<Packet> packet, const Address & to)
+{
+  m_txTrace (packet);
+  m_socket->SendTo (packet, 0, to);
+  m_controlTx++;
+}
+
+uint32_t
+ScdtServer::SendPing (Address & dest, ScdtProbeTable::ProbeKind kind) 
 {
-  NS_LOG_FUNCTION (this << socket);
-  Ptr<Packet> packet;
-  Address from;
-  while ((packet = socket->RecvFrom (from)))
+  uint32_t seq = m_nextProbeSeq++;
+  Time now = Simulator::Now ();
+
+  m_probes.Expire (now - GetBackoff (m_probeRetries));
+  m_probes.Insert (InetSocketAddress::ConvertFrom (dest), seq, now, kind);
+  if (kind == ScdtProbeTable::PARENT_PROBE && m_bandwidthProbe)
     {
-      uint8_t contents[packet->GetSize ()];
-      packet->CopyData (contents, packet->GetSize ());
-      
-      //NS_LOG_INFO ("Received packet on node " << GetNode ()->GetId () << " with contents " << contents);
-    
-      ScdtServer::InterpretPacket (socket, from, contents, packet->GetSize ()); 
-   
-      /*if (InetSocketAddress::IsMatchingType (from))
-        {
-          //NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client received " << packet->GetSize () << " bytes from " <<
-                       InetSocketAddress::ConvertFrom (from).GetIpv4 () << " port " <<
-                       InetSocketAddress::ConvertFrom (from).GetPort ());
-        }
-      else if (Inet6SocketAddress::IsMatchingType (from))
-        {
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client received " << packet->GetSize () << " bytes from " <<
-                       Inet6SocketAddress::ConvertFrom (from).GetIpv6 () << " port " <<
-                       Inet6SocketAddress::ConvertFrom (from).GetPort ());
-        }*/
-      //NS_LOG_INFO ("\n\n");
+      ScdtProbeTrainHeader train;
+      train.SetLength (m_trainLength);
+      train.SetPacketSize (m_trainPacketSize);
+      Ptr<Packet> p = Create<Packet> ();
+      p->AddHeader (train);
+      SendControl (p, ScdtHeader::PING_TRAIN, dest, seq);
+    }
+  else
+    {
+      SendControl (ScdtHeader::PING, dest, seq);
     }
+  m_probeSentTrace (dest, seq);
+
+  return seq;
 }
 
 void
-ScdtServer::UpdateChildren (Address & addr, double pingTime) 
+ScdtServer::InterpretPacket (Ptr<Socket> socket, Address & from, Ptr<Packet> packet) 
 {
-  // Add child because MAX_FANOUT not used yet
-  if (m_numChildren < MAX_FANOUT) 
+  ScdtHeader header;
+  if (packet->GetSize () < header.GetSerializedSize ())
     {
-      memcpy (&m_children[m_numChildren], &addr, sizeof (Address));
-      //Address a (addr);
-      //m_children[m_numChildren] = a;
-      m_shortestPing[m_numChildren] = pingTime;
-      m_numChildren++;
-      ScdtServer::SerializeChildren ();
-      m_socket->SendTo (ATTACH_SUC, 14, 0, addr);
+      NS_LOG_LOGIC ("Dropping runt control datagram of " << packet->GetSize () << " bytes");
       return;
     }
-
-  // Update shortest ping if new ping is for existing child
-  for (int i = 0; i < m_numChildren; i++) 
+  // One or more messages, each header followed by its payload
+  while (packet->GetSize () >= header.GetSerializedSize ())
     {
-      if (memcmp (&addr, &m_children[i], sizeof (Address)) == 0) 
+      packet->RemoveHeader (header);
+      if (header.GetLength () > packet->GetSize ())
         {
-          if (pingTime < m_shortestPing[i]) 
-            {
-              m_shortestPing[i] = pingTime;
-            }
+          NS_LOG_LOGIC ("Dropping truncated control message of " << packet->GetSize ()
+                        << " bytes, " << header.GetLength () << " announced");
           return;
         }
-    }
+      Ptr<Packet> payload = packet->CreateFragment (0, header.GetLength ());
+      packet->RemoveAtStart (header.GetLength ());
 
-  // Determine if other node has shorter ping and make it child
-  double maxPingTime = 999999999;
-  uint8_t maxPingIndex = 0;
-  for (int i = 0; i < m_numChildren; i++) 
-    {
-      if (m_shortestPing[i] < maxPingTime) 
+      if (header.GetType () >= ScdtHeader::MESSAGE_TYPE_COUNT)
         {
-          maxPingTime = m_shortestPing[i];
-          maxPingIndex = i;
+          NS_LOG_LOGIC ("Dropping control message of unknown type " << static_cast<uint32_t> (header.GetType ()));
+          continue;
         }
+      if (header.GetGroupId () != m_groupId)
+        {
+          NS_LOG_LOGIC ("Dropping control message for group " << header.GetGroupId ());
+          continue;
+        }
+      (this->*m_controlHandlers[header.GetType ()])(socket, from, header, payload);
     }
-  if (pingTime < maxPingTime) 
-    {
-      Address oldAddr;
-      memcpy (&oldAddr, &m_children[maxPingIndex], sizeof(Address));
-      memcpy (&m_children[maxPingIndex], &addr, sizeof (Address));
-      m_shortestPing[maxPingIndex] = pingTime;
-      m_socket->SendTo (REATTACH, 8, 0, oldAddr);
+}
 
-      m_socket->SendTo (ATTACH_SUC, 14, 0, addr);
-      ScdtServer::SerializeChildren ();
+// Handle attach request
+void
+ScdtServer::HandleAttach (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  if (!m_isRoot && !m_attached)
+    {
+      // We could only take the joiner into a subtree cut off from the root
+      NS_LOG_LOGIC ("Not attached, ignoring ATTACH from " << from);
+      return;
     }
-  else 
+  Time rtt;
+  if (m_mux->LookupRtt (from, rtt))
     {
-      m_socket->SendTo (m_serializedChildren, m_serializedChildrenSize, 0, addr);
+      // Another group of this node measured the joiner recently
+      ScdtCoordinateHeader coordinate;
+      if (packet->GetSize () >= coordinate.GetSerializedSize ())
+        {
+          packet->RemoveHeader (coordinate);
+        }
+      ScdtMemberHeader member;
+      if (packet->GetSize () >= member.GetSerializedSize ())
+        {
+          packet->RemoveHeader (member);
+        }
+      ScdtServer::UpdateChildren (from, rtt, coordinate.GetCoordinate (), member);
+      return;
     }
+  // The joiner's coordinate and load come back with its PING_RESP
+  ScdtServer::SendPing (from, ScdtProbeTable::CHILD_PROBE);
+}
+
+// Handle ping request by sending a ping response
+void
+ScdtServer::HandlePing (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  ScdtHeader response;
+  response.SetType (ScdtHeader::PING_RESP);
+  response.SetSeq (header.GetSeq ());
+  response.SetTs (header.GetTs ());
+  response.SetGroupId (m_groupId);
+  ScdtCoordinateHeader coordinate;
+  coordinate.SetCoordinate (m_mux->GetCoordinate ());
+  // Lets an optimizing node predict its delay below us
+  ScdtStreamDelayHeader delay;
+  delay.SetDelay (GetStreamDelay ());
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (GetMemberHeader ());
+  p->AddHeader (delay);
+  p->AddHeader (coordinate);
+  QueueControl (response, p, from);
 }
 
+// Handle ping request that also asks for a bandwidth probe train
 void
-ScdtServer::SerializeChildren () 
+ScdtServer::HandlePingTrain (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
 {
-  m_serializedChildrenSize = 4;
-  for (int i = 0; i < m_numChildren; i++) 
+  HandlePing (socket, from, header, packet);
+
+  ScdtProbeTrainHeader train;
+  if (packet->GetSize () < train.GetSerializedSize ())
     {
-      m_serializedChildrenSize += m_children[i].GetSerializedSize();
+      return;
     }
-  delete [] m_serializedChildren;
-  m_serializedChildren = new uint8_t[m_serializedChildrenSize];
-  m_serializedChildren[0] = 'T';
-  m_serializedChildren[1] = 'R';
-  m_serializedChildren[2] = 'Y';
-  m_serializedChildren[3] = m_numChildren;
-  
-  uint32_t curLoc = 4;
-  for (int i = 0; i < m_numChildren; i++)
+  packet->RemoveHeader (train);
+  // Bound what a single request can make us send
+  uint8_t length = std::min<uint8_t> (train.GetLength (), 16);
+  uint32_t size = std::min<uint32_t> (train.GetPacketSize (), 1400);
+  uint32_t padding = size > header.GetSerializedSize () ? size - header.GetSerializedSize () : 0;
+  ScdtHeader trainHeader;
+  trainHeader.SetType (ScdtHeader::TRAIN);
+  trainHeader.SetSeq (header.GetSeq ());
+  trainHeader.SetGroupId (m_groupId);
+  trainHeader.SetLength (padding);
+  // Back to back, one datagram each, past the outbox: the access link
+  // spaces them out at its rate
+  for (uint8_t k = 0; k < length; k++)
     {
-      uint32_t curSize = m_children[i].GetSerializedSize ();
-      uint8_t curBuf[curSize];
-
-      m_children[i].CopyAllTo (curBuf, curSize);
-
-      memcpy(&m_serializedChildren[curLoc], curBuf, curSize);
-      curLoc += curSize;
+      Ptr<Packet> p = Create<Packet> (padding);
+      p->AddHeader (trainHeader);
+      m_controlMessages++;
+      SendDatagram (p, from);
     }
 }
 
+// Handle a packet of a bandwidth probe train we asked a candidate for
 void
-ScdtServer::SendTcp(Ptr<Socket> socket, Ptr<Packet> p) 
+ScdtServer::HandleTrain (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
 {
-  
-      socket->Send (p);
-  //NS_LOG_INFO("Bytes sent: " << actual);
+  Time now = Simulator::Now ();
+  for (std::vector<PossibleParent>::iterator it = m_possibleParents.begin ();
+       it != m_possibleParents.end (); ++it)
+    {
+      if (it->seq != header.GetSeq () || it->addr != from)
+        {
+          continue;
+        }
+      if (it->trainRx == 0)
+        {
+          it->firstTrainRx = now;
+        }
+      it->trainRx++;
+      if (it->trainRx >= 2 && now > it->firstTrainRx)
+        {
+          // Dispersion of the train: every packet after the first took
+          // its transmission time on the bottleneck
+          uint64_t bits = static_cast<uint64_t> (it->trainRx - 1)
+            * (packet->GetSize () + header.GetSerializedSize ()) * 8;
+          it->bandwidth = DataRate (static_cast<uint64_t> (bits / (now - it->firstTrainRx).GetSeconds ()));
+        }
+      CheckCandidate (*it);
+      return;
+    }
+  NS_LOG_LOGIC ("Ignoring TRAIN packet " << header.GetSeq () << " from " << from);
 }
 
-void ScdtServer::ConnectionSucceeded (Ptr<Socket> socket)
+void
+ScdtServer::CheckCandidate (PossibleParent & candidate)
 {
-  NS_LOG_INFO ("Connection succeeded");
-  //ScdtServer::SendTcp(socket); 
+  if (candidate.complete || candidate.rtt == Time::Max ()
+      || (m_bandwidthProbe && candidate.trainRx < m_trainLength))
+    {
+      return;
+    }
+  candidate.complete = true;
+  m_possibleParentsCntr--;
+  if (m_possibleParentsCntr == 0)
+    {
+      Simulator::Cancel (m_probeEvent);
+      ScdtServer::SelectParent ();
+    }
 }
 
-void ScdtServer::ConnectionFailed (Ptr<Socket> socket)
+double
+ScdtServer::ScoreParent (Time rtt, DataRate bandwidth) const
 {
-    //NS_LOG_INFO("connection failed");
+  double score = rtt.GetSeconds ();
+  if (bandwidth.GetBitRate () == 0 || m_bandwidthWeight == 0)
+    {
+      // Bandwidth unknown (train lost) or ignored
+      return score;
+    }
+  double shortfall = static_cast<double> (m_streamRate.GetBitRate ()) / bandwidth.GetBitRate ();
+  return score * std::pow (std::max (1.0, shortfall), m_bandwidthWeight);
 }
 
-void ScdtServer::DataSend (Ptr<Socket> socket, uint32_t)
+void
+ScdtServer::SetParentScoreCallback (Callback<double, Time, DataRate> score)
+{
+  NS_LOG_FUNCTION (this);
+  m_parentScore = score;
+}
+
+void
+ScdtServer::SetAdmissionPolicy (Ptr<ScdtAdmissionPolicy> policy)
+{
+  NS_LOG_FUNCTION (this << policy);
+  m_admissionPolicy = policy;
+}
+
+Ptr<ScdtAdmissionPolicy>
+ScdtServer::GetAdmissionPolicy (void) const
+{
+  return m_admissionPolicy;
+}
+
+uint32_t
+ScdtServer::GetSubtreeSize (void) const
+{
+  uint32_t size = 1;
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      size += m_children[i].subtree;
+    }
+  return size;
+}
+
+ScdtMemberHeader
+ScdtServer::GetMemberHeader (void) const
+{
+  ScdtMemberHeader member;
+  member.SetFanout (m_fanout);
+  member.SetSubtreeSize (GetSubtreeSize ());
+  member.SetFreeSlots (m_children.size () < m_fanout ? m_fanout - m_children.size () : 0);
+  return member;
+}
+
+void
+ScdtServer::AddEntryPoint (Address entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  m_entryPoints.push_back (entry);
+}
+
+void
+ScdtServer::SetPresetParent (const std::vector<Address> & ancestors, uint16_t depth, Time rootLatency)
+{
+  NS_LOG_FUNCTION (this << depth << rootLatency);
+  NS_ASSERT_MSG (!ancestors.empty (), "A preset node needs a parent");
+  m_presetAncestors = ancestors;
+  m_depth = depth;
+  m_rootLatency = rootLatency;
+}
+
+void
+ScdtServer::AddPresetChild (const Address & child, Time rtt, uint32_t subtree)
+{
+  NS_LOG_FUNCTION (this << child << rtt << subtree);
+  PresetChild preset;
+  preset.addr = child;
+  preset.rtt = rtt;
+  preset.subtree = subtree;
+  m_presetChildren.push_back (preset);
+}
+
+void
+ScdtServer::StartPreset (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  if (!m_isRoot && !m_presetAncestors.empty ())
+    {
+      m_parentIp = m_presetAncestors.front ();
+      m_attached = true;
+      m_parentHeard = now;
+      m_joinStart = now;
+      m_lastRelocation = now;
+      m_ancestors.assign (m_presetAncestors.begin (),
+                          m_presetAncestors.begin () + std::min<size_t> (m_presetAncestors.size (), m_maxEntryPoints));
+      m_joinLatency = Seconds (0);
+      NS_LOG_LOGIC ("Preset below " << m_parentIp << " at depth " << m_depth);
+      m_parentChangeTrace (Address (), m_parentIp);
+      m_attachTrace (m_parentIp, m_joinLatency);
+    }
+  NS_ABORT_MSG_IF (m_presetChildren.size () > m_fanout,
+                   "Node " << GetNode ()->GetId () << " starts with " << m_presetChildren.size ()
+                           << " children, more than its fan-out of " << static_cast<uint32_t> (m_fanout));
+  for (uint32_t k = 0; k < m_presetChildren.size (); k++)
+    {
+      m_children.push_back (Child ());
+      Child &child = m_children.back ();
+      child.addr = ScdtEndpoint (m_presetChildren[k].addr);
+      child.rtt = m_presetChildren[k].rtt;
+      child.heard = now;
+      // Fan-out and free slots come with its first HEARTBEAT
+      child.subtree = m_presetChildren[k].subtree;
+      m_childAddedTrace (m_presetChildren[k].addr);
+      ConnectChild (m_children.size () - 1);
+    }
+  if (!m_presetChildren.empty ())
+    {
+      InvalidateTryList ();
+    }
+}
+
+int64_t
+ScdtServer::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_entryRng->SetStream (stream);
+  return 1;
+}
+
+// Handle response to initiated ping
+void
+ScdtServer::HandlePingResponse (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  NS_LOG_LOGIC ("Received ping response");
+
+  ScdtProbeTable::Probe probe;
+  if (!m_probes.Remove (InetSocketAddress::ConvertFrom (from), header.GetSeq (), probe))
+    {
+      NS_LOG_LOGIC ("Ignoring stale or duplicate ping response " << header.GetSeq ());
+      return;
+    }
+  Time rtt = Simulator::Now () - probe.sent;
+  m_probeAnsweredTrace (from, header.GetSeq (), rtt);
+  m_mux->RecordRtt (from, rtt);
+  ScdtCoordinateHeader coordinate;
+  if (packet->GetSize () >= coordinate.GetSerializedSize ())
+    {
+      packet->RemoveHeader (coordinate);
+      m_mux->UpdateCoordinate (coordinate.GetCoordinate (), rtt);
+    }
+  ScdtStreamDelayHeader delay;
+  if (packet->GetSize () >= delay.GetSerializedSize ())
+    {
+      packet->RemoveHeader (delay);
+    }
+  ScdtMemberHeader member;
+  if (packet->GetSize () >= member.GetSerializedSize ())
+    {
+      packet->RemoveHeader (member);
+    }
+
+  if (probe.kind == ScdtProbeTable::CHILD_PROBE)
+    {
+      ScdtServer::UpdateChildren (from, rtt, coordinate.GetCoordinate (), member);
+      return;
+    }
+  if (probe.kind == ScdtProbeTable::OPTIMIZE_PROBE)
+    {
+      bool complete = true;
+      for (std::vector<OptimizeCandidate>::iterator it = m_optimizeCandidates.begin ();
+           it != m_optimizeCandidates.end (); ++it)
+        {
+          if (it->seq == header.GetSeq () && it->addr == from)
+            {
+              it->rtt = rtt;
+              it->delay = delay.GetDelay ();
+            }
+          complete = complete && it->rtt != Time::Max ();
+        }
+      if (complete && !m_optimizeCandidates.empty ())
+        {
+          EndOptimization ();
+        }
+      return;
+    }
+
+  for (std::vector<PossibleParent>::iterator it = m_possibleParents.begin ();
+       it != m_possibleParents.end (); ++it)
+    {
+      if (it->seq == header.GetSeq ())
+        {
+          it->rtt = rtt;
+          CheckCandidate (*it);
+          break;
+        }
+    }
+}
+
+void
+ScdtServer::SelectParent (void)
+{
+  std::vector<std::pair<double, uint32_t> > scores;
+  std::vector<std::pair<double, uint32_t> > outOfBounds;
+  for (uint32_t i = 0; i < m_possibleParents.size (); i++)
+    {
+      const PossibleParent &candidate = m_possibleParents[i];
+      if (candidate.rtt == Time::Max ())
+        {
+          continue;
+        }
+      double score = m_bandwidthProbe ? m_parentScore (candidate.rtt, candidate.bandwidth) : candidate.rtt.GetSeconds ();
+      NS_LOG_LOGIC ("Candidate " << candidate.addr << " rtt " << candidate.rtt.GetSeconds () << "s bandwidth "
+                    << candidate.bandwidth.GetBitRate () << "bps score " << score);
+      if (IsFeasible (candidate.depth + 1, candidate.latency + NanoSeconds (candidate.rtt.GetNanoSeconds () / 2)))
+        {
+          scores.push_back (std::make_pair (score, i));
+        }
+      else
+        {
+          outOfBounds.push_back (std::make_pair (score, i));
+        }
+    }
+  std::stable_sort (scores.begin (), scores.end ());
+  if (!m_relocating)
+    {
+      // A position out of the bounds beats no position at all; the node
+      // relocates later
+      std::stable_sort (outOfBounds.begin (), outOfBounds.end ());
+      scores.insert (scores.end (), outOfBounds.begin (), outOfBounds.end ());
+    }
+  if (scores.empty ())
+    {
+      m_possibleParents.clear ();
+      m_possibleParentsCntr = 0;
+      if (m_relocating)
+        {
+          AbandonRelocation ("no candidate within the bounds");
+        }
+      return;
+    }
+  m_nextPotentialParent = m_possibleParents[scores[0].second].addr;
+  // The runners-up are where we go if the parent is lost
+  m_backupParents.clear ();
+  for (uint32_t k = 1; k < scores.size () && m_backupParents.size () < m_maxBackupParents; k++)
+    {
+      m_backupParents.push_back (m_possibleParents[scores[k].second].addr);
+    }
+  m_possibleParents.clear ();
+  m_possibleParentsCntr = 0;
+  SendAttach (m_nextPotentialParent);
+}
+
+void
+ScdtServer::StartJoin (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_joinStart = Simulator::Now ();
+  m_relocating = false;
+  Simulator::Cancel (m_probeEvent);
+  m_possibleParents.clear ();
+  m_possibleParentsCntr = 0;
+  m_repairTargets.clear ();
+  // Ancestors first: they are close to where we were and cannot be in
+  // the subtree we may still carry.  An entry point can: it is still
+  // attached, below us, and would take us into a cycle cut off from the
+  // root, so a node with children falls back to the root instead.
+  const std::vector<Address> &entries = m_ancestors.empty () && m_children.empty () ? m_entryPoints : m_ancestors;
+  if (entries.empty ())
+    {
+      SendAttach (InetSocketAddress (Ipv4Address::ConvertFrom (m_rootIp), m_rootPort));
+      return;
+    }
+  SendAttach (entries[m_entryRng->GetInteger (0, entries.size () - 1)]);
+}
+
+void
+ScdtServer::SendAttachSuccess (uint8_t i)
+{
+  ScdtTryHeader ancestors;
+  for (std::vector<Address>::const_iterator it = m_ancestors.begin (); it != m_ancestors.end (); ++it)
+    {
+      ancestors.AddCandidate (InetSocketAddress::ConvertFrom (*it));
+    }
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (ancestors);
+  p->AddHeader (GetChildPosition (i));
+  SendControl (p, ScdtHeader::ATTACH_SUC, m_children[i].addr);
+}
+
+ScdtPositionHeader
+ScdtServer::GetChildPosition (uint8_t i) const
+{
+  ScdtPositionHeader position;
+  position.SetDepth (std::min<uint32_t> (m_depth + 1, 0xffff));
+  position.SetLatency (m_rootLatency + NanoSeconds (m_children[i].rtt.GetNanoSeconds () / 2));
+  return position;
+}
+
+void
+ScdtServer::SetPosition (const ScdtPositionHeader & position)
+{
+  if (position.GetDepth () == m_depth && position.GetLatency () == m_rootLatency)
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Now at depth " << position.GetDepth () << ", root latency "
+                << position.GetLatency ().GetSeconds () << "s");
+  m_depth = position.GetDepth ();
+  m_rootLatency = position.GetLatency ();
+  m_positionChanged = true;
+  // The TRY list carries the positions of our children
+  InvalidateTryList ();
+}
+
+bool
+ScdtServer::IsFeasible (uint16_t depth, Time latency) const
+{
+  return (m_maxDepth == 0 || depth <= m_maxDepth)
+    && (m_maxLatency.IsZero () || latency <= m_maxLatency);
+}
+
+void
+ScdtServer::SendAttach (const Address & target)
+{
+  NS_LOG_FUNCTION (this << target);
+  if (target != m_attachTarget)
+    {
+      m_attachAttempts = 0;
+    }
+  m_attachTarget = target;
+  ScdtCoordinateHeader coordinate;
+  coordinate.SetCoordinate (m_mux->GetCoordinate ());
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (GetMemberHeader ());
+  p->AddHeader (coordinate);
+  SendControl (p, ScdtHeader::ATTACH, target);
+  Simulator::Cancel (m_attachEvent);
+  m_attachEvent = Simulator::Schedule (GetBackoff (m_attachAttempts), &ScdtServer::AttachTimeout, this);
+}
+
+void
+ScdtServer::AttachTimeout (void)
+{
+  NS_LOG_FUNCTION (this << m_attachTarget << m_attachAttempts);
+  Address root = InetSocketAddress (Ipv4Address::ConvertFrom (m_rootIp), m_rootPort);
+  if (m_attached)
+    {
+      // An optimization switch or a relocation went unanswered: stay
+      // where we are
+      NS_LOG_LOGIC ("No answer from " << m_attachTarget << ", staying below " << m_parentIp);
+      m_relocating = false;
+      return;
+    }
+  if (!m_repairTargets.empty ())
+    {
+      // Repair targets get one try each: the next may be alive
+      Address next = m_repairTargets.front ();
+      m_repairTargets.pop_front ();
+      SendAttach (next);
+    }
+  else if (m_attachAttempts < m_probeRetries)
+    {
+      m_attachAttempts++;
+      SendAttach (m_attachTarget);
+    }
+  else if (m_attachTarget != root)
+    {
+      NS_LOG_LOGIC ("Giving up on " << m_attachTarget << ", joining from the root again");
+      SendAttach (root);
+    }
+  else
+    {
+      // Keep trying the root at the largest backoff
+      SendAttach (root);
+    }
+}
+
+void
+ScdtServer::ProbeTimeout (void)
+{
+  NS_LOG_FUNCTION (this << m_probeAttempts);
+  for (std::vector<PossibleParent>::const_iterator it = m_possibleParents.begin ();
+       it != m_possibleParents.end (); ++it)
+    {
+      if (it->rtt != Time::Max ())
+        {
+          // At least one candidate answered: go with the best of those
+          SelectParent ();
+          return;
+        }
+    }
+  if (m_probeAttempts >= m_probeRetries && m_relocating)
+    {
+      m_possibleParents.clear ();
+      m_possibleParentsCntr = 0;
+      AbandonRelocation ("no candidate answered");
+      return;
+    }
+  if (m_probeAttempts >= m_probeRetries)
+    {
+      NS_LOG_LOGIC ("No candidate answered, joining from the root again");
+      m_possibleParents.clear ();
+      m_possibleParentsCntr = 0;
+      SendAttach (InetSocketAddress (Ipv4Address::ConvertFrom (m_rootIp), m_rootPort));
+      return;
+    }
+  m_probeAttempts++;
+  for (std::vector<PossibleParent>::iterator it = m_possibleParents.begin ();
+       it != m_possibleParents.end (); ++it)
+    {
+      it->trainRx = 0;
+      it->bandwidth = DataRate (0);
+      it->seq = SendPing (it->addr, ScdtProbeTable::PARENT_PROBE);
+    }
+  m_probeEvent = Simulator::Schedule (GetBackoff (m_probeAttempts), &ScdtServer::ProbeTimeout, this);
+}
+
+Time
+ScdtServer::GetBackoff (uint32_t attempt) const
+{
+  return m_probeTimeout * (static_cast<int64_t> (1) << std::min<uint32_t> (attempt, 16));
+}
+
+Time
+ScdtServer::GetJoinLatency (void) const
+{
+  return m_joinLatency;
+}
+
+void
+ScdtServer::HandleReattach (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  if (!m_attached || from != m_parentIp)
+    {
+      NS_LOG_LOGIC ("Ignoring REATTACH from " << from << ", not our parent");
+      return;
+    }
+  // The evicting parent is full: look around it
+  Repair (from);
+}
+
+void
+ScdtServer::Repair (const Address & lost)
+{
+  NS_LOG_FUNCTION (this << lost);
+  if (m_attached)
+    {
+      m_parentChangeTrace (m_parentIp, Address ());
+    }
+  m_parentIp = m_rootIp; 
+  m_attached = false;
+  m_relocating = false;
+  if (m_parentDataSocket != 0)
+    {
+      m_parentDataSocket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_parentDataSocket->Close ();
+      m_parentDataSocket = 0;
+    }
+  m_rxBuffer = Create<Packet> ();
+  // Measured through the lost parent; unknown until chunks flow again
+  m_streamDelay = Time::Max ();
+  m_ancestors.erase (std::remove (m_ancestors.begin (), m_ancestors.end (), lost), m_ancestors.end ());
+  m_backupParents.erase (std::remove (m_backupParents.begin (), m_backupParents.end (), lost), m_backupParents.end ());
+
+  // Backups are siblings of the lost parent, ancestors are above it
+  std::deque<Address> targets (m_backupParents.begin (), m_backupParents.end ());
+  targets.insert (targets.end (), m_ancestors.begin (), m_ancestors.end ());
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      // Attaching below our own subtree would cut it off for good
+      targets.erase (std::remove (targets.begin (), targets.end (), Address (m_children[i].addr)), targets.end ());
+    }
+  if (targets.empty ())
+    {
+      StartJoin ();
+      return;
+    }
+  m_joinStart = Simulator::Now ();
+  Simulator::Cancel (m_probeEvent);
+  m_possibleParents.clear ();
+  m_possibleParentsCntr = 0;
+  Address first = targets.front ();
+  targets.pop_front ();
+  m_repairTargets = targets;
+  SendAttach (first);
+}
+
+void
+ScdtServer::Heartbeat (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  Time deadline = m_heartbeatInterval * static_cast<int64_t> (m_heartbeatMisses);
+  for (int i = static_cast<int> (m_children.size ()) - 1; i >= 0; i--)
+    {
+      if (now - m_children[i].heard > deadline)
+        {
+          NS_LOG_LOGIC ("Child " << m_children[i].addr << " lost");
+          RemoveChild (i);
+          continue;
+        }
+      bool fed = m_children[i].fed;
+      m_children[i].fed = false;
+      if (m_controlAggregation && fed && !m_positionChanged)
+        {
+          // The chunks told the child we are alive, and its position holds
+          continue;
+        }
+      // Keeps the child's position current when we move
+      Ptr<Packet> p = Create<Packet> ();
+      p->AddHeader (GetChildPosition (i));
+      SendControl (p, ScdtHeader::HEARTBEAT, m_children[i].addr);
+    }
+  m_positionChanged = false;
+  if (m_attached)
+    {
+      if (now - m_parentHeard > deadline)
+        {
+          NS_LOG_LOGIC ("Parent " << m_parentIp << " lost");
+          Repair (m_parentIp);
+        }
+      else
+        {
+          // Keeps the parent's view of our subtree current
+          Ptr<Packet> p = Create<Packet> ();
+          p->AddHeader (GetMemberHeader ());
+          SendControl (p, ScdtHeader::HEARTBEAT, m_parentIp);
+          if (!IsFeasible (m_depth, m_rootLatency) && !m_relocating && !m_attachEvent.IsRunning ()
+              && m_optimizeCandidates.empty () && now >= m_lastRelocation + m_boundRetryInterval)
+            {
+              Relocate ();
+            }
+        }
+    }
+  m_heartbeatEvent = Simulator::Schedule (m_heartbeatInterval, &ScdtServer::Heartbeat, this);
+}
+
+void
+ScdtServer::HandleHeartbeat (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  if (m_attached && from == m_parentIp)
+    {
+      m_parentHeard = Simulator::Now ();
+      ScdtPositionHeader position;
+      if (packet->GetSize () >= position.GetSerializedSize ())
+        {
+          packet->RemoveHeader (position);
+          SetPosition (position);
+        }
+      return;
+    }
+  int32_t i = FindChild (from);
+  if (i >= 0)
+    {
+      m_children[i].heard = Simulator::Now ();
+      ScdtMemberHeader member;
+      if (packet->GetSize () >= member.GetSerializedSize ())
+        {
+          packet->RemoveHeader (member);
+          Child &child = m_children[i];
+          if (child.fanout != member.GetFanout () || child.subtree != member.GetSubtreeSize ()
+              || child.freeSlots != member.GetFreeSlots ())
+            {
+              child.fanout = member.GetFanout ();
+              child.subtree = member.GetSubtreeSize ();
+              child.freeSlots = member.GetFreeSlots ();
+              InvalidateTryList ();
+            }
+        }
+      return;
+    }
+  NS_LOG_LOGIC ("Ignoring HEARTBEAT from " << from);
+}
+
+void
+ScdtServer::HandleLeave (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
 {
+  int32_t i = FindChild (from);
+  if (i >= 0)
+    {
+      NS_LOG_LOGIC ("Child " << from << " moved to another parent");
+      RemoveChild (i);
+      return;
+    }
+  NS_LOG_LOGIC ("Ignoring LEAVE from " << from);
+}
+
+void
+ScdtServer::Optimize (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Jittered so that the rounds of nodes started together spread out
+  m_optimizeEvent = Simulator::Schedule (Seconds (m_optimizeInterval.GetSeconds () * m_entryRng->GetValue (0.5, 1.5)),
+                                         &ScdtServer::Optimize, this);
+  if (!m_attached || m_attachEvent.IsRunning () || m_streamDelay == Time::Max ()
+      || !m_optimizeCandidates.empty () || m_relocating)
+    {
+      // Joining, already moving or no stream to measure against
+      return;
+    }
+
+  // Nodes around our parent: its ancestors and its siblings
+  std::vector<Address> pool;
+  for (uint32_t k = 1; k < m_ancestors.size (); k++)
+    {
+      pool.push_back (m_ancestors[k]);
+    }
+  pool.insert (pool.end (), m_backupParents.begin (), m_backupParents.end ());
+  std::sort (pool.begin (), pool.end ());
+  pool.erase (std::unique (pool.begin (), pool.end ()), pool.end ());
+  pool.erase (std::remove (pool.begin (), pool.end (), m_parentIp), pool.end ());
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      pool.erase (std::remove (pool.begin (), pool.end (), Address (m_children[i].addr)), pool.end ());
+    }
+
+  // A random few of them per round, so every one gets its turn
+  for (uint32_t k = 0; k < pool.size () && k < m_optimizeProbes; k++)
+    {
+      std::swap (pool[k], pool[m_entryRng->GetInteger (k, pool.size () - 1)]);
+      OptimizeCandidate candidate;
+      candidate.addr = pool[k];
+      candidate.rtt = Time::Max ();
+      candidate.delay = Time::Max ();
+      candidate.seq = SendPing (candidate.addr, ScdtProbeTable::OPTIMIZE_PROBE);
+      m_optimizeCandidates.push_back (candidate);
+    }
+  if (!m_optimizeCandidates.empty ())
+    {
+      m_optimizeDeadline = Simulator::Schedule (m_probeTimeout, &ScdtServer::EndOptimization, this);
+    }
+}
 
-    
+void
+ScdtServer::EndOptimization (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_optimizeDeadline);
+  std::vector<OptimizeCandidate> candidates;
+  candidates.swap (m_optimizeCandidates);
+  if (!m_attached || m_attachEvent.IsRunning () || m_streamDelay == Time::Max () || m_relocating)
+    {
+      // Lost our parent or started relocating during the round
+      return;
+    }
+
+  // Chunks would reach us one way trip after reaching the candidate.  A
+  // node of our own subtree gets them after us, so it never qualifies
+  Address best;
+  Time bestDelay = Time::Max ();
+  for (std::vector<OptimizeCandidate>::const_iterator it = candidates.begin ();
+       it != candidates.end (); ++it)
+    {
+      if (it->rtt == Time::Max () || it->delay == Time::Max ())
+        {
+          continue;
+        }
+      Time predicted = it->delay + NanoSeconds (it->rtt.GetNanoSeconds () / 2);
+      NS_LOG_LOGIC ("Candidate " << it->addr << " predicted stream delay " << predicted.GetSeconds () << "s");
+      if (predicted < bestDelay)
+        {
+          best = it->addr;
+          bestDelay = predicted;
+        }
+    }
+  if (bestDelay.GetSeconds () >= m_streamDelay.GetSeconds () * (1 - m_switchThreshold))
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Moving below " << best << ", stream delay " << m_streamDelay.GetSeconds ()
+                << "s predicted " << bestDelay.GetSeconds () << "s");
+  // We stay below our parent until the candidate sends ATTACH_SUC
+  SendAttach (best);
+}
+
+void
+ScdtServer::Relocate (void)
+{
+  NS_LOG_FUNCTION (this << m_depth << m_rootLatency);
+  // The highest node we know of has the most room below it for a
+  // position within the bounds, and cannot be in our subtree
+  Address root = InetSocketAddress (Ipv4Address::ConvertFrom (m_rootIp), m_rootPort);
+  Address top = m_ancestors.size () > 1 ? m_ancestors.back () : root;
+  if (top == m_parentIp)
+    {
+      // Right below the root already: there is no better place
+      return;
+    }
+  NS_LOG_LOGIC ("Depth " << m_depth << " root latency " << m_rootLatency.GetSeconds ()
+                << "s out of the bounds, relocating from " << top);
+  m_lastRelocation = Simulator::Now ();
+  m_relocating = true;
+  SendAttach (top);
+}
+
+void
+ScdtServer::AbandonRelocation (const char *reason)
+{
+  NS_LOG_LOGIC ("Relocation abandoned, " << reason << ", staying below " << m_parentIp);
+  m_relocating = false;
+}
+
+void
+ScdtServer::RemoveChild (uint8_t i)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (i) << m_children[i].addr);
+  m_childRemovedTrace (m_children[i].addr);
+  // The child leaving may be the slow one that blocked us
+  bool blocked = IsBlocked ();
+  DisconnectChild (i);
+  // Move the last child into the free slot
+  if (i != m_children.size () - 1)
+    {
+      std::swap (m_children[i], m_children.back ());
+    }
+  m_children.pop_back ();
+  InvalidateTryList ();
+  ResumeReading (blocked);
+}
+
+// Handle addresses of additional attach points to try
+void
+ScdtServer::HandleTry (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  if (from != m_attachTarget)
+    {
+      NS_LOG_LOGIC ("Ignoring TRY from " << from << ", not our attach target");
+      return;
+    }
+  // A truncated list is dropped like a lost one: the attach timeout
+  // resends the ATTACH
+  ScdtTryHeader tryHeader;
+  if (!RemoveTryHeader (packet, tryHeader))
+    {
+      NS_LOG_LOGIC ("Dropping truncated TRY from " << from);
+      return;
+    }
+  Simulator::Cancel (m_attachEvent);
+  if (m_attached && !m_relocating)
+    {
+      // The node we tried to move below is full: stay where we are
+      NS_LOG_LOGIC ("Ignoring TRY from " << from << ", staying below " << m_parentIp);
+      return;
+    }
+  Simulator::Cancel (m_probeEvent);
+
+  m_possibleParents.clear ();
+  m_possibleParentsCntr = 0;
+
+  // Pass over the candidates whose children are out of the bounds even
+  // at zero RTT, unless a joiner has nothing else
+  std::vector<bool> keep (tryHeader.GetNCandidates (), true);
+  bool anyInBounds = false;
+  for (uint8_t i = 0; i < tryHeader.GetNCandidates (); i++)
+    {
+      keep[i] = IsFeasible (tryHeader.GetCandidateDepth (i) + 1, tryHeader.GetCandidateLatency (i));
+      if (m_relocating)
+        {
+          // Neither our parent nor our own children are a way up
+          Address candidate = tryHeader.GetCandidate (i);
+          keep[i] = keep[i] && candidate != m_parentIp;
+          for (uint32_t c = 0; c < m_children.size (); c++)
+            {
+              keep[i] = keep[i] && !m_children[c].addr.IsEqual (candidate);
+            }
+        }
+      anyInBounds = anyInBounds || keep[i];
+    }
+  if (!anyInBounds && !m_relocating)
+    {
+      keep.assign (keep.size (), true);
+    }
+
+  // Probe only the head of the list, which the parent ranked best first,
+  // and of those the candidates predicted closest once our coordinate
+  // predicts anything; those with a cached RTT cost nothing and are kept
+  std::vector<bool> probe (keep);
+  uint32_t ranked = 0;
+  for (uint8_t i = 0; i < tryHeader.GetNCandidates () && m_tryProbes != 0; i++)
+    {
+      if (probe[i] && ++ranked > m_tryProbes)
+        {
+          probe[i] = false;
+        }
+    }
+  const ScdtVivaldiCoordinate &self = m_mux->GetCoordinate ();
+  if (m_coordinateProbes != 0 && !self.IsInitial ())
+    {
+      std::vector<std::pair<Time, uint8_t> > predicted;
+      for (uint8_t i = 0; i < tryHeader.GetNCandidates (); i++)
+        {
+          if (probe[i])
+            {
+              predicted.push_back (std::make_pair (self.GetDistance (tryHeader.GetCandidateCoordinate (i)), i));
+            }
+        }
+      std::sort (predicted.begin (), predicted.end ());
+      for (uint32_t k = m_coordinateProbes; k < predicted.size (); k++)
+        {
+          NS_LOG_LOGIC ("Not probing " << tryHeader.GetCandidate (predicted[k].second).GetIpv4 ()
+                        << ", predicted RTT " << predicted[k].first.GetSeconds () << "s");
+          probe[predicted[k].second] = false;
+        }
+    }
+
+  for (uint8_t i = 0; i < tryHeader.GetNCandidates (); i++)
+    {
+      if (!keep[i])
+        {
+          continue;
+        }
+      PossibleParent candidate;
+      candidate.addr = tryHeader.GetCandidate (i);
+      candidate.rtt = Time::Max ();
+      candidate.depth = tryHeader.GetCandidateDepth (i);
+      candidate.latency = tryHeader.GetCandidateLatency (i);
+      candidate.trainRx = 0;
+      candidate.bandwidth = DataRate (0);
+      candidate.complete = false;
+      candidate.seq = 0;
+      // Trains are not cached, so bandwidth probing always probes
+      if (!m_bandwidthProbe && m_mux->LookupRtt (candidate.addr, candidate.rtt))
+        {
+          candidate.complete = true;
+        }
+      else if (!probe[i])
+        {
+          continue;
+        }
+      else
+        {
+          candidate.seq = ScdtServer::SendPing (candidate.addr, ScdtProbeTable::PARENT_PROBE);
+          m_possibleParentsCntr++;
+        }
+      m_possibleParents.push_back (candidate);
+    }
+  if (m_possibleParents.empty () && m_relocating)
+    {
+      AbandonRelocation ("no candidate within the bounds");
+      return;
+    }
+  if (m_possibleParents.empty ())
+    {
+      // A full node without children cannot happen, but do not wait forever
+      StartJoin ();
+      return;
+    }
+  if (m_possibleParentsCntr == 0)
+    {
+      // Every candidate was measured recently by another group
+      SelectParent ();
+      return;
+    }
+  m_probeAttempts = 0;
+  m_probeEvent = Simulator::Schedule (GetBackoff (0), &ScdtServer::ProbeTimeout, this);
+}
+
+bool
+ScdtServer::RemoveTryHeader (Ptr<Packet> packet, ScdtTryHeader & tryHeader) const
+{
+  uint8_t n;
+  if (packet->GetSize () < 1 || packet->CopyData (&n, 1) != 1
+      || packet->GetSize () < ScdtTryHeader::GetSerializedSize (n))
+    {
+      return false;
+    }
+  packet->RemoveHeader (tryHeader);
+  return true;
+}
+
+// Set our parent now that we've successfully attached
+void
+ScdtServer::HandleAttachSuccess (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  if (from != m_attachTarget)
+    {
+      NS_LOG_LOGIC ("Ignoring ATTACH_SUC from " << from << ", not our attach target");
+      return;
+    }
+  ScdtPositionHeader position;
+  bool positioned = packet->GetSize () >= position.GetSerializedSize ();
+  if (positioned)
+    {
+      packet->RemoveHeader (position);
+    }
+  // Our parent and its ancestors are where we rejoin from; a truncated
+  // list is dropped like a lost ATTACH_SUC, which the attach timeout
+  // resends the ATTACH for
+  ScdtTryHeader ancestors;
+  if (packet->GetSize () > 0 && !RemoveTryHeader (packet, ancestors))
+    {
+      NS_LOG_LOGIC ("Dropping ATTACH_SUC from " << from << " with a truncated ancestor list");
+      return;
+    }
+  Simulator::Cancel (m_attachEvent);
+  m_attachAttempts = 0;
+  m_repairTargets.clear ();
+  bool moving = m_attached && from != m_parentIp;
+  if (moving)
+    {
+      // Optimization switch or relocation: free our slot at the old
+      // parent, which stays a good place to go back to
+      SendControl (ScdtHeader::LEAVE, m_parentIp);
+      m_backupParents.insert (m_backupParents.begin (), m_parentIp);
+      if (m_relocating)
+        {
+          m_relocations++;
+        }
+      else
+        {
+          m_parentSwitches++;
+        }
+    }
+  m_relocating = false;
+  if (!m_attached || moving)
+    {
+      m_parentChangeTrace (m_attached ? m_parentIp : Address (), from);
+    }
+  m_parentIp = from;
+  m_attached = true;
+  m_parentHeard = Simulator::Now ();
+  m_backupParents.erase (std::remove (m_backupParents.begin (), m_backupParents.end (), from), m_backupParents.end ());
+  if (m_backupParents.size () > m_maxBackupParents)
+    {
+      m_backupParents.resize (m_maxBackupParents);
+    }
+
+  if (positioned)
+    {
+      SetPosition (position);
+    }
+
+  m_ancestors.clear ();
+  if (m_maxEntryPoints > 0)
+    {
+      m_ancestors.push_back (from);
+    }
+  for (uint8_t i = 0; i < ancestors.GetNCandidates () && m_ancestors.size () < m_maxEntryPoints; i++)
+    {
+      m_ancestors.push_back (ancestors.GetCandidate (i));
+    }
+  if (moving)
+    {
+      NS_LOG_LOGIC ("Moved below " << from);
+      return;
+    }
+  m_joinLatency = Simulator::Now () - m_joinStart;
+  // Relocating right away would find what this join found
+  m_lastRelocation = Simulator::Now ();
+  NS_LOG_LOGIC ("Attached below " << from << " after " << m_joinLatency.GetSeconds () << "s");
+  m_attachTrace (from, m_joinLatency);
+}
+
+void
+ScdtServer::DropData (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet)
+{
+  // Chunks only travel over the TCP data connections
+  NS_LOG_LOGIC ("Dropping DATA of " << packet->GetSize () << " bytes from " << from << " on the control socket");
+}
+
+void
+ScdtServer::UpdateChildren (Address & addr, Time pingTime, const ScdtVivaldiCoordinate & coordinate,
+                            const ScdtMemberHeader & member)
+{
+  // Update shortest ping if new ping is for existing child.  The child
+  // only ATTACHes again if our ATTACH_SUC was lost, so repeat it.
+  int32_t existing = FindChild (addr);
+  if (existing >= 0)
+    {
+      Child &child = m_children[existing];
+      if (pingTime < child.rtt) 
+        {
+          child.rtt = pingTime;
+        }
+      child.coordinate = coordinate;
+      child.heard = Simulator::Now ();
+      child.fanout = member.GetFanout ();
+      child.subtree = member.GetSubtreeSize ();
+      child.freeSlots = member.GetFreeSlots ();
+      InvalidateTryList ();
+      SendAttachSuccess (existing);
+      ConnectChild (existing);
+      return;
+    }
+
+  // Add child because fan-out not used yet
+  if (m_children.size () < m_fanout) 
+    {
+      m_children.push_back (Child ());
+      Child &child = m_children.back ();
+      child.addr = ScdtEndpoint (addr);
+      child.rtt = pingTime;
+      child.coordinate = coordinate;
+      child.heard = Simulator::Now ();
+      child.fanout = member.GetFanout ();
+      child.subtree = member.GetSubtreeSize ();
+      child.freeSlots = member.GetFreeSlots ();
+      InvalidateTryList ();
+      m_childAddedTrace (addr);
+      SendAttachSuccess (m_children.size () - 1);
+      ConnectChild (m_children.size () - 1);
+      return;
+    }
+
+  // Full: the admission policy decides whether a child makes room
+  std::vector<ScdtAdmissionPolicy::Member> children (m_children.size ());
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      children[i].rtt = m_children[i].rtt;
+      children[i].fanout = m_children[i].fanout;
+      children[i].subtree = m_children[i].subtree;
+    }
+  ScdtAdmissionPolicy::Member joiner;
+  joiner.rtt = pingTime;
+  joiner.fanout = member.GetFanout ();
+  joiner.subtree = member.GetSubtreeSize ();
+  int32_t victim = m_admissionPolicy->SelectEviction (joiner, children);
+  if (victim >= 0 && static_cast<uint32_t> (victim) < m_children.size ())
+    {
+      Address oldAddr = m_children[victim].addr;
+      NS_LOG_LOGIC ("Evicting " << oldAddr << " for " << addr);
+      m_evictionTrace (oldAddr, addr);
+      m_childRemovedTrace (oldAddr);
+      m_childAddedTrace (addr);
+      bool blocked = IsBlocked ();
+      DisconnectChild (victim);
+      m_children[victim].addr = ScdtEndpoint (addr);
+      m_children[victim].rtt = pingTime;
+      m_children[victim].coordinate = coordinate;
+      m_children[victim].heard = Simulator::Now ();
+      m_children[victim].fanout = member.GetFanout ();
+      m_children[victim].subtree = member.GetSubtreeSize ();
+      m_children[victim].freeSlots = member.GetFreeSlots ();
+      m_children[victim].fed = false;
+      SendControl (ScdtHeader::REATTACH, oldAddr);
+
+      SendAttachSuccess (victim);
+      ConnectChild (victim);
+      InvalidateTryList ();
+      ResumeReading (blocked);
+    }
+  else 
+    {
+      SendControl (GetTryList (), ScdtHeader::TRY, addr);
+    }
+}
+
+void
+ScdtServer::InvalidateTryList (void)
+{
+  // Ranked and serialized again by the next TRY only: a busy parent
+  // sends many TRYs between two changes of its children
+  m_tryList = 0;
+}
+
+Ptr<Packet>
+ScdtServer::GetTryList (void)
+{
+  if (m_tryList == 0)
+    {
+      // Children with a free slot first, since a joiner attaches there
+      // without descending further; then the closest to us, since their
+      // subtrees are nearest the root; then the smallest subtrees
+      struct Rank
+      {
+        bool full;
+        Time rtt;
+        uint32_t subtree;
+        uint8_t i;
+        bool operator< (const Rank &o) const
+        {
+          if (full != o.full)
+            {
+              return !full;
+            }
+          if (rtt != o.rtt)
+            {
+              return rtt < o.rtt;
+            }
+          return subtree < o.subtree;
+        }
+      };
+      std::vector<Rank> ranks (m_children.size ());
+      for (uint32_t i = 0; i < m_children.size (); i++)
+        {
+          ranks[i].full = m_children[i].freeSlots == 0;
+          ranks[i].rtt = m_children[i].rtt;
+          ranks[i].subtree = m_children[i].subtree;
+          ranks[i].i = i;
+        }
+      std::stable_sort (ranks.begin (), ranks.end ());
+      ScdtTryHeader tryHeader;
+      for (std::vector<Rank>::const_iterator it = ranks.begin (); it != ranks.end (); ++it)
+        {
+          const Child &child = m_children[it->i];
+          ScdtPositionHeader position = GetChildPosition (it->i);
+          tryHeader.AddCandidate (child.addr.GetInet (), child.coordinate,
+                                  position.GetDepth (), position.GetLatency ());
+        }
+      m_tryList = Create<Packet> ();
+      m_tryList->AddHeader (tryHeader);
+    }
+  // Copy on write: the serialized list is shared by every TRY
+  return m_tryList->Copy ();
+}
+
+int
+ScdtServer::SendTcp(Ptr<Socket> socket, Ptr<Packet> p) 
+{
+  m_txTrace (p);
+  int actual = socket->Send (p);
+  if (actual < 0)
+    {
+      NS_LOG_LOGIC ("Send of " << p->GetSize () << " bytes failed: " << socket->GetErrno ());
+    }
+  return actual;
+}
+
+void ScdtServer::ConnectionSucceeded (Ptr<Socket> socket)
+{
+  NS_LOG_LOGIC ("Connection succeeded");
+  // A child that attached after the stream started gets it right away
+  int32_t i = GetChildIndex (socket);
+  if (i < 0)
+    {
+      return;
+    }
+  if (!m_isRoot)
+    {
+      DrainChild (i);
+    }
+  else if (m_streaming)
+    {
+      FillChild (i);
+    }
+}
+
+void ScdtServer::ConnectionFailed (Ptr<Socket> socket)
+{
+  NS_LOG_LOGIC ("Connection to a child failed");
+  for (uint32_t i = 0; i < m_children.size (); i++)
+    {
+      if (m_children[i].socket == socket)
+        {
+          // Let the next ATTACH of this child open a new connection
+          m_children[i].socket = 0;
+        }
+    }
+}
+
+void ScdtServer::DataSend (Ptr<Socket> socket, uint32_t)
+{
+  // Room in the tx buffer again: top it up from the stream
+  int32_t i = GetChildIndex (socket);
+  if (i < 0)
+    {
+      return;
+    }
+  if (m_isRoot)
+    {
+      if (m_streaming)
+        {
+          FillChild (i);
+        }
+      return;
+    }
+  bool blocked = IsBlocked ();
+  DrainChild (i);
+  ResumeReading (blocked);
 }
 
 } // Namespace ns3
@@ -24,22 +24,25 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
-#include <stack>
-#include <set>
-
-#define MAX_FANOUT 4
-#define MAX_PINGS 100
+#include "scdt-header.h"
+#include "scdt-probe-table.h"
+#include "scdt-latency-histogram.h"
+#include "scdt-socket-mux.h"
+#include "scdt-admission-policy.h"
+#include "scdt-endpoint.h"
+#include "scdt-stats-collector.h"
+#include "ns3/data-rate.h"
+#include "ns3/callback.h"
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
 
 namespace ns3 {
 
 class Socket;
 class Packet;
-  
-extern const uint8_t ATTACH[];
-extern const uint8_t PING[];
-extern const uint8_t PING_RESP[];  
-extern const uint8_t TRY_RESP[];
-extern const uint8_t ATTACH_SUC[];
+class UniformRandomVariable;
 
 /**
  * \ingroup udpecho
@@ -56,6 +59,16 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief What to do with a new chunk when a child queue is full.
+   */
+  enum QueuePolicy
+  {
+    QUEUE_BLOCK,          //!< Stop reading from the parent until the queue drains
+    QUEUE_DROP_OLDEST,    //!< Drop the oldest queued chunk
+    QUEUE_SKIP_TO_LATEST  //!< Drop every queued chunk
+  };
+
   ScdtServer ();
 
   virtual ~ScdtServer ();
@@ -73,18 +86,267 @@ public:
    */
   void SetRemote (Address addr);
 
-  uint32_t SendPing (Ptr<Socket> socket, Address & dest);
+  /**
+   * \brief Send a PING and record it in the probe table.
+   * \param dest the endpoint to probe
+   * \param kind what the probe is for
+   * \returns the sequence number of the probe
+   */
+  uint32_t SendPing (Address & dest, ScdtProbeTable::ProbeKind kind);
   
   void SendData (Ptr<Packet> packet);
 
+  /**
+   * \brief Start the stream at the root, towards every connected child.
+   *
+   * The root produces StreamRate worth of data over time, or StreamBytes
+   * at once if StreamRate is 0, and each child connection is filled up to
+   * its tx buffer space.
+   */
   void rootSendData ();
 
-  void SetSockets ();
+  /**
+   * \brief Dispatch a received control datagram on its ScdtHeader type.
+   * \param socket the socket the packet was received on
+   * \param from the sender of the packet
+   * \param packet the packet, still carrying its ScdtHeader
+   */
+  void InterpretPacket (Ptr<Socket> socket, Address & from, Ptr<Packet> packet);
+  /**
+   * \brief Take over a data connection opened by our parent.
+   *
+   * Called by the node's ScdtSocketMux once it has read the group id
+   * the connection was opened with.
+   *
+   * \param socket the connection
+   * \param from the parent
+   */
+  void HandleAccept (Ptr<Socket> socket, const Address& from);
 
-  double endTime = 0;
-  double latencyDiff;
-  
-  void InterpretPacket (Ptr<Socket> socket, Address & from, uint8_t* contents, uint32_t size);
+  /**
+   * \brief Get the duration of the last completed join.
+   *
+   * Measured from the first ATTACH of a join (at start-up or after a
+   * REATTACH) to the ATTACH_SUC that completed it.
+   *
+   * \returns the join latency, or zero if the node never attached
+   */
+  Time GetJoinLatency (void) const;
+
+  /**
+   * \returns the maximum number of children of this node, valid once
+   * the application has started
+   */
+  uint8_t GetFanout (void) const;
+  /**
+   * \returns the address of the parent, only meaningful if IsAttached ()
+   */
+  Address GetParent (void) const;
+  /**
+   * \returns true if the node has received ATTACH_SUC from its parent
+   */
+  bool IsAttached (void) const;
+  /**
+   * \returns true if the node is the root of its group
+   */
+  bool IsRoot (void) const;
+  /**
+   * \returns the number of children
+   */
+  uint32_t GetNChildren (void) const;
+  /**
+   * \param i the index of a child, below GetNChildren ()
+   * \returns the control address of the child
+   */
+  Address GetChild (uint32_t i) const;
+  /**
+   * \param i the index of a child, below GetNChildren ()
+   * \returns the shortest RTT measured to the child
+   */
+  Time GetChildRtt (uint32_t i) const;
+  /**
+   * \brief Replace the function scoring candidate parents when
+   * BandwidthProbe is set.
+   *
+   * The callback gets the RTT to a candidate and the bandwidth estimated
+   * from its probe train (0 if the train was lost) and returns a score;
+   * the candidate with the lowest score is selected.
+   *
+   * \param score the scoring function
+   */
+  void SetParentScoreCallback (Callback<double, Time, DataRate> score);
+  /**
+   * \brief Replace the policy created from the AdmissionPolicy attribute.
+   * \param policy the policy deciding whether a full node evicts a child
+   * for a joiner
+   */
+  void SetAdmissionPolicy (Ptr<ScdtAdmissionPolicy> policy);
+  /**
+   * \returns the admission policy, created from the AdmissionPolicy
+   * attribute when the application starts unless one was set
+   */
+  Ptr<ScdtAdmissionPolicy> GetAdmissionPolicy (void) const;
+  /**
+   * \returns the number of nodes in the subtree of this node, itself
+   * included, as last reported by the children
+   */
+  uint32_t GetSubtreeSize (void) const;
+  /**
+   * \brief Add a node to start joining from instead of the root.
+   *
+   * A joiner sends its first ATTACH to an entry point drawn at random
+   * among the known ones, which spreads the joins over the tree and off
+   * the root.  An entry point that is not attached yet ignores the
+   * ATTACH, and the joiner falls back to the root after ProbeRetries.
+   * Nodes rejoining after a REATTACH prefer the ancestors learned from
+   * ATTACH_SUC, see MaxEntryPoints; without any, a node that still has
+   * children rejoins from the root, since an entry point may be one of
+   * its descendants.
+   *
+   * \param entry the control address (IP and port) of a member of the group
+   */
+  void AddEntryPoint (Address entry);
+  /**
+   * \brief Start attached below a parent instead of joining.
+   *
+   * Lets a tree built beforehand (see ScdtTree) skip the join phase.
+   * When the application starts it takes the given position, as if the
+   * parent had just sent ATTACH_SUC; the parent, on which the node was
+   * added with AddPresetChild, connects to it at the same time.  The
+   * applications of a preset tree must therefore start together.  Must
+   * be called before the application starts.
+   *
+   * \param ancestors the control addresses of the nearest ancestors,
+   * parent first; at most MaxEntryPoints are kept
+   * \param depth the depth of the node
+   * \param rootLatency the estimated latency from the root to the node
+   */
+  void SetPresetParent (const std::vector<Address> & ancestors, uint16_t depth, Time rootLatency);
+  /**
+   * \brief Start with a child already attached.
+   *
+   * The child, on which SetPresetParent was called, gets a slot and a
+   * data connection when the application starts.  Starting with more
+   * preset children than the fan-out aborts the simulation.  Must be
+   * called before the application starts.
+   *
+   * \param child the control address of the child
+   * \param rtt the RTT to the child
+   * \param subtree the size of the subtree of the child, itself included
+   */
+  void AddPresetChild (const Address & child, Time rtt, uint32_t subtree);
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this application.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this application
+   */
+  int64_t AssignStreams (int64_t stream);
+  /**
+   * \returns the number of stream bytes received from the parent
+   */
+  uint64_t GetRxBytes (void) const;
+  /**
+   * \returns the number of complete stream chunks received from the parent
+   */
+  uint64_t GetRxChunks (void) const;
+  /**
+   * \returns the latencies of the chunks received so far, from their
+   * creation at the root to their reassembly here
+   */
+  const ScdtLatencyHistogram & GetLatencyHistogram (void) const;
+  /**
+   * \returns the number of control datagrams sent, TRAIN packets included
+   */
+  uint64_t GetControlTx (void) const;
+  /**
+   * \returns the number of control messages sent, TRAIN packets
+   * included; more than GetControlTx () when messages share datagrams
+   */
+  uint64_t GetControlMessages (void) const;
+  /**
+   * \returns the smoothed latency of the chunks received from the
+   * parent, zero at the root, or Time::Max () while unknown
+   */
+  Time GetStreamDelay (void) const;
+  /**
+   * \returns the number of times the node moved to a better parent
+   * during an optimization round, see OptimizeInterval
+   */
+  uint32_t GetParentSwitches (void) const;
+  /**
+   * \returns the depth of the node in the tree, 0 at the root, as last
+   * told by its parent; only meaningful if IsAttached ()
+   */
+  uint16_t GetDepth (void) const;
+  /**
+   * \returns the estimated latency from the root to the node, the sum of
+   * half the RTTs along its path, as last told by its parent; only
+   * meaningful if IsAttached ()
+   */
+  Time GetRootLatency (void) const;
+  /**
+   * \returns the number of times the node moved up the tree because its
+   * position broke MaxDepth or MaxLatency
+   */
+  uint32_t GetRelocations (void) const;
+  /**
+   * \returns the number of chunks received later than MaxLatency, which
+   * were not forwarded to the children
+   */
+  uint64_t GetLateChunks (void) const;
+
+  /**
+   * TracedCallback signature for received chunks.
+   *
+   * \param [in] seq The sequence number of the chunk in the stream.
+   * \param [in] latency The time since the chunk was created at the root.
+   */
+  typedef void (* ChunkRxTracedCallback)(uint32_t seq, Time latency);
+  /**
+   * TracedCallback signature for child queue events.
+   *
+   * \param [in] child The address of the child.
+   * \param [in] chunks The queue depth, or the number of chunks dropped.
+   */
+  typedef void (* ChildQueueTracedCallback)(const Address & child, uint32_t chunks);
+  /**
+   * TracedCallback signature for sent PINGs.
+   *
+   * \param [in] peer The address probed.
+   * \param [in] seq The sequence number of the PING.
+   */
+  typedef void (* ProbeSentTracedCallback)(const Address & peer, uint32_t seq);
+  /**
+   * TracedCallback signature for answered PINGs.
+   *
+   * \param [in] peer The address that answered.
+   * \param [in] seq The sequence number of the PING.
+   * \param [in] rtt The round trip time measured.
+   */
+  typedef void (* ProbeAnsweredTracedCallback)(const Address & peer, uint32_t seq, Time rtt);
+  /**
+   * TracedCallback signature for completed joins.
+   *
+   * \param [in] parent The address of the new parent.
+   * \param [in] latency The join latency, see GetJoinLatency.
+   */
+  typedef void (* AttachTracedCallback)(const Address & parent, Time latency);
+  /**
+   * TracedCallback signature for a pair of nodes: the old and new parent
+   * of a node, or the evicted child and the joiner taking its slot.
+   *
+   * \param [in] oldAddress The node left, or the evicted child.
+   * \param [in] newAddress The node joined, or the joiner.
+   */
+  typedef void (* AddressPairTracedCallback)(const Address & oldAddress, const Address & newAddress);
+  /**
+   * TracedCallback signature for children added or removed.
+   *
+   * \param [in] child The address of the child.
+   */
+  typedef void (* ChildTracedCallback)(const Address & child);
 
   void DoSetup (void);
   /**
@@ -164,6 +426,11 @@ private:
   virtual void StartApplication (void);
   virtual void StopApplication (void);
 
+  /**
+   * \brief Push our counters and latencies into the StatsCollector.
+   */
+  void ReportStats (void);
+
   /**
    * \brief Schedule the next packet transmission
    * \param dt time interval between packets.
@@ -175,20 +442,212 @@ private:
   void Send (void);
 
   /**
-   * \brief Handle a packet reception.
+   * \brief Work out the fan-out from the MaxFanout and StreamRate attributes.
+   * \returns the maximum number of children
+   */
+  uint8_t ComputeFanout (void) const;
+
+  /**
+   * \brief Handler for one ScdtHeader::MessageType.
    *
-   * This function is called by lower layers.
+   * The header has already been removed from the packet, so the packet
+   * only holds the message payload (if any).
+   */
+  typedef void (ScdtServer::*ControlHandler)(Ptr<Socket> socket, Address & from,
+                                             const ScdtHeader & header, Ptr<Packet> packet);
+
+  /// Handlers indexed by ScdtHeader::MessageType
+  static const ControlHandler m_controlHandlers[ScdtHeader::MESSAGE_TYPE_COUNT];
+
+  void HandleAttach (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandlePing (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandlePingResponse (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandleTry (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandleAttachSuccess (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandleReattach (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  /**
+   * \brief Drop a DATA message received on the control socket.
    *
-   * \param socket the socket the packet was received to.
+   * DATA only opens a data connection, ahead of the chunks sent over
+   * it; nothing sends it as a control datagram.
    */
-  void HandleRead (Ptr<Socket> socket);
+  void DropData (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandlePingTrain (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandleTrain (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
 
-  void UpdateChildren (Address & addr, double pingTime);
+  /**
+   * \brief Remove a candidate list from a control payload.
+   * \param packet the payload, starting with the candidate list
+   * \param tryHeader the header to fill
+   * \returns false, leaving the packet untouched, if the payload is too
+   * short for the number of candidates it announces
+   */
+  bool RemoveTryHeader (Ptr<Packet> packet, ScdtTryHeader & tryHeader) const;
+  void HandleHeartbeat (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
+  void HandleLeave (Ptr<Socket> socket, Address & from, const ScdtHeader & header, Ptr<Packet> packet);
 
-  void SerializeChildren ();
+  /**
+   * \brief Prepend an ScdtHeader to a payload and queue it for its destination.
+   * \param payload the message payload (may be empty)
+   * \param type the ScdtHeader::MessageType
+   * \param to the destination
+   * \param seq the sequence number carried in the header
+   */
+  void SendControl (Ptr<Packet> payload, uint8_t type, const Address & to, uint32_t seq = 0);
+  /**
+   * \brief Send a control message without payload.
+   * \param type the ScdtHeader::MessageType
+   * \param to the destination
+   * \param seq the sequence number carried in the header
+   */
+  void SendControl (uint8_t type, const Address & to, uint32_t seq = 0);
+  /**
+   * \brief Queue a control message in the outbox of its destination.
+   *
+   * The messages queued for a destination during one event leave in a
+   * single datagram when the outbox is flushed, at the end of the event.
+   * Without ControlAggregation the message is sent at once.
+   * \param header the header of the message, its length is set here
+   * \param payload the message payload (may be empty)
+   * \param to the destination
+   */
+  void QueueControl (ScdtHeader header, Ptr<Packet> payload, const Address & to);
+  /**
+   * \brief Send every outbox, one datagram per destination.
+   */
+  void FlushControl (void);
+  /**
+   * \brief Send a datagram on the control socket now.
+   * \param packet the datagram, one or more messages
+   * \param to the destination
+   */
+  void SendDatagram (Ptr<Packet> packet, const Address & to);
 
-  uint8_t* m_serializedChildren; 
-  uint32_t m_serializedChildrenSize;
+  /**
+   * \brief Accept, swap in or redirect a joiner whose RTT is known.
+   * \param addr the joiner
+   * \param pingTime the RTT to the joiner
+   * \param coordinate the coordinate of the joiner
+   * \param member the fan-out and subtree size of the joiner
+   */
+  void UpdateChildren (Address & addr, Time pingTime, const ScdtVivaldiCoordinate & coordinate,
+                       const ScdtMemberHeader & member);
+  /**
+   * \returns our fan-out and subtree size, as advertised to our parent
+   */
+  ScdtMemberHeader GetMemberHeader (void) const;
+
+  /**
+   * \brief Send ATTACH to the answered candidate with the lowest RTT, or
+   * the lowest score if BandwidthProbe is set.
+   */
+  void SelectParent (void);
+
+  /**
+   * \brief Start joining the tree from an ancestor, an entry point, or
+   * the root.
+   *
+   * Entry points are skipped while we have children: one may be our
+   * descendant, still attached to our subtree.
+   */
+  void StartJoin (void);
+  /**
+   * \brief Accept a joiner as a child, telling it its position and our
+   * ancestors.
+   * \param i the index of the joiner among the children
+   */
+  void SendAttachSuccess (uint8_t i);
+  /**
+   * \brief Rejoin close to where we were after losing our parent.
+   *
+   * Tries the backup parents, then the ancestors, each once, before
+   * falling back to a full join.  The subtree below us stays attached
+   * to us meanwhile.
+   *
+   * \param lost the parent that evicted us or stopped answering
+   */
+  void Repair (const Address & lost);
+  /**
+   * \brief Send a HEARTBEAT to our parent and children, and drop those
+   * we have not heard from for HeartbeatMisses intervals.
+   */
+  void Heartbeat (void);
+  /**
+   * \brief Start an optimization round: probe a few nodes near our
+   * parent for a lower stream delay, and schedule the next round.
+   */
+  void Optimize (void);
+  /**
+   * \brief End the optimization round: move below the best answered
+   * candidate if it beats our stream delay by SwitchThreshold.
+   */
+  void EndOptimization (void);
+  /**
+   * \brief Look for a position within MaxDepth and MaxLatency from the
+   * top of the tree, staying below our parent meanwhile.
+   */
+  void Relocate (void);
+  /**
+   * \brief Give up the current relocation and stay below our parent.
+   * \param reason why, for the log
+   */
+  void AbandonRelocation (const char *reason);
+  /**
+   * \param depth a depth in the tree
+   * \param latency an estimated root latency
+   * \returns true if both are within MaxDepth and MaxLatency
+   */
+  bool IsFeasible (uint16_t depth, Time latency) const;
+  /**
+   * \param i the index of a child
+   * \returns the depth and root latency of the child below us
+   */
+  ScdtPositionHeader GetChildPosition (uint8_t i) const;
+  /**
+   * \brief Take the position our parent told us, and advertise the new
+   * positions of our children if it changed.
+   * \param position our depth and root latency
+   */
+  void SetPosition (const ScdtPositionHeader & position);
+  /**
+   * \brief Forget a child, closing its data connection.
+   * \param i the index of the child
+   */
+  void RemoveChild (uint8_t i);
+  /**
+   * \brief Send ATTACH and arm the attach deadline.
+   * \param target the node to attach below
+   */
+  void SendAttach (const Address & target);
+  /**
+   * \brief No TRY or ATTACH_SUC arrived in time: resend ATTACH with backoff.
+   */
+  void AttachTimeout (void);
+  /**
+   * \brief The probe deadline of a TRY round expired.
+   *
+   * Selects the best candidate that answered, or re-probes the
+   * unanswered candidates with backoff if none did.
+   */
+  void ProbeTimeout (void);
+  /**
+   * \param attempt the retry number, starting at zero
+   * \returns the deadline for that attempt, doubling with every retry
+   */
+  Time GetBackoff (uint32_t attempt) const;
+
+  /**
+   * \brief Drop the cached TRY list after a change of our children.
+   */
+  void InvalidateTryList (void);
+  /**
+   * \returns the TRY payload: our children ranked best first, ranked
+   * and serialized again only after a change
+   */
+  Ptr<Packet> GetTryList (void);
+
+  Ptr<Packet> m_tryList; //!< Serialized TRY payload, 0 until the next TRY after a change
+  uint32_t m_groupId; //!< Group id stamped on outgoing control messages
 
   uint32_t m_count; //!< Maximum number of packets the application will send
   Time m_interval; //!< Packet inter-send time
@@ -209,28 +668,153 @@ private:
 
   Address m_parentIp; // Address of parent
   uint16_t m_parentPort; // Port of parent
-  Ptr<Socket> m_parentSocket;
+  Ptr<ScdtSocketMux> m_mux; //!< Sockets shared with the other groups of the node
+  uint16_t m_dataPort; //!< TCP port of the data connections
+
+  /// What a node keeps of each of its children
+  struct Child
+  {
+    ScdtEndpoint addr; //!< Control endpoint of the child
+    uint8_t fanout; //!< Fan-out it advertised
+    uint32_t subtree; //!< Subtree size it last reported
+    uint8_t freeSlots; //!< Child slots it last reported left
+    Time rtt; //!< Shortest RTT measured to it
+    Time heard; //!< Last HEARTBEAT (or ATTACH) from it
+    bool fed; //!< Sent a chunk since the last HEARTBEAT round
+    ScdtVivaldiCoordinate coordinate; //!< Coordinate advertised for it in the TRY list
+    Ptr<Socket> socket; //!< Data connection to it
+    uint64_t streamOffset; //!< Stream bytes handed to its connection, at the root
+    /// Chunks waiting for its connection; a list allocates nothing while
+    /// empty, which it is as long as the child keeps up
+    std::list<Ptr<Packet> > queue;
+  };
+  /**
+   * \param addr a control endpoint
+   * \returns the index of the child at that endpoint, or -1
+   */
+  int32_t FindChild (const Address & addr) const;
 
-  Address* m_children; // Address of child nodes
-  uint16_t* m_childrenPorts; // Ports of child nodes
-  double* m_shortestPing;
-  uint8_t m_numChildren;
-  Ptr<Socket>* m_childrenSockets;
+  std::vector<Child> m_children; //!< Children, at most m_fanout, reserved once by DoSetup
+  TypeId m_admissionPolicyTid; //!< AdmissionPolicy attribute
+  Ptr<ScdtAdmissionPolicy> m_admissionPolicy; //!< Decides whether a full node evicts a child
+  uint8_t m_fanout; //!< Maximum number of children, see ComputeFanout
+  uint8_t m_maxFanout; //!< MaxFanout attribute, 0 for automatic
+  DataRate m_streamRate; //!< Stream bit rate, 0 to send StreamBytes at once
 
   bool m_isRoot; // True if node is root of tree; false otherwise
+  bool m_attached; //!< True once ATTACH_SUC has been received
   double m_packLatencySum = 0;
 
-  Address* m_pings; // Address of pinging host
-  double* m_pingStartTime; // Parallel array to 'pings'; start time of most recent ping
-  double* m_pingTime; // Parallel array to 'pings'; most recent ping time
-  uint32_t m_numPings; // Counter of number of hosts ping data has been stored for
-  std::stack <uint32_t> m_possibleParentsStk; // Array indices of possible parents
-  std::set <uint32_t> m_possibleParentsSet;
+  ScdtProbeTable m_probes; //!< Outstanding PINGs
+  uint32_t m_nextProbeSeq; //!< Sequence number of the next PING
+  Time m_probeTimeout; //!< Time to wait for answers before the first retry
+  uint32_t m_probeRetries; //!< Retries of an unanswered ATTACH or TRY round
+
+  /// A candidate parent taken from a TRY list
+  struct PossibleParent
+  {
+    Address addr; //!< Candidate address
+    uint32_t seq; //!< Sequence number of the PING sent to it
+    Time rtt; //!< Measured RTT, Time::Max () until answered
+    uint16_t depth; //!< Its depth, from the TRY list
+    Time latency; //!< Its root latency, from the TRY list
+    uint8_t trainRx; //!< TRAIN packets received from it
+    Time firstTrainRx; //!< Arrival of the first TRAIN packet
+    DataRate bandwidth; //!< Estimated from the train dispersion, 0 if unknown
+    bool complete; //!< True once every probe of the round has been answered
+  };
+  /**
+   * \brief Count a candidate as answered once its PING and, if any, its
+   * train have come back, and select a parent when all have.
+   * \param candidate the candidate
+   */
+  void CheckCandidate (PossibleParent & candidate);
+  /**
+   * \brief Default parent score, see the BandwidthWeight attribute.
+   * \param rtt the RTT to the candidate
+   * \param bandwidth the estimated bandwidth from the candidate, 0 if unknown
+   * \returns the score, lower is better
+   */
+  double ScoreParent (Time rtt, DataRate bandwidth) const;
+
+  bool m_bandwidthProbe; //!< Probe candidate parents with packet trains
+  uint8_t m_trainLength; //!< Packets per probe train
+  uint16_t m_trainPacketSize; //!< Size of each probe train packet
+  double m_bandwidthWeight; //!< Exponent of the bandwidth penalty in ScoreParent
+  Callback<double, Time, DataRate> m_parentScore; //!< Scores candidate parents
+  uint8_t m_coordinateProbes; //!< Candidates probed per TRY round, 0 for all
+  uint8_t m_tryProbes; //!< Candidates probed from the head of a TRY list, 0 for all
+  std::vector<Address> m_entryPoints; //!< Configured nodes to start joining from
+  std::vector<Address> m_ancestors; //!< Nearest ancestors, parent first, learned from ATTACH_SUC
+  std::vector<Address> m_presetAncestors; //!< Ancestors to start attached below, see SetPresetParent
+  /// A child to start with, see AddPresetChild
+  struct PresetChild
+  {
+    Address addr; //!< Control address of the child
+    Time rtt; //!< RTT to the child
+    uint32_t subtree; //!< Subtree size of the child
+  };
+  std::vector<PresetChild> m_presetChildren; //!< Children to start with
+  /**
+   * \brief Take the place set with SetPresetParent and AddPresetChild.
+   */
+  void StartPreset (void);
+  uint8_t m_maxEntryPoints; //!< Number of ancestors kept in m_ancestors
+  Ptr<UniformRandomVariable> m_entryRng; //!< Draws the entry point to join from and the optimization rounds
+  std::vector<Address> m_backupParents; //!< Runners-up of the last TRY round, best first
+  uint8_t m_maxBackupParents; //!< Number of runners-up kept in m_backupParents
+  std::deque<Address> m_repairTargets; //!< Nodes still to try in the current repair
+  Time m_heartbeatInterval; //!< Time between HEARTBEATs, 0 to disable them
+  uint32_t m_heartbeatMisses; //!< HEARTBEATs missed before a peer is declared lost
+  Time m_parentHeard; //!< Last HEARTBEAT from the parent
+  EventId m_heartbeatEvent; //!< Next HEARTBEAT
+  uint64_t m_controlTx; //!< Control datagrams sent
+  uint64_t m_controlMessages; //!< Control messages sent
+  bool m_controlAggregation; //!< Coalesce control messages and piggyback HEARTBEATs on the stream
+  std::map<ScdtEndpoint, Ptr<Packet> > m_outbox; //!< Control messages queued per destination
+  EventId m_flushEvent; //!< Flush of the outboxes at the end of the current event
+  bool m_positionChanged; //!< Our position changed since the last HEARTBEAT round
+  Time m_optimizeInterval; //!< Mean time between optimization rounds, 0 to disable them
+  uint8_t m_optimizeProbes; //!< Candidates probed per optimization round
+  double m_switchThreshold; //!< Relative stream delay gain needed to switch parent
+  EventId m_optimizeEvent; //!< Next optimization round
+  EventId m_optimizeDeadline; //!< End of the current optimization round
+  Time m_streamDelay; //!< Smoothed chunk latency, Time::Max () until known
+  uint32_t m_parentSwitches; //!< Moves to a better parent
+  uint16_t m_maxDepth; //!< Deepest position a node may take, 0 for no bound
+  Time m_maxLatency; //!< Largest root latency a node may have, 0 for no bound
+  Time m_boundRetryInterval; //!< Least time between two relocations
+  uint16_t m_depth; //!< Our depth, 0 at the root
+  Time m_rootLatency; //!< Our estimated root latency
+  bool m_relocating; //!< True while looking for a position within the bounds
+  Time m_lastRelocation; //!< Start of the last relocation or join
+  uint32_t m_relocations; //!< Moves made to meet the bounds
+  uint64_t m_lateChunks; //!< Chunks received later than MaxLatency
+
+  /// A candidate parent probed during an optimization round
+  struct OptimizeCandidate
+  {
+    Address addr; //!< Candidate address
+    uint32_t seq; //!< Sequence number of the PING sent to it
+    Time rtt; //!< Measured RTT, Time::Max () until answered
+    Time delay; //!< Stream delay it advertised, Time::Max () if unknown
+  };
+  std::vector<OptimizeCandidate> m_optimizeCandidates; //!< Candidates of the current optimization round
+  std::vector<PossibleParent> m_possibleParents; //!< Candidates of the current TRY round
 
   Address m_nextPotentialParent;
-  double m_nextPotentialParentPing;
-  uint8_t m_possibleParentsCntr;
-  /// Callbacks for tracing the packet Tx events
+  uint8_t m_possibleParentsCntr; //!< Candidates of the current round still unanswered
+
+  Address m_attachTarget; //!< Node our last ATTACH was sent to
+  uint32_t m_attachAttempts; //!< Retries of the ATTACH to m_attachTarget
+  EventId m_attachEvent; //!< Deadline for TRY or ATTACH_SUC
+  uint32_t m_probeAttempts; //!< Retries of the current TRY round
+  EventId m_probeEvent; //!< Deadline for the PING answers of the current TRY round
+  Time m_joinStart; //!< Time the current join started
+  Time m_joinLatency; //!< Duration of the last completed join
+  Time m_lastChunk; //!< Arrival of the last chunk, zero if none
+  Ptr<ScdtStatsCollector> m_stats; //!< Collects our results when we stop, if set
+  /// Callbacks for tracing the control datagrams and data connection writes
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
   void ConnectionSucceeded (Ptr<Socket> socket);
@@ -239,13 +823,121 @@ private:
 
   void DataSend (Ptr<Socket> socket, uint32_t);
 
-  void SendTcp (Ptr<Socket> socket, Ptr<Packet> packet);
+  /**
+   * \param socket the data connection
+   * \param packet the data
+   * \returns the number of bytes accepted, or -1 on error
+   */
+  int SendTcp (Ptr<Socket> socket, Ptr<Packet> packet);
 
   void SetTcpReceiveSocket();
 
-  void HandleAccept (Ptr<Socket> socket, const Address& from);
+  /**
+   * \brief Open the data connection to a child, unless one is already open.
+   * \param i the index of the child
+   */
+  void ConnectChild (uint8_t i);
+  /**
+   * \brief Close the data connection to a child.
+   * \param i the index of the child
+   */
+  void DisconnectChild (uint8_t i);
+  /**
+   * \brief Make the next PacketSize bytes of the stream available and
+   * hand them to the children.
+   */
+  void ProduceStream (void);
+  /**
+   * \brief Fill every child connection from the stream.
+   */
+  void FillChildren (void);
+  /**
+   * \brief Send a child the stream data it has not received yet, as far
+   * as its tx buffer allows.
+   * \param i the index of the child
+   */
+  void FillChild (uint8_t i);
+  /**
+   * \param socket a data connection
+   * \returns the index of the child the connection goes to, or -1
+   */
+  int32_t GetChildIndex (Ptr<Socket> socket) const;
+  /**
+   * \param seq the sequence number of a chunk
+   * \returns the time the root produced the chunk
+   */
+  Time GetChunkOrigin (uint32_t seq) const;
+
+  Ptr<Socket> m_parentDataSocket; //!< Accepted data connection from our parent
+  Time m_streamStart; //!< Delay before the root starts streaming
+  EventId m_streamEvent; //!< Event starting or producing the stream at the root
+  bool m_streaming; //!< True once the root has started streaming
+  uint64_t m_streamBytes; //!< Bytes to stream, 0 for no limit
+  uint64_t m_streamProduced; //!< Stream bytes produced so far at the root
+  Time m_streamStartTime; //!< Time the root started the stream
+  uint64_t m_rxBytes; //!< Stream bytes received from the parent
+  uint64_t m_rxChunks; //!< Complete chunks received from the parent
+  Ptr<Packet> m_rxBuffer; //!< Partial chunk read from the parent connection
+  ScdtLatencyHistogram m_latency; //!< Latencies of the received chunks
+  uint32_t m_queueSize; //!< Maximum number of chunks queued per child
+  enum QueuePolicy m_queuePolicy; //!< Policy applied when a child queue is full
+  /// Callbacks for tracing the depth of the child queues
+  TracedCallback<const Address &, uint32_t> m_childQueueDepthTrace;
+  /// Callbacks for tracing chunks dropped by the queue policy
+  TracedCallback<const Address &, uint32_t> m_childQueueDropTrace;
+  /// Callbacks for tracing received chunks
+  TracedCallback<uint32_t, Time> m_chunkRxTrace;
+  /// Callbacks for tracing received chunks passed on to the children
+  TracedCallback<uint32_t, Time> m_chunkForwardTrace;
+  /// Callbacks for tracing sent PINGs
+  TracedCallback<const Address &, uint32_t> m_probeSentTrace;
+  /// Callbacks for tracing answered PINGs
+  TracedCallback<const Address &, uint32_t, Time> m_probeAnsweredTrace;
+  /// Callbacks for tracing completed joins
+  TracedCallback<const Address &, Time> m_attachTrace;
+  /// Callbacks for tracing parent changes
+  TracedCallback<const Address &, const Address &> m_parentChangeTrace;
+  /// Callbacks for tracing evictions
+  TracedCallback<const Address &, const Address &> m_evictionTrace;
+  /// Callbacks for tracing new children
+  TracedCallback<const Address &> m_childAddedTrace;
+  /// Callbacks for tracing children gone
+  TracedCallback<const Address &> m_childRemovedTrace;
 
+
+  /**
+   * \brief Read the data connection from our parent and reassemble the
+   * chunks it carries.
+   * \param socket the data connection
+   */
   void HandleTcpRead(Ptr<Socket> socket);
+  /**
+   * \brief Account for a complete chunk and forward it to the children.
+   * \param chunk the chunk, still carrying its ScdtChunkHeader
+   * \param chunkHeader the framing header of the chunk
+   */
+  void HandleChunk (Ptr<Packet> chunk, const ScdtChunkHeader & chunkHeader);
+  /**
+   * \brief Queue a chunk for a child, applying the queue policy if the
+   * queue is full.
+   * \param i the index of the child
+   * \param chunk the chunk
+   */
+  void EnqueueChunk (uint8_t i, Ptr<Packet> chunk);
+  /**
+   * \brief Send a child its queued chunks, as far as its tx buffer allows.
+   * \param i the index of the child
+   */
+  void DrainChild (uint8_t i);
+  /**
+   * \returns true if the Block policy holds back reading from the parent
+   */
+  bool IsBlocked (void) const;
+  /**
+   * \brief Read from the parent again if a child queue no longer blocks us.
+   * \param blocked whether IsBlocked held before the queue shrank or went
+   */
+  void ResumeReading (bool blocked);
 };
 
 } // namespace ns3
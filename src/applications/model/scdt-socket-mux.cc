@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include <cmath>
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/tcp-socket-factory.h"
+#include "scdt-socket-mux.h"
+#include "scdt-header.h"
+#include "scdt-server.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtSocketMux");
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtSocketMux);
+
+TypeId
+ScdtSocketMux::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtSocketMux")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtSocketMux> ()
+    .AddAttribute ("RttCacheLifetime",
+                   "How long an RTT measured to a peer is reused by every group "
+                   "instead of probing the peer again; 0 disables the cache",
+                   TimeValue (Seconds (10.0)),
+                   MakeTimeAccessor (&ScdtSocketMux::m_rttLifetime),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+ScdtSocketMux::ScdtSocketMux ()
+{
+  NS_LOG_FUNCTION (this);
+  m_angle = CreateObject<UniformRandomVariable> ();
+  m_angle->SetAttribute ("Max", DoubleValue (2 * M_PI));
+}
+
+ScdtSocketMux::~ScdtSocketMux ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtSocketMux::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::map<uint16_t, Ptr<Socket> >::iterator it = m_controlSockets.begin ();
+       it != m_controlSockets.end (); ++it)
+    {
+      CloseSocket (it->second);
+    }
+  for (std::map<uint16_t, Ptr<Socket> >::iterator it = m_dataSockets.begin ();
+       it != m_dataSockets.end (); ++it)
+    {
+      CloseSocket (it->second);
+    }
+  for (std::map<Ptr<Socket>, Opening>::iterator it = m_openings.begin ();
+       it != m_openings.end (); ++it)
+    {
+      CloseSocket (it->first);
+    }
+  m_controlSockets.clear ();
+  m_dataSockets.clear ();
+  m_openings.clear ();
+  m_groups.clear ();
+  m_rtts.clear ();
+  Object::DoDispose ();
+}
+
+Ptr<ScdtSocketMux>
+ScdtSocketMux::GetMux (Ptr<Node> node)
+{
+  Ptr<ScdtSocketMux> mux = node->GetObject<ScdtSocketMux> ();
+  if (mux == 0)
+    {
+      mux = CreateObject<ScdtSocketMux> ();
+      node->AggregateObject (mux);
+    }
+  return mux;
+}
+
+Ptr<Socket>
+ScdtSocketMux::RegisterControl (uint32_t groupId, uint16_t port, Ptr<ScdtServer> server)
+{
+  NS_LOG_FUNCTION (this << groupId << port << server);
+  if (m_groups.find (groupId) != m_groups.end ())
+    {
+      NS_FATAL_ERROR ("Group " << groupId << " is already served on this node");
+    }
+  Group group;
+  group.server = server;
+  group.controlPort = port;
+  group.dataPort = 0;
+  m_groups[groupId] = group;
+
+  std::map<uint16_t, Ptr<Socket> >::iterator it = m_controlSockets.find (port);
+  if (it != m_controlSockets.end ())
+    {
+      return it->second;
+    }
+  Ptr<Socket> socket = Socket::CreateSocket (GetObject<Node> (), UdpSocketFactory::GetTypeId ());
+  if (socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), port)) == -1)
+    {
+      NS_FATAL_ERROR ("Failed to bind socket");
+    }
+  socket->SetRecvCallback (MakeCallback (&ScdtSocketMux::HandleRead, this));
+  socket->SetAllowBroadcast (true);
+  m_controlSockets[port] = socket;
+  return socket;
+}
+
+void
+ScdtSocketMux::RegisterData (uint32_t groupId, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << groupId << port);
+  std::map<uint32_t, Group>::iterator group = m_groups.find (groupId);
+  NS_ABORT_MSG_IF (group == m_groups.end (), "Group " << groupId << " has no control registration");
+  group->second.dataPort = port;
+  if (m_dataSockets.find (port) != m_dataSockets.end ())
+    {
+      return;
+    }
+  Ptr<Socket> socket = Socket::CreateSocket (GetObject<Node> (), TcpSocketFactory::GetTypeId ());
+  if (socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), port)) == -1)
+    {
+      NS_FATAL_ERROR ("Failed to bind socket to parent");
+    }
+  socket->Listen ();
+  socket->ShutdownSend ();
+  socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&ScdtSocketMux::HandleAccept, this));
+  m_dataSockets[port] = socket;
+}
+
+void
+ScdtSocketMux::Unregister (uint32_t groupId)
+{
+  NS_LOG_FUNCTION (this << groupId);
+  m_groups.erase (groupId);
+
+  // Close the sockets no remaining group uses
+  std::map<uint16_t, Ptr<Socket> >::iterator it = m_controlSockets.begin ();
+  while (it != m_controlSockets.end ())
+    {
+      bool used = false;
+      for (std::map<uint32_t, Group>::const_iterator g = m_groups.begin (); g != m_groups.end (); ++g)
+        {
+          used = used || g->second.controlPort == it->first;
+        }
+      if (used)
+        {
+          ++it;
+          continue;
+        }
+      CloseSocket (it->second);
+      m_controlSockets.erase (it++);
+    }
+  it = m_dataSockets.begin ();
+  while (it != m_dataSockets.end ())
+    {
+      bool used = false;
+      for (std::map<uint32_t, Group>::const_iterator g = m_groups.begin (); g != m_groups.end (); ++g)
+        {
+          used = used || g->second.dataPort == it->first;
+        }
+      if (used)
+        {
+          ++it;
+          continue;
+        }
+      CloseSocket (it->second);
+      m_dataSockets.erase (it++);
+    }
+}
+
+uint32_t
+ScdtSocketMux::GetNSockets (void) const
+{
+  return m_controlSockets.size () + m_dataSockets.size ();
+}
+
+void
+ScdtSocketMux::CloseSocket (Ptr<Socket> socket)
+{
+  socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+  socket->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeNullCallback<void, Ptr<Socket>, const Address &> ());
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+  socket->Close ();
+}
+
+void
+ScdtSocketMux::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      ScdtHeader header;
+      if (packet->GetSize () < header.GetSerializedSize ())
+        {
+          NS_LOG_LOGIC ("Dropping runt control datagram of " << packet->GetSize () << " bytes");
+          continue;
+        }
+      packet->PeekHeader (header);
+      std::map<uint32_t, Group>::iterator it = m_groups.find (header.GetGroupId ());
+      if (it == m_groups.end ())
+        {
+          NS_LOG_LOGIC ("Dropping control datagram for group " << header.GetGroupId ());
+          continue;
+        }
+      it->second.server->InterpretPacket (socket, from, packet);
+    }
+}
+
+void
+ScdtSocketMux::HandleAccept (Ptr<Socket> socket, const Address & from)
+{
+  NS_LOG_FUNCTION (this << socket << from);
+  Opening opening;
+  opening.buffer = Create<Packet> ();
+  opening.from = from;
+  m_openings[socket] = opening;
+  socket->SetRecvCallback (MakeCallback (&ScdtSocketMux::HandleOpening, this));
+  // A parent may go away before its opening header is complete
+  socket->SetCloseCallbacks (MakeCallback (&ScdtSocketMux::HandleOpeningClose, this),
+                             MakeCallback (&ScdtSocketMux::HandleOpeningClose, this));
+  if (socket->GetRxAvailable () > 0)
+    {
+      HandleOpening (socket);
+    }
+}
+
+void
+ScdtSocketMux::HandleOpening (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, Opening>::iterator it = m_openings.find (socket);
+  if (it == m_openings.end ())
+    {
+      return;
+    }
+  // Read no further than the header: the rest belongs to the group's server
+  ScdtHeader header;
+  while (it->second.buffer->GetSize () < header.GetSerializedSize ())
+    {
+      Ptr<Packet> packet = socket->Recv (header.GetSerializedSize () - it->second.buffer->GetSize (), 0);
+      if (packet == 0 || packet->GetSize () == 0)
+        {
+          return;
+        }
+      it->second.buffer->AddAtEnd (packet);
+    }
+  it->second.buffer->RemoveHeader (header);
+  Address from = it->second.from;
+  m_openings.erase (it);
+  socket->SetCloseCallbacks (MakeNullCallback<void, Ptr<Socket> > (),
+                             MakeNullCallback<void, Ptr<Socket> > ());
+
+  std::map<uint32_t, Group>::iterator group = m_groups.find (header.GetGroupId ());
+  if (group == m_groups.end () || group->second.dataPort == 0)
+    {
+      NS_LOG_LOGIC ("Refusing data connection for group " << header.GetGroupId ());
+      CloseSocket (socket);
+      return;
+    }
+  group->second.server->HandleAccept (socket, from);
+}
+
+void
+ScdtSocketMux::HandleOpeningClose (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  std::map<Ptr<Socket>, Opening>::iterator it = m_openings.find (socket);
+  if (it == m_openings.end ())
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Data connection from " << it->second.from << " closed before its opening header");
+  m_openings.erase (it);
+  CloseSocket (socket);
+}
+
+void
+ScdtSocketMux::RecordRtt (const Address & peer, Time rtt)
+{
+  NS_LOG_FUNCTION (this << peer << rtt);
+  if (!InetSocketAddress::IsMatchingType (peer))
+    {
+      return;
+    }
+  RttSample sample;
+  sample.rtt = rtt;
+  sample.when = Simulator::Now ();
+  m_rtts[InetSocketAddress::ConvertFrom (peer).GetIpv4 ().Get ()] = sample;
+}
+
+bool
+ScdtSocketMux::LookupRtt (const Address & peer, Time & rtt) const
+{
+  if (m_rttLifetime.IsZero () || !InetSocketAddress::IsMatchingType (peer))
+    {
+      return false;
+    }
+  std::map<uint32_t, RttSample>::const_iterator it =
+    m_rtts.find (InetSocketAddress::ConvertFrom (peer).GetIpv4 ().Get ());
+  if (it == m_rtts.end () || Simulator::Now () - it->second.when > m_rttLifetime)
+    {
+      return false;
+    }
+  rtt = it->second.rtt;
+  return true;
+}
+
+const ScdtVivaldiCoordinate &
+ScdtSocketMux::GetCoordinate (void) const
+{
+  return m_coordinate;
+}
+
+void
+ScdtSocketMux::UpdateCoordinate (const ScdtVivaldiCoordinate & remote, Time rtt)
+{
+  NS_LOG_FUNCTION (this << remote << rtt);
+  m_coordinate.Update (remote, rtt, m_angle->GetValue ());
+  NS_LOG_LOGIC ("Coordinate now " << m_coordinate);
+}
+
+int64_t
+ScdtSocketMux::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_angle->SetStream (stream);
+  return 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_SOCKET_MUX_H
+#define SCDT_SOCKET_MUX_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/address.h"
+#include "scdt-vivaldi-coordinate.h"
+#include <map>
+
+namespace ns3 {
+
+class Node;
+class Socket;
+class Packet;
+class ScdtServer;
+class UniformRandomVariable;
+
+/**
+ * \ingroup applications
+ *
+ * \brief Sockets and RTT samples shared by the SCDT groups of a node.
+ *
+ * Every ScdtServer on a node serves one group (tree).  Instead of each
+ * opening its own sockets, they register with the node's ScdtSocketMux,
+ * which owns one UDP control socket per port and one TCP data listening
+ * socket per port, and hands every control datagram and every accepted
+ * data connection to the server of its group:
+ *
+ * - control datagrams are demultiplexed on the group id of their ScdtHeader;
+ * - a parent opens a data connection with an ScdtHeader carrying the
+ *   group id, which the mux consumes before handing the connection over.
+ *
+ * The mux also caches the last RTT measured to each peer node, so that a
+ * node that belongs to several groups probes a peer once for all of them,
+ * and keeps the Vivaldi coordinate of the node, which every RTT measured
+ * by any of its groups refines.
+ */
+class ScdtSocketMux : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  ScdtSocketMux ();
+  virtual ~ScdtSocketMux ();
+
+  /**
+   * \brief Get the mux of a node, aggregating one to it if needed.
+   * \param node the node
+   * \returns the mux of the node
+   */
+  static Ptr<ScdtSocketMux> GetMux (Ptr<Node> node);
+
+  /**
+   * \brief Deliver the control datagrams of a group to a server.
+   * \param groupId the group
+   * \param port the UDP port of the control socket
+   * \param server the server of the group on this node
+   * \returns the shared control socket, to send on
+   */
+  Ptr<Socket> RegisterControl (uint32_t groupId, uint16_t port, Ptr<ScdtServer> server);
+  /**
+   * \brief Hand the data connections of a group to a server.
+   * \param groupId the group
+   * \param port the TCP port parents connect to
+   */
+  void RegisterData (uint32_t groupId, uint16_t port);
+  /**
+   * \brief Stop delivering anything to the server of a group.
+   *
+   * The sockets are closed once no group uses them any more.
+   *
+   * \param groupId the group
+   */
+  void Unregister (uint32_t groupId);
+  /**
+   * \returns the number of sockets the mux has open
+   */
+  uint32_t GetNSockets (void) const;
+
+  /**
+   * \brief Record an RTT measured to a peer node.
+   * \param peer the peer
+   * \param rtt the RTT
+   */
+  void RecordRtt (const Address & peer, Time rtt);
+  /**
+   * \brief Look up a recent RTT to a peer node.
+   * \param peer the peer
+   * \param rtt set to the RTT if one was measured within the RttCacheLifetime
+   * \returns true if a recent RTT is known
+   */
+  bool LookupRtt (const Address & peer, Time & rtt) const;
+
+  /**
+   * \returns the Vivaldi coordinate of the node
+   */
+  const ScdtVivaldiCoordinate & GetCoordinate (void) const;
+  /**
+   * \brief Refine the coordinate of the node with an RTT measured to a peer.
+   * \param remote the coordinate of the peer
+   * \param rtt the RTT
+   */
+  void UpdateCoordinate (const ScdtVivaldiCoordinate & remote, Time rtt);
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this object.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this object
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Receive control datagrams and dispatch them on their group id.
+   * \param socket the control socket
+   */
+  void HandleRead (Ptr<Socket> socket);
+  /**
+   * \brief Read the group id at the start of a new data connection.
+   * \param socket the connection
+   * \param from the parent
+   */
+  void HandleAccept (Ptr<Socket> socket, const Address & from);
+  /**
+   * \brief Accumulate the opening ScdtHeader of a data connection.
+   * \param socket the connection
+   */
+  void HandleOpening (Ptr<Socket> socket);
+  /**
+   * \brief Forget a data connection closed before its opening header arrived.
+   * \param socket the connection
+   */
+  void HandleOpeningClose (Ptr<Socket> socket);
+  /**
+   * \param socket a socket that is no longer needed
+   */
+  static void CloseSocket (Ptr<Socket> socket);
+
+  /// A registered group
+  struct Group
+  {
+    Ptr<ScdtServer> server; //!< Server of the group on this node
+    uint16_t controlPort; //!< Port of its control socket
+    uint16_t dataPort; //!< Port of its data listening socket, 0 for none
+  };
+  /// A data connection whose opening header is not complete yet
+  struct Opening
+  {
+    Ptr<Packet> buffer; //!< Bytes read so far
+    Address from; //!< Parent that opened it
+  };
+  /// An RTT sample
+  struct RttSample
+  {
+    Time rtt; //!< Measured RTT
+    Time when; //!< Time of the measurement
+  };
+
+  std::map<uint32_t, Group> m_groups; //!< Registered groups
+  std::map<uint16_t, Ptr<Socket> > m_controlSockets; //!< UDP control sockets by port
+  std::map<uint16_t, Ptr<Socket> > m_dataSockets; //!< TCP listening sockets by port
+  std::map<Ptr<Socket>, Opening> m_openings; //!< Data connections being opened
+  std::map<uint32_t, RttSample> m_rtts; //!< Last RTT by peer IPv4 address
+  Time m_rttLifetime; //!< How long an RTT sample is reused
+  ScdtVivaldiCoordinate m_coordinate; //!< Coordinate of the node
+  Ptr<UniformRandomVariable> m_angle; //!< Direction to separate coincident coordinates along
+};
+
+} // namespace ns3
+
+#endif /* SCDT_SOCKET_MUX_H */
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/simulator.h"
+#include "scdt-stats-collector.h"
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtStatsCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (ScdtStatsCollector);
+
+namespace {
+
+/// Version of the binary format, bumped on any layout change
+const uint32_t BINARY_VERSION = 1;
+
+void
+WriteU32 (std::ofstream & out, uint32_t value)
+{
+  out.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+void
+WriteDouble (std::ofstream & out, double value)
+{
+  out.write (reinterpret_cast<const char *> (&value), sizeof (value));
+}
+
+void
+WriteName (std::ofstream & out, const std::string & name)
+{
+  uint16_t length = std::min<size_t> (name.size (), 0xffff);
+  out.write (reinterpret_cast<const char *> (&length), sizeof (length));
+  out.write (name.data (), length);
+}
+
+} // anonymous namespace
+
+TypeId
+ScdtStatsCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScdtStatsCollector")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScdtStatsCollector> ()
+    .AddAttribute ("FileName",
+                   "Name of the files written at Simulator::Destroy, without extension",
+                   StringValue ("scdt-stats"),
+                   MakeStringAccessor (&ScdtStatsCollector::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Format",
+                   "Files written at Simulator::Destroy",
+                   EnumValue (FORMAT_CSV_AND_BINARY),
+                   MakeEnumAccessor (&ScdtStatsCollector::m_format),
+                   MakeEnumChecker (FORMAT_CSV, "Csv",
+                                    FORMAT_BINARY, "Binary",
+                                    FORMAT_CSV_AND_BINARY, "CsvAndBinary"))
+  ;
+  return tid;
+}
+
+ScdtStatsCollector::ScdtStatsCollector ()
+  : m_written (false),
+    m_rows (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ScdtStatsCollector::~ScdtStatsCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ScdtStatsCollector::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  Object::NotifyConstructionCompleted ();
+  // The event holds a reference: the collector outlives the servers
+  // that push into it, which are disposed of earlier in Simulator::Destroy
+  Simulator::ScheduleDestroy (&ScdtStatsCollector::Write, Ptr<ScdtStatsCollector> (this));
+}
+
+uint32_t
+ScdtStatsCollector::GetColumn (const std::string & name)
+{
+  std::map<std::string, uint32_t>::const_iterator it = m_index.find (name);
+  if (it != m_index.end ())
+    {
+      return it->second;
+    }
+  uint32_t column = m_names.size ();
+  m_names.push_back (name);
+  m_index[name] = column;
+  m_columns.push_back (std::vector<double> (m_rows, std::numeric_limits<double>::quiet_NaN ()));
+  return column;
+}
+
+uint32_t
+ScdtStatsCollector::Register (uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (this << nodeId);
+  uint32_t row = m_rows++;
+  for (uint32_t c = 0; c < m_columns.size (); c++)
+    {
+      m_columns[c].push_back (std::numeric_limits<double>::quiet_NaN ());
+    }
+  Set (row, "node", nodeId);
+  return row;
+}
+
+void
+ScdtStatsCollector::Set (uint32_t row, const std::string & column, double value)
+{
+  NS_LOG_FUNCTION (this << row << column << value);
+  NS_ASSERT_MSG (row < m_rows, "Row " << row << " was not registered");
+  m_columns[GetColumn (column)][row] = value;
+}
+
+void
+ScdtStatsCollector::Merge (const std::string & name, const ScdtLatencyHistogram & histogram)
+{
+  NS_LOG_FUNCTION (this << name << histogram.GetCount ());
+  m_histograms[name].Merge (histogram);
+}
+
+uint32_t
+ScdtStatsCollector::GetNRows (void) const
+{
+  return m_rows;
+}
+
+double
+ScdtStatsCollector::Get (uint32_t row, const std::string & column) const
+{
+  std::map<std::string, uint32_t>::const_iterator it = m_index.find (column);
+  if (it == m_index.end () || row >= m_rows)
+    {
+      return std::numeric_limits<double>::quiet_NaN ();
+    }
+  return m_columns[it->second][row];
+}
+
+ScdtLatencyHistogram
+ScdtStatsCollector::GetHistogram (const std::string & name) const
+{
+  std::map<std::string, ScdtLatencyHistogram>::const_iterator it = m_histograms.find (name);
+  return it == m_histograms.end () ? ScdtLatencyHistogram () : it->second;
+}
+
+void
+ScdtStatsCollector::Write (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_written)
+    {
+      return;
+    }
+  m_written = true;
+  if (m_format & FORMAT_CSV)
+    {
+      WriteCsv (m_fileName + ".csv");
+      WriteHistogramsCsv (m_fileName + "-histograms.csv");
+    }
+  if (m_format & FORMAT_BINARY)
+    {
+      WriteBinary (m_fileName + ".bin");
+    }
+}
+
+void
+ScdtStatsCollector::WriteCsv (const std::string & fileName) const
+{
+  std::ofstream out (fileName.c_str (), std::ios::trunc);
+  if (!out)
+    {
+      NS_LOG_ERROR ("Cannot write " << fileName);
+      return;
+    }
+  out << std::setprecision (12);
+  for (uint32_t c = 0; c < m_names.size (); c++)
+    {
+      out << (c ? "," : "") << m_names[c];
+    }
+  out << "\n";
+  for (uint32_t r = 0; r < m_rows; r++)
+    {
+      for (uint32_t c = 0; c < m_columns.size (); c++)
+        {
+          if (c)
+            {
+              out << ",";
+            }
+          // Missing values are left empty
+          if (!std::isnan (m_columns[c][r]))
+            {
+              out << m_columns[c][r];
+            }
+        }
+      out << "\n";
+    }
+  NS_LOG_INFO ("Wrote " << m_rows << " rows to " << fileName);
+}
+
+void
+ScdtStatsCollector::WriteHistogramsCsv (const std::string & fileName) const
+{
+  std::ofstream out (fileName.c_str (), std::ios::trunc);
+  if (!out)
+    {
+      NS_LOG_ERROR ("Cannot write " << fileName);
+      return;
+    }
+  out << std::setprecision (12);
+  out << "histogram,count,min,mean,p50,p90,p99,max\n";
+  for (std::map<std::string, ScdtLatencyHistogram>::const_iterator it = m_histograms.begin ();
+       it != m_histograms.end (); ++it)
+    {
+      const ScdtLatencyHistogram &h = it->second;
+      out << it->first << "," << h.GetCount ()
+          << "," << h.GetMin ().GetSeconds () << "," << h.GetMean ().GetSeconds ()
+          << "," << h.GetQuantile (0.5).GetSeconds () << "," << h.GetQuantile (0.9).GetSeconds ()
+          << "," << h.GetQuantile (0.99).GetSeconds () << "," << h.GetMax ().GetSeconds () << "\n";
+    }
+}
+
+void
+ScdtStatsCollector::WriteBinary (const std::string & fileName) const
+{
+  std::ofstream out (fileName.c_str (), std::ios::trunc | std::ios::binary);
+  if (!out)
+    {
+      NS_LOG_ERROR ("Cannot write " << fileName);
+      return;
+    }
+  out.write ("SCDT", 4);
+  WriteU32 (out, BINARY_VERSION);
+  WriteU32 (out, m_columns.size ());
+  WriteU32 (out, m_rows);
+  for (uint32_t c = 0; c < m_columns.size (); c++)
+    {
+      WriteName (out, m_names[c]);
+      if (m_rows > 0)
+        {
+          out.write (reinterpret_cast<const char *> (&m_columns[c][0]), m_rows * sizeof (double));
+        }
+    }
+  WriteU32 (out, m_histograms.size ());
+  for (std::map<std::string, ScdtLatencyHistogram>::const_iterator it = m_histograms.begin ();
+       it != m_histograms.end (); ++it)
+    {
+      const ScdtLatencyHistogram &h = it->second;
+      WriteName (out, it->first);
+      WriteDouble (out, h.GetCount ());
+      WriteDouble (out, h.GetMin ().GetSeconds ());
+      WriteDouble (out, h.GetMean ().GetSeconds ());
+      WriteDouble (out, h.GetQuantile (0.5).GetSeconds ());
+      WriteDouble (out, h.GetQuantile (0.9).GetSeconds ());
+      WriteDouble (out, h.GetQuantile (0.99).GetSeconds ());
+      WriteDouble (out, h.GetMax ().GetSeconds ());
+    }
+  NS_LOG_INFO ("Wrote " << m_columns.size () << " columns of " << m_rows << " rows to " << fileName);
+}
+
+} // namespace ns3
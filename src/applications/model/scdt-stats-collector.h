@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_STATS_COLLECTOR_H
+#define SCDT_STATS_COLLECTOR_H
+
+#include "ns3/object.h"
+#include "scdt-latency-histogram.h"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Gathers the per-node results of a session in memory and writes
+ * them once, at Simulator::Destroy.
+ *
+ * Each ScdtServer whose StatsCollector attribute points to the collector
+ * registers a row when it stops and sets its counters in named columns;
+ * its chunk latencies are merged into a histogram of the whole session.
+ * Columns are created on first use, so a row has no value (NaN) in a
+ * column it never set.
+ *
+ * The table is kept column by column and written to FileName.csv, one
+ * line per row, and/or to FileName.bin:
+ *
+ * - "SCDT" magic, then the format version, column count and row count,
+ *   each a uint32_t;
+ * - per column, its name as a uint16_t length and the characters, then
+ *   its values as doubles;
+ * - the histogram count as a uint32_t, then per histogram its name as
+ *   above and its count, min, mean, p50, p90, p99 and max as doubles,
+ *   latencies in seconds.
+ *
+ * Numbers are in host byte order.  The histograms also go to
+ * FileName-histograms.csv with the CSV output.  Files are overwritten.
+ */
+class ScdtStatsCollector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// Files written at Simulator::Destroy
+  enum Format
+  {
+    FORMAT_CSV = 1,               //!< FileName.csv and FileName-histograms.csv
+    FORMAT_BINARY = 2,            //!< FileName.bin
+    FORMAT_CSV_AND_BINARY = 3     //!< Both
+  };
+
+  ScdtStatsCollector ();
+  virtual ~ScdtStatsCollector ();
+
+  /**
+   * \brief Add a row for a node.
+   * \param nodeId the id of the node, stored in the "node" column
+   * \returns the index of the row
+   */
+  uint32_t Register (uint32_t nodeId);
+  /**
+   * \brief Set a value of a row.
+   * \param row the row, as returned by Register
+   * \param column the name of the column
+   * \param value the value
+   */
+  void Set (uint32_t row, const std::string & column, double value);
+  /**
+   * \brief Merge samples into a histogram of the session.
+   * \param name the name of the histogram
+   * \param histogram the samples
+   */
+  void Merge (const std::string & name, const ScdtLatencyHistogram & histogram);
+
+  /**
+   * \returns the number of rows
+   */
+  uint32_t GetNRows (void) const;
+  /**
+   * \param row a row
+   * \param column the name of a column
+   * \returns the value, NaN if the row has none in that column
+   */
+  double Get (uint32_t row, const std::string & column) const;
+  /**
+   * \param name the name of a histogram
+   * \returns the histogram, empty if nothing was merged into it
+   */
+  ScdtLatencyHistogram GetHistogram (const std::string & name) const;
+
+  /**
+   * \brief Write the files now rather than at Simulator::Destroy.
+   *
+   * Does nothing if they were written already.
+   */
+  void Write (void);
+
+protected:
+  virtual void NotifyConstructionCompleted (void);
+
+private:
+  /**
+   * \param name the name of a column
+   * \returns its index, the column being created if needed
+   */
+  uint32_t GetColumn (const std::string & name);
+  /**
+   * \param fileName the file to write the table to
+   */
+  void WriteCsv (const std::string & fileName) const;
+  /**
+   * \param fileName the file to write the histograms to
+   */
+  void WriteHistogramsCsv (const std::string & fileName) const;
+  /**
+   * \param fileName the file to write the table and the histograms to
+   */
+  void WriteBinary (const std::string & fileName) const;
+
+  std::string m_fileName; //!< Output file name, without extension
+  Format m_format; //!< Files to write
+  bool m_written; //!< True once the files are written
+  uint32_t m_rows; //!< Number of rows
+  std::vector<std::string> m_names; //!< Column names, in creation order
+  std::map<std::string, uint32_t> m_index; //!< Column index by name
+  std::vector<std::vector<double> > m_columns; //!< Values, column by column
+  std::map<std::string, ScdtLatencyHistogram> m_histograms; //!< Session histograms by name
+};
+
+} // namespace ns3
+
+#endif /* SCDT_STATS_COLLECTOR_H */
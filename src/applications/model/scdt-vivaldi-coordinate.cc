@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "scdt-vivaldi-coordinate.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScdtVivaldiCoordinate");
+
+namespace {
+const double CC = 0.25; //!< Fraction of the error a sample corrects the coordinate by
+const double CE = 0.25; //!< Weight of a sample in the error estimate
+const double MIN_HEIGHT = 10e-6; //!< Smallest height in seconds, so heights can grow
+} // anonymous namespace
+
+ScdtVivaldiCoordinate::ScdtVivaldiCoordinate ()
+  : m_x (0),
+    m_y (0),
+    m_height (MIN_HEIGHT),
+    m_error (1)
+{
+}
+
+Time
+ScdtVivaldiCoordinate::GetDistance (const ScdtVivaldiCoordinate & other) const
+{
+  double dx = m_x - other.m_x;
+  double dy = m_y - other.m_y;
+  return Seconds (std::sqrt (dx * dx + dy * dy) + m_height + other.m_height);
+}
+
+double
+ScdtVivaldiCoordinate::GetError (void) const
+{
+  return m_error;
+}
+
+bool
+ScdtVivaldiCoordinate::IsInitial (void) const
+{
+  return m_error >= 1;
+}
+
+void
+ScdtVivaldiCoordinate::Update (const ScdtVivaldiCoordinate & remote, Time rtt, double angle)
+{
+  NS_LOG_FUNCTION (this << remote << rtt << angle);
+  double sample = rtt.GetSeconds ();
+  if (sample <= 0)
+    {
+      return;
+    }
+  double distance = GetDistance (remote).GetSeconds ();
+
+  // Trust the sample more when we are less sure of ourselves than the peer
+  double weight = m_error + remote.m_error > 0 ? m_error / (m_error + remote.m_error) : 0.5;
+  double sampleError = std::fabs (distance - sample) / sample;
+  m_error = std::min (1.0, sampleError * CE * weight + m_error * (1 - CE * weight));
+
+  // Move along the unit vector from the peer, height included
+  double force = CC * weight * (sample - distance);
+  double dx = m_x - remote.m_x;
+  double dy = m_y - remote.m_y;
+  double length = std::sqrt (dx * dx + dy * dy) + m_height + remote.m_height;
+  if (std::sqrt (dx * dx + dy * dy) < 1e-9)
+    {
+      // Same point in the plane: pick a direction to separate along
+      dx = std::cos (angle) * length;
+      dy = std::sin (angle) * length;
+    }
+  m_x += force * dx / length;
+  m_y += force * dy / length;
+  m_height = std::max (MIN_HEIGHT, m_height + force * (m_height + remote.m_height) / length);
+}
+
+uint32_t
+ScdtVivaldiCoordinate::GetSerializedSize (void)
+{
+  return 4+4+4+2;
+}
+
+void
+ScdtVivaldiCoordinate::Serialize (Buffer::Iterator & i) const
+{
+  double limit = 2147.0; // Largest number of seconds in 32bits microseconds
+  i.WriteHtonU32 (static_cast<int32_t> (std::max (-limit, std::min (m_x, limit)) * 1e6));
+  i.WriteHtonU32 (static_cast<int32_t> (std::max (-limit, std::min (m_y, limit)) * 1e6));
+  i.WriteHtonU32 (static_cast<int32_t> (std::min (m_height, limit) * 1e6));
+  i.WriteHtonU16 (static_cast<uint16_t> (m_error * 65535 + 0.5));
+}
+
+void
+ScdtVivaldiCoordinate::Deserialize (Buffer::Iterator & i)
+{
+  m_x = static_cast<int32_t> (i.ReadNtohU32 ()) / 1e6;
+  m_y = static_cast<int32_t> (i.ReadNtohU32 ()) / 1e6;
+  m_height = std::max (MIN_HEIGHT, static_cast<int32_t> (i.ReadNtohU32 ()) / 1e6);
+  m_error = i.ReadNtohU16 () / 65535.0;
+}
+
+void
+ScdtVivaldiCoordinate::Print (std::ostream & os) const
+{
+  os << "(" << m_x << "," << m_y << " height=" << m_height << " error=" << m_error << ")";
+}
+
+std::ostream &
+operator << (std::ostream & os, const ScdtVivaldiCoordinate & coordinate)
+{
+  coordinate.Print (os);
+  return os;
+}
+
+} // namespace ns3
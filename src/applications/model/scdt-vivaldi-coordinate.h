@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SCDT_VIVALDI_COORDINATE_H
+#define SCDT_VIVALDI_COORDINATE_H
+
+#include "ns3/nstime.h"
+#include "ns3/buffer.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Vivaldi network coordinate of a node.
+ *
+ * A point in a 2D Euclidean plane plus a height modelling the access
+ * link, in seconds, so that the distance between two coordinates
+ * predicts the RTT between their nodes.  Every RTT measured to a peer
+ * whose coordinate is known moves the coordinate a step towards (or
+ * away from) the peer, weighted by the relative confidence of the two
+ * nodes (Dabek et al., "Vivaldi: a decentralized network coordinate
+ * system", SIGCOMM 2004).
+ *
+ * A new coordinate sits at the origin, with the smallest height and the
+ * largest error, 1; the error decreases as the predictions match the
+ * measurements.
+ */
+class ScdtVivaldiCoordinate
+{
+public:
+  ScdtVivaldiCoordinate ();
+
+  /**
+   * \param other the coordinate of another node
+   * \returns the RTT predicted between the two nodes
+   */
+  Time GetDistance (const ScdtVivaldiCoordinate & other) const;
+  /**
+   * \returns the relative error estimate, between 0 and 1
+   */
+  double GetError (void) const;
+  /**
+   * \returns true while the error is still the largest, as it is until
+   * the first update: the coordinate predicts nothing yet
+   */
+  bool IsInitial (void) const;
+
+  /**
+   * \brief Move the coordinate after measuring the RTT to a peer.
+   * \param remote the coordinate of the peer
+   * \param rtt the RTT measured to the peer
+   * \param angle direction, in radians, to move in if the two
+   * coordinates coincide (e.g. drawn uniformly in [0, 2 pi))
+   */
+  void Update (const ScdtVivaldiCoordinate & remote, Time rtt, double angle);
+
+  /**
+   * \returns the number of bytes written by Serialize
+   */
+  static uint32_t GetSerializedSize (void);
+  /**
+   * \brief Write the coordinate: x, y and height as signed 32bits
+   * microseconds, and the error as 16bits fraction of 1.
+   * \param i the buffer iterator, advanced past the coordinate
+   */
+  void Serialize (Buffer::Iterator & i) const;
+  /**
+   * \param i the buffer iterator, advanced past the coordinate
+   */
+  void Deserialize (Buffer::Iterator & i);
+  /**
+   * \param os the stream to print the coordinate to, in seconds
+   */
+  void Print (std::ostream & os) const;
+
+private:
+  double m_x; //!< First dimension, in seconds
+  double m_y; //!< Second dimension, in seconds
+  double m_height; //!< Height, in seconds
+  double m_error; //!< Relative error estimate
+};
+
+/**
+ * \param os the output stream
+ * \param coordinate the coordinate
+ * \returns the output stream
+ */
+std::ostream & operator << (std::ostream & os, const ScdtVivaldiCoordinate & coordinate);
+
+} // namespace ns3
+
+#endif /* SCDT_VIVALDI_COORDINATE_H */
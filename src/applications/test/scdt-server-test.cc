@@ -0,0 +1,1967 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/scdt-header.h"
+#include "ns3/scdt-probe-table.h"
+#include "ns3/scdt-latency-histogram.h"
+#include "ns3/scdt-vivaldi-coordinate.h"
+#include "ns3/scdt-admission-policy.h"
+#include "ns3/scdt-stats-collector.h"
+#include "ns3/scdt-server.h"
+#include "ns3/scdt-server-helper.h"
+#include "ns3/scdt-tree.h"
+#include "ns3/scdt-tree-snapshot-helper.h"
+#include "ns3/scdt-socket-mux.h"
+#include "ns3/scdt-endpoint.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/data-rate.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include <fstream>
+#include <cmath>
+#include <algorithm>
+#include <map>
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that the SCDT headers survive a serialization round trip
+ */
+class ScdtHeaderTestCase : public TestCase
+{
+public:
+  ScdtHeaderTestCase ();
+  virtual ~ScdtHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtHeaderTestCase::ScdtHeaderTestCase ()
+  : TestCase ("Test that the SCDT headers survive a serialization round trip")
+{
+}
+
+ScdtHeaderTestCase::~ScdtHeaderTestCase ()
+{
+}
+
+void ScdtHeaderTestCase::DoRun (void)
+{
+  ScdtVivaldiCoordinate near;
+  ScdtVivaldiCoordinate far;
+  far.Update (near, MilliSeconds (80), 0);
+  ScdtTryHeader tryHeader;
+  tryHeader.AddCandidate (InetSocketAddress (Ipv4Address ("10.1.0.1"), 9), near);
+  tryHeader.AddCandidate (InetSocketAddress (Ipv4Address ("10.2.0.1"), 10), far, 3, MilliSeconds (120));
+
+  ScdtHeader header;
+  header.SetType (ScdtHeader::TRY);
+  header.SetSeq (42);
+  header.SetTs (MilliSeconds (1234));
+  header.SetGroupId (7);
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (tryHeader);
+  p->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), header.GetSerializedSize () + 1 + 2 * (6 + ScdtVivaldiCoordinate::GetSerializedSize () + 6),
+                         "Unexpected serialized size");
+
+  ScdtHeader rxHeader;
+  p->RemoveHeader (rxHeader);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxHeader.GetType ()), ScdtHeader::TRY, "Type mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxHeader.GetSeq (), 42, "Sequence number mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxHeader.GetTs (), MilliSeconds (1234), "Time stamp mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxHeader.GetGroupId (), 7, "Group id mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxHeader.GetLength (), 0, "Default payload length mismatch");
+
+  ScdtTryHeader rxTry;
+  p->RemoveHeader (rxTry);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxTry.GetNCandidates ()), 2, "Candidate count mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxTry.GetCandidate (1).GetIpv4 (), Ipv4Address ("10.2.0.1"), "Candidate address mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxTry.GetCandidate (1).GetPort (), 10, "Candidate port mismatch");
+  // Coordinates travel with microsecond precision
+  NS_TEST_ASSERT_MSG_EQ_TOL (rxTry.GetCandidateCoordinate (1).GetDistance (rxTry.GetCandidateCoordinate (0)).GetSeconds (),
+                             far.GetDistance (near).GetSeconds (), 5e-6, "Candidate coordinate mismatch");
+  NS_TEST_ASSERT_MSG_EQ_TOL (rxTry.GetCandidateCoordinate (1).GetError (), far.GetError (), 1e-4, "Candidate error mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxTry.GetCandidateDepth (0), 0, "Default candidate depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxTry.GetCandidateDepth (1), 3, "Candidate depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxTry.GetCandidateLatency (1), MilliSeconds (120), "Candidate root latency mismatch");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 0, "Payload left over");
+
+  ScdtProbeTrainHeader train;
+  train.SetLength (4);
+  train.SetPacketSize (1000);
+  p = Create<Packet> ();
+  p->AddHeader (train);
+  ScdtProbeTrainHeader rxTrain;
+  p->RemoveHeader (rxTrain);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxTrain.GetLength ()), 4, "Train length mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxTrain.GetPacketSize (), 1000, "Train packet size mismatch");
+
+  // Known and unknown stream delays, as a PING_RESP carries them
+  ScdtStreamDelayHeader delay;
+  delay.SetDelay (MilliSeconds (85));
+  ScdtStreamDelayHeader unknown;
+  p = Create<Packet> ();
+  p->AddHeader (unknown);
+  p->AddHeader (delay);
+  ScdtStreamDelayHeader rxDelay;
+  p->RemoveHeader (rxDelay);
+  NS_TEST_ASSERT_MSG_EQ (rxDelay.GetDelay (), MilliSeconds (85), "Stream delay mismatch");
+  p->RemoveHeader (rxDelay);
+  NS_TEST_ASSERT_MSG_EQ (rxDelay.GetDelay (), Time::Max (), "Unknown stream delay not kept");
+
+  // Load of a member, as a HEARTBEAT to its parent carries it
+  ScdtMemberHeader member;
+  member.SetFanout (6);
+  member.SetSubtreeSize (70000);
+  member.SetFreeSlots (2);
+  p = Create<Packet> ();
+  p->AddHeader (member);
+  ScdtMemberHeader rxMember;
+  p->RemoveHeader (rxMember);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxMember.GetFanout ()), 6, "Fan-out mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxMember.GetSubtreeSize (), 70000, "Subtree size mismatch");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxMember.GetFreeSlots ()), 2, "Free slots mismatch");
+
+  // Position ahead of the ancestors, as an ATTACH_SUC carries it
+  ScdtPositionHeader position;
+  position.SetDepth (4);
+  position.SetLatency (MicroSeconds (73500));
+  ScdtTryHeader ancestors;
+  ancestors.AddCandidate (InetSocketAddress (Ipv4Address ("10.3.0.1"), 9));
+  p = Create<Packet> ();
+  p->AddHeader (ancestors);
+  p->AddHeader (position);
+  ScdtPositionHeader rxPosition;
+  p->RemoveHeader (rxPosition);
+  NS_TEST_ASSERT_MSG_EQ (rxPosition.GetDepth (), 4, "Depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (rxPosition.GetLatency (), MicroSeconds (73500), "Root latency mismatch");
+  p->RemoveHeader (rxTry);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxTry.GetNCandidates ()), 1, "Ancestors not found after the position");
+
+  // A PING and a HEARTBEAT sharing a datagram, each header announcing
+  // the length of its own payload
+  ScdtHeader ping;
+  ping.SetType (ScdtHeader::PING);
+  Ptr<Packet> datagram = Create<Packet> ();
+  datagram->AddHeader (ping);
+  ScdtHeader heartbeat;
+  heartbeat.SetType (ScdtHeader::HEARTBEAT);
+  heartbeat.SetLength (member.GetSerializedSize ());
+  p = Create<Packet> ();
+  p->AddHeader (member);
+  p->AddHeader (heartbeat);
+  datagram->AddAtEnd (p);
+  NS_TEST_ASSERT_MSG_EQ (datagram->GetSize (), 2 * header.GetSerializedSize () + member.GetSerializedSize (),
+                         "Unexpected aggregated size");
+  datagram->RemoveHeader (rxHeader);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxHeader.GetType ()), ScdtHeader::PING, "First message type mismatch");
+  datagram->RemoveAtStart (rxHeader.GetLength ());
+  datagram->RemoveHeader (rxHeader);
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (rxHeader.GetType ()), ScdtHeader::HEARTBEAT, "Second message not found after the first");
+  NS_TEST_ASSERT_MSG_EQ (rxHeader.GetLength (), datagram->GetSize (), "Second message length mismatch");
+  datagram->RemoveHeader (rxMember);
+  NS_TEST_ASSERT_MSG_EQ (rxMember.GetSubtreeSize (), 70000, "Piggybacked subtree size mismatch");
+
+  // Two chunks back to back on a byte stream
+  ScdtChunkHeader chunkHeader;
+  chunkHeader.SetLength (10);
+  Ptr<Packet> stream = Create<Packet> (10);
+  stream->AddHeader (chunkHeader);
+  Ptr<Packet> second = Create<Packet> (3);
+  chunkHeader.SetLength (3);
+  second->AddHeader (chunkHeader);
+  stream->AddAtEnd (second);
+  uint32_t firstSize = chunkHeader.GetSerializedSize () + 10;
+  Ptr<Packet> tail = stream->CreateFragment (firstSize, stream->GetSize () - firstSize);
+  NS_TEST_ASSERT_MSG_EQ (stream->GetSize (), 2 * chunkHeader.GetSerializedSize () + 13, "Unexpected framed size");
+
+  ScdtChunkHeader rxChunk;
+  stream->RemoveHeader (rxChunk);
+  NS_TEST_ASSERT_MSG_EQ (rxChunk.GetLength (), 10, "First chunk length mismatch");
+  stream->RemoveAtStart (rxChunk.GetLength ());
+  tail->PeekHeader (rxChunk);
+  NS_TEST_ASSERT_MSG_EQ (rxChunk.GetLength (), 3, "Second chunk not found after the first");
+  stream->RemoveHeader (rxChunk);
+  NS_TEST_ASSERT_MSG_EQ (rxChunk.GetLength (), 3, "Second chunk length mismatch");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that ScdtProbeTable matches answers by endpoint and sequence
+ * number and expires unanswered probes
+ */
+class ScdtProbeTableTestCase : public TestCase
+{
+public:
+  ScdtProbeTableTestCase ();
+  virtual ~ScdtProbeTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtProbeTableTestCase::ScdtProbeTableTestCase ()
+  : TestCase ("Test that ScdtProbeTable matches answers by endpoint and sequence number and expires unanswered probes")
+{
+}
+
+ScdtProbeTableTestCase::~ScdtProbeTableTestCase ()
+{
+}
+
+void ScdtProbeTableTestCase::DoRun (void)
+{
+  InetSocketAddress a (Ipv4Address ("10.1.0.1"), 9);
+  InetSocketAddress b (Ipv4Address ("10.2.0.1"), 9);
+  ScdtProbeTable table;
+  table.Insert (a, 1, Seconds (1), ScdtProbeTable::CHILD_PROBE);
+  table.Insert (a, 2, Seconds (2), ScdtProbeTable::PARENT_PROBE);
+  table.Insert (b, 3, Seconds (3), ScdtProbeTable::CHILD_PROBE);
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 3, "Probes not recorded");
+
+  ScdtProbeTable::Probe probe;
+  NS_TEST_ASSERT_MSG_EQ (table.Remove (b, 2, probe), false, "Answer matched to another endpoint's probe");
+  NS_TEST_ASSERT_MSG_EQ (table.Remove (a, 2, probe), true, "Answer not matched");
+  NS_TEST_ASSERT_MSG_EQ (probe.sent, Seconds (2), "Answer matched to the wrong probe");
+  NS_TEST_ASSERT_MSG_EQ (probe.kind, ScdtProbeTable::PARENT_PROBE, "Probe kind lost");
+  NS_TEST_ASSERT_MSG_EQ (table.Remove (a, 2, probe), false, "Duplicate answer matched twice");
+
+  NS_TEST_ASSERT_MSG_EQ (table.Expire (Seconds (2.5)), 1, "Expected one probe to expire");
+  NS_TEST_ASSERT_MSG_EQ (table.Remove (a, 1, probe), false, "Expired probe still matched");
+  NS_TEST_ASSERT_MSG_EQ (table.Remove (b, 3, probe), true, "Live probe expired");
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 0, "Probes left over");
+}
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that ScdtLatencyHistogram quantiles stay within one bucket of
+ * the exact values
+ */
+class ScdtLatencyHistogramTestCase : public TestCase
+{
+public:
+  ScdtLatencyHistogramTestCase ();
+  virtual ~ScdtLatencyHistogramTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtLatencyHistogramTestCase::ScdtLatencyHistogramTestCase ()
+  : TestCase ("Test that ScdtLatencyHistogram quantiles stay within one bucket of the exact values")
+{
+}
+
+ScdtLatencyHistogramTestCase::~ScdtLatencyHistogramTestCase ()
+{
+}
+
+void ScdtLatencyHistogramTestCase::DoRun (void)
+{
+  ScdtLatencyHistogram histogram;
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetQuantile (0.5), Time (0), "Empty histogram has a median");
+
+  for (uint32_t ms = 1000; ms >= 1; ms--)
+    {
+      histogram.Add (MilliSeconds (ms));
+    }
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetCount (), 1000, "Samples lost");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetMin (), MilliSeconds (1), "Wrong minimum");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetMax (), MilliSeconds (1000), "Wrong maximum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (histogram.GetMean ().GetSeconds (), 0.5005, 1e-9, "Wrong mean");
+
+  // Quantiles are bucket upper bounds: never below, at most 12.5% above
+  NS_TEST_ASSERT_MSG_EQ_TOL (histogram.GetQuantile (0.5).GetSeconds (), 0.53125, 0.03125, "Wrong p50");
+  NS_TEST_ASSERT_MSG_EQ_TOL (histogram.GetQuantile (0.9).GetSeconds (), 0.95625, 0.05625, "Wrong p90");
+  NS_TEST_ASSERT_MSG_EQ_TOL (histogram.GetQuantile (0.99).GetSeconds (), 0.995, 0.005, "Wrong p99");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetQuantile (1), MilliSeconds (1000), "p100 is not the maximum");
+
+  histogram.Add (MilliSeconds (-5));
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetMin (), Time (0), "Negative sample not counted as zero");
+
+  ScdtLatencyHistogram merged;
+  merged.Add (MilliSeconds (2000));
+  merged.Merge (histogram);
+  NS_TEST_ASSERT_MSG_EQ (merged.GetCount (), 1002, "Samples lost in Merge");
+  NS_TEST_ASSERT_MSG_EQ (merged.GetMin (), Time (0), "Wrong merged minimum");
+  NS_TEST_ASSERT_MSG_EQ (merged.GetMax (), MilliSeconds (2000), "Wrong merged maximum");
+  NS_TEST_ASSERT_MSG_EQ_TOL (merged.GetQuantile (0.5).GetSeconds (), 0.53125, 0.03125, "Wrong merged p50");
+
+  histogram.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetCount (), 0, "Samples left after Reset");
+  histogram.Add (NanoSeconds (7));
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetQuantile (0.5), NanoSeconds (7), "Small values are not exact");
+}
+
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that ScdtVivaldiCoordinate converges to predict the RTTs it is
+ * updated with
+ */
+class ScdtVivaldiCoordinateTestCase : public TestCase
+{
+public:
+  ScdtVivaldiCoordinateTestCase ();
+  virtual ~ScdtVivaldiCoordinateTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtVivaldiCoordinateTestCase::ScdtVivaldiCoordinateTestCase ()
+  : TestCase ("Test that ScdtVivaldiCoordinate converges to predict the RTTs it is updated with")
+{
+}
+
+ScdtVivaldiCoordinateTestCase::~ScdtVivaldiCoordinateTestCase ()
+{
+}
+
+void ScdtVivaldiCoordinateTestCase::DoRun (void)
+{
+  // RTTs in ms between four nodes, embeddable in a plane with heights
+  const uint32_t n = 4;
+  double rtt[n][n] = {
+    { 0, 10, 30, 50 },
+    { 10, 0, 20, 45 },
+    { 30, 20, 0, 30 },
+    { 50, 45, 30, 0 },
+  };
+  ScdtVivaldiCoordinate nodes[n];
+  NS_TEST_ASSERT_MSG_EQ (nodes[0].IsInitial (), true, "New coordinate is trusted");
+
+  double angle = 0;
+  for (uint32_t round = 0; round < 200; round++)
+    {
+      for (uint32_t i = 0; i < n; i++)
+        {
+          for (uint32_t j = 0; j < n; j++)
+            {
+              if (i != j)
+                {
+                  nodes[i].Update (nodes[j], MilliSeconds (rtt[i][j]), angle);
+                  angle += 1.3;
+                }
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (nodes[i].IsInitial (), false, "Coordinate still untrusted after updates");
+      NS_TEST_ASSERT_MSG_LT (nodes[i].GetError (), 0.2, "Error estimate did not drop");
+      for (uint32_t j = 0; j < n; j++)
+        {
+          if (i != j)
+            {
+              NS_TEST_ASSERT_MSG_EQ_TOL (nodes[i].GetDistance (nodes[j]).GetSeconds () * 1000, rtt[i][j],
+                                         0.15 * rtt[i][j], "Predicted RTT too far off");
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test the decisions of the ScdtAdmissionPolicy implementations on a
+ * full node
+ */
+class ScdtAdmissionPolicyTestCase : public TestCase
+{
+public:
+  ScdtAdmissionPolicyTestCase ();
+  virtual ~ScdtAdmissionPolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtAdmissionPolicyTestCase::ScdtAdmissionPolicyTestCase ()
+  : TestCase ("Test the decisions of the ScdtAdmissionPolicy implementations on a full node")
+{
+}
+
+ScdtAdmissionPolicyTestCase::~ScdtAdmissionPolicyTestCase ()
+{
+}
+
+static ScdtAdmissionPolicy::Member
+MakeMember (double rttMs, uint8_t fanout, uint32_t subtree)
+{
+  ScdtAdmissionPolicy::Member member;
+  member.rtt = MilliSeconds (rttMs);
+  member.fanout = fanout;
+  member.subtree = subtree;
+  return member;
+}
+
+void ScdtAdmissionPolicyTestCase::DoRun (void)
+{
+  // Child 1 is the farthest, child 2 the only leaf, child 0 the widest
+  std::vector<ScdtAdmissionPolicy::Member> children;
+  children.push_back (MakeMember (20, 8, 5));
+  children.push_back (MakeMember (40, 2, 3));
+  children.push_back (MakeMember (30, 2, 1));
+
+  Ptr<ScdtAdmissionPolicy> policy = CreateObject<ScdtLowestRttAdmissionPolicy> ();
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (35, 2, 1), children), 1,
+                         "Lowest RTT must evict the farthest child, not the closest");
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (45, 2, 1), children), ScdtAdmissionPolicy::REDIRECT,
+                         "Lowest RTT evicted for a farther joiner");
+
+  policy = CreateObject<ScdtDepthBalancedAdmissionPolicy> ();
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (50, 2, 4), children), 2,
+                         "Depth balanced must evict the leaf for a larger subtree");
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (25, 2, 1), children), 2,
+                         "Depth balanced must evict a farther leaf for a closer one");
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (35, 2, 1), children), ScdtAdmissionPolicy::REDIRECT,
+                         "Depth balanced evicted a closer leaf");
+
+  // Scores: 2.5, 20 and 15ms per child slot
+  policy = CreateObject<ScdtBandwidthWeightedAdmissionPolicy> ();
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (60, 4, 1), children), 1,
+                         "Bandwidth weighted must evict the worst score for a wider joiner");
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (60, 2, 1), children), ScdtAdmissionPolicy::REDIRECT,
+                         "Bandwidth weighted evicted for a worse score");
+
+  policy = CreateObject<ScdtNeverEvictAdmissionPolicy> ();
+  NS_TEST_ASSERT_MSG_EQ (policy->SelectEviction (MakeMember (1, 255, 100), children), ScdtAdmissionPolicy::REDIRECT,
+                         "Never evict evicted");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that ScdtStatsCollector keeps sparse columns apart and writes
+ * them as CSV
+ */
+class ScdtStatsCollectorTestCase : public TestCase
+{
+public:
+  ScdtStatsCollectorTestCase ();
+  virtual ~ScdtStatsCollectorTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtStatsCollectorTestCase::ScdtStatsCollectorTestCase ()
+  : TestCase ("Test that ScdtStatsCollector keeps sparse columns apart and writes them as CSV")
+{
+}
+
+ScdtStatsCollectorTestCase::~ScdtStatsCollectorTestCase ()
+{
+}
+
+void ScdtStatsCollectorTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("scdt-stats");
+  Ptr<ScdtStatsCollector> stats = CreateObjectWithAttributes<ScdtStatsCollector> (
+    "FileName", StringValue (fileName),
+    "Format", EnumValue (ScdtStatsCollector::FORMAT_CSV));
+
+  // The root never receives a chunk, so it has no lastChunk
+  uint32_t root = stats->Register (0);
+  stats->Set (root, "children", 2);
+  uint32_t leaf = stats->Register (5);
+  stats->Set (leaf, "lastChunk", 61.5);
+  stats->Set (leaf, "children", 0);
+  ScdtLatencyHistogram latency;
+  latency.Add (MilliSeconds (30));
+  stats->Merge ("chunkLatency", latency);
+  stats->Merge ("chunkLatency", latency);
+
+  NS_TEST_ASSERT_MSG_EQ (stats->GetNRows (), 2, "Row count mismatch");
+  NS_TEST_ASSERT_MSG_EQ (stats->Get (leaf, "node"), 5, "Node id not recorded");
+  NS_TEST_ASSERT_MSG_EQ (stats->Get (leaf, "lastChunk"), 61.5, "Value mismatch");
+  NS_TEST_ASSERT_MSG_EQ (std::isnan (stats->Get (root, "lastChunk")), true, "Unset value is not NaN");
+  NS_TEST_ASSERT_MSG_EQ (std::isnan (stats->Get (root, "unknown")), true, "Unknown column is not NaN");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetHistogram ("chunkLatency").GetCount (), 2, "Histogram samples lost");
+
+  stats->Write ();
+  std::ifstream in ((fileName + ".csv").c_str ());
+  std::string line;
+  std::getline (in, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "node,children,lastChunk", "CSV header mismatch");
+  std::getline (in, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "0,2,", "Missing value not left empty");
+  std::getline (in, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "5,0,61.5", "CSV row mismatch");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that ScdtEndpoint compares and sorts by address then port, and
+ * only ever matches IPv4 socket addresses
+ */
+class ScdtEndpointTestCase : public TestCase
+{
+public:
+  ScdtEndpointTestCase ();
+  virtual ~ScdtEndpointTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+ScdtEndpointTestCase::ScdtEndpointTestCase ()
+  : TestCase ("Test that ScdtEndpoint compares and sorts by address then port, and only ever matches IPv4 socket addresses")
+{
+}
+
+ScdtEndpointTestCase::~ScdtEndpointTestCase ()
+{
+}
+
+void ScdtEndpointTestCase::DoRun (void)
+{
+  InetSocketAddress inet (Ipv4Address ("10.1.0.1"), 9);
+  Address address = inet;
+  ScdtEndpoint a (inet);
+  ScdtEndpoint sameA (address);
+  ScdtEndpoint otherPort (InetSocketAddress (Ipv4Address ("10.1.0.1"), 10));
+  ScdtEndpoint otherIp (InetSocketAddress (Ipv4Address ("10.2.0.1"), 1));
+
+  NS_TEST_ASSERT_MSG_EQ (a.GetIpv4 (), Ipv4Address ("10.1.0.1"), "Address lost");
+  NS_TEST_ASSERT_MSG_EQ (a.GetPort (), 9, "Port lost");
+  NS_TEST_ASSERT_MSG_EQ ((a == sameA), true, "Same endpoint through an Address not equal");
+  NS_TEST_ASSERT_MSG_EQ ((a != otherPort), true, "Endpoints differing by port equal");
+  NS_TEST_ASSERT_MSG_EQ ((a != otherIp), true, "Endpoints differing by address equal");
+  NS_TEST_ASSERT_MSG_EQ ((ScdtEndpoint (Address (a)) == a), true, "Address round trip changed the endpoint");
+
+  // Address first, port only to break ties
+  NS_TEST_ASSERT_MSG_EQ ((a < otherPort), true, "Lower port not sorted first");
+  NS_TEST_ASSERT_MSG_EQ ((otherPort < otherIp), true, "Lower address not sorted first despite its port");
+  NS_TEST_ASSERT_MSG_EQ ((otherIp < a), false, "Higher address sorted first");
+  NS_TEST_ASSERT_MSG_EQ ((a < sameA) || (sameA < a), false, "Equal endpoints ordered");
+
+  // Building an endpoint from anything but an InetSocketAddress asserts;
+  // comparing with one is allowed and never matches
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (inet), true, "Own address not matched");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (InetSocketAddress (Ipv4Address ("10.1.0.1"), 10)), false, "Other port matched");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (Inet6SocketAddress (Ipv6Address ("2001:db8::1"), 9)), false, "IPv6 address matched");
+  NS_TEST_ASSERT_MSG_EQ (a.IsEqual (Mac48Address ("00:00:00:00:00:01")), false, "MAC address matched");
+}
+
+/**
+ * Connect two nodes with a SimpleNetDevice link on the next subnet of
+ * the address helper.  The devices run in point-to-point mode, which
+ * needs no ARP, so an error model only ever drops SCDT traffic.
+ *
+ * \param a the first end of the link
+ * \param b the second end of the link
+ * \param address the helper handing out the subnet of the link
+ * \param rate the rate both ends send at, 0 for no limit
+ * \returns the interfaces of a and b, in that order
+ */
+static Ipv4InterfaceContainer
+ConnectNodes (Ptr<Node> a, Ptr<Node> b, Ipv4AddressHelper &address, DataRate rate = DataRate (0))
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (5)));
+  NetDeviceContainer devices;
+  Ptr<Node> ends[] = { a, b };
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetAttribute ("PointToPointMode", BooleanValue (true));
+      if (rate.GetBitRate () > 0)
+        {
+          device->SetAttribute ("DataRate", DataRateValue (rate));
+        }
+      ends[i]->AddDevice (device);
+      device->SetChannel (channel);
+      devices.Add (device);
+    }
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  address.NewNetwork ();
+  return interfaces;
+}
+
+/**
+ * Put nodes on one SimpleChannel, on one subnet, each reaching every
+ * other directly.
+ *
+ * \param nodes the nodes
+ * \param address the helper handing out the subnet
+ * \returns the interfaces of the nodes, in the same order
+ */
+static Ipv4InterfaceContainer
+ConnectLan (NodeContainer nodes, Ipv4AddressHelper &address)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (5)));
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      nodes.Get (i)->AddDevice (device);
+      device->SetChannel (channel);
+      devices.Add (device);
+    }
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  address.NewNetwork ();
+  return interfaces;
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that joiners behind lossy links to the root all attach before
+ * their ATTACH retries and backoffs run out
+ */
+class ScdtLossyAttachTestCase : public TestCase
+{
+public:
+  ScdtLossyAttachTestCase ();
+  virtual ~ScdtLossyAttachTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Count a datagram the error model dropped on its way to the root
+   * \param packet the dropped packet
+   */
+  void RootRxDrop (Ptr<const Packet> packet);
+
+  uint32_t m_rootDrops; //!< Datagrams lost on the way to the root
+};
+
+ScdtLossyAttachTestCase::ScdtLossyAttachTestCase ()
+  : TestCase ("Test that joiners behind lossy links to the root all attach before their retries run out"),
+    m_rootDrops (0)
+{
+}
+
+ScdtLossyAttachTestCase::~ScdtLossyAttachTestCase ()
+{
+}
+
+void
+ScdtLossyAttachTestCase::RootRxDrop (Ptr<const Packet> packet)
+{
+  m_rootDrops++;
+}
+
+void ScdtLossyAttachTestCase::DoRun (void)
+{
+  const uint32_t joiners = 4;
+  const Time probeTimeout = MilliSeconds (100);
+  const uint32_t probeRetries = 5;
+
+  NodeContainer root;
+  root.Create (1);
+  NodeContainer nodes;
+  nodes.Create (joiners);
+  InternetStackHelper internet;
+  internet.Install (root);
+  internet.Install (nodes);
+
+  // One link per joiner, each losing a fifth of what reaches the root:
+  // the ATTACHes and the answers to the PINGs probing the joiner
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.252");
+  std::vector<Address> rootIps;
+  for (uint32_t i = 0; i < joiners; i++)
+    {
+      Ipv4InterfaceContainer link = ConnectNodes (root.Get (0), nodes.Get (i), address);
+      rootIps.push_back (link.GetAddress (0));
+      Ptr<RateErrorModel> loss = CreateObject<RateErrorModel> ();
+      loss->SetUnit (RateErrorModel::ERROR_UNIT_PACKET);
+      loss->SetRate (0.2);
+      loss->AssignStreams (i);
+      Ptr<NetDevice> device = link.Get (0).first->GetNetDevice (link.Get (0).second);
+      device->SetAttribute ("ReceiveErrorModel", PointerValue (loss));
+      device->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&ScdtLossyAttachTestCase::RootRxDrop, this));
+    }
+
+  // No stream and no heartbeats: only the join is under test
+  ScdtServerHelper rootHelper (rootIps[0], 9, 1);
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (60)));
+  rootHelper.SetAttribute ("HeartbeatInterval", TimeValue (Seconds (0)));
+  ApplicationContainer rootApps = rootHelper.Install (root.Get (0));
+  rootApps.Start (Seconds (1.0));
+  rootApps.Stop (Seconds (20.0));
+
+  // Each joiner reaches the root through its own link
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < joiners; i++)
+    {
+      ScdtServerHelper helper (rootIps[i], 9, 0);
+      helper.SetAttribute ("ProbeTimeout", TimeValue (probeTimeout));
+      helper.SetAttribute ("ProbeRetries", UintegerValue (probeRetries));
+      helper.SetAttribute ("HeartbeatInterval", TimeValue (Seconds (0)));
+      apps.Add (helper.Install (nodes.Get (i)));
+    }
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (20.0));
+
+  Simulator::Run ();
+
+  // The last retry times out after the sum of all the backoffs, each
+  // twice the previous one
+  Time bound = probeTimeout * static_cast<int64_t> ((1 << (probeRetries + 1)) - 1);
+  NS_TEST_ASSERT_MSG_GT (m_rootDrops, 0, "The error model dropped nothing");
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    {
+      Ptr<ScdtServer> server = apps.Get (i)->GetObject<ScdtServer> ();
+      NS_TEST_ASSERT_MSG_EQ (server->IsAttached (), true, "Joiner " << i << " never attached");
+      NS_TEST_ASSERT_MSG_LT (server->GetJoinLatency (), bound, "Joiner " << i << " attached after its retries ran out");
+    }
+  NS_TEST_ASSERT_MSG_EQ (rootApps.Get (0)->GetObject<ScdtServer> ()->GetNChildren (), joiners,
+                         "The root lost track of a child");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test what each ChildQueuePolicy does to the stream of a leaf behind a
+ * link slower than the stream
+ */
+class ScdtChildQueuePolicyTestCase : public TestCase
+{
+public:
+  ScdtChildQueuePolicyTestCase ();
+  virtual ~ScdtChildQueuePolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Stream from a root through a relay to a leaf behind a slow link
+   * \param policy the ChildQueuePolicy of every node
+   */
+  void RunPolicy (ScdtServer::QueuePolicy policy);
+  /**
+   * Record a chunk received by the leaf
+   * \param seq the sequence number of the chunk
+   * \param latency the latency of the chunk
+   */
+  void LeafChunkRx (uint32_t seq, Time latency);
+  /**
+   * Record chunks dropped by the relay
+   * \param child the child they were queued for
+   * \param chunks the number of chunks dropped
+   */
+  void RelayQueueDrop (const Address & child, uint32_t chunks);
+  /**
+   * Record chunks dropped by the root
+   * \param child the child they were queued for
+   * \param chunks the number of chunks dropped
+   */
+  void RootQueueDrop (const Address & child, uint32_t chunks);
+
+  uint32_t m_received; //!< Chunks received by the leaf
+  uint32_t m_nextSeq; //!< Sequence number the leaf expects next
+  uint32_t m_gaps; //!< Chunks the leaf never got before a later one
+  uint32_t m_relayDrops; //!< Chunks dropped by the relay
+  uint32_t m_relayDropEvents; //!< Times the queue of the relay overflowed
+  uint32_t m_rootDrops; //!< Chunks dropped by the root
+  uint32_t m_chunks; //!< Chunks streamed by the root
+  uint32_t m_queueSize; //!< ChildQueueSize of every node
+};
+
+ScdtChildQueuePolicyTestCase::ScdtChildQueuePolicyTestCase ()
+  : TestCase ("Test what each ChildQueuePolicy does to the stream of a leaf behind a slow link"),
+    m_received (0),
+    m_nextSeq (0),
+    m_gaps (0),
+    m_relayDrops (0),
+    m_relayDropEvents (0),
+    m_rootDrops (0),
+    m_chunks (300),
+    m_queueSize (8)
+{
+}
+
+ScdtChildQueuePolicyTestCase::~ScdtChildQueuePolicyTestCase ()
+{
+}
+
+void
+ScdtChildQueuePolicyTestCase::LeafChunkRx (uint32_t seq, Time latency)
+{
+  m_received++;
+  if (seq > m_nextSeq)
+    {
+      m_gaps += seq - m_nextSeq;
+    }
+  m_nextSeq = std::max (m_nextSeq, seq + 1);
+}
+
+void
+ScdtChildQueuePolicyTestCase::RelayQueueDrop (const Address & child, uint32_t chunks)
+{
+  m_relayDrops += chunks;
+  m_relayDropEvents++;
+}
+
+void
+ScdtChildQueuePolicyTestCase::RootQueueDrop (const Address & child, uint32_t chunks)
+{
+  m_rootDrops += chunks;
+}
+
+void
+ScdtChildQueuePolicyTestCase::RunPolicy (ScdtServer::QueuePolicy policy)
+{
+  // 10kB chunks at 4Mbps towards a leaf reached at 1Mbps: the TCP send
+  // buffer of the relay fills within a second, then its queue
+  const uint32_t chunkSize = 10000;
+  m_received = 0;
+  m_nextSeq = 0;
+  m_gaps = 0;
+  m_relayDrops = 0;
+  m_relayDropEvents = 0;
+  m_rootDrops = 0;
+
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer upper = ConnectNodes (nodes.Get (0), nodes.Get (1), address);
+  Ipv4InterfaceContainer lower = ConnectNodes (nodes.Get (1), nodes.Get (2), address, DataRate ("1Mbps"));
+
+  // The relay is known by its address towards the root, which is where
+  // its packets to the root come from
+  ScdtTree tree;
+  tree.SetRoot (upper.GetAddress (0));
+  tree.Add (upper.GetAddress (1), upper.GetAddress (0), MilliSeconds (10));
+  tree.Add (lower.GetAddress (1), upper.GetAddress (1), MilliSeconds (10));
+
+  ScdtServerHelper rootHelper (upper.GetAddress (0), 9, 1);
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("4Mbps")));
+  rootHelper.SetAttribute ("StreamBytes", UintegerValue (static_cast<uint64_t> (m_chunks) * chunkSize));
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (1.0)));
+  ScdtServerHelper memberHelper (upper.GetAddress (0), 9, 0);
+  ScdtServerHelper *helpers[] = { &rootHelper, &memberHelper };
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      helpers[k]->SetAttribute ("PacketSize", UintegerValue (chunkSize));
+      helpers[k]->SetAttribute ("ChildQueueSize", UintegerValue (m_queueSize));
+      helpers[k]->SetAttribute ("ChildQueuePolicy", EnumValue (policy));
+      helpers[k]->SetAttribute ("HeartbeatInterval", TimeValue (Seconds (0)));
+      helpers[k]->SetTree (tree);
+    }
+  ApplicationContainer apps = rootHelper.Install (nodes.Get (0));
+  apps.Add (memberHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+  // Listening before the parent connects
+  apps.Get (2)->SetStartTime (Seconds (1.0));
+  apps.Get (1)->SetStartTime (Seconds (1.1));
+  apps.Get (0)->SetStartTime (Seconds (1.2));
+  apps.Stop (Seconds (60.0));
+  apps.Get (0)->TraceConnectWithoutContext ("ChildQueueDrop", MakeCallback (&ScdtChildQueuePolicyTestCase::RootQueueDrop, this));
+  apps.Get (1)->TraceConnectWithoutContext ("ChildQueueDrop", MakeCallback (&ScdtChildQueuePolicyTestCase::RelayQueueDrop, this));
+  apps.Get (2)->TraceConnectWithoutContext ("ChunkRx", MakeCallback (&ScdtChildQueuePolicyTestCase::LeafChunkRx, this));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void ScdtChildQueuePolicyTestCase::DoRun (void)
+{
+  RunPolicy (ScdtServer::QUEUE_BLOCK);
+  NS_TEST_ASSERT_MSG_EQ (m_relayDrops + m_rootDrops, 0, "Block dropped chunks");
+  NS_TEST_ASSERT_MSG_EQ (m_received, m_chunks, "Block lost chunks");
+  NS_TEST_ASSERT_MSG_EQ (m_gaps, 0, "Block left a gap in the sequence numbers");
+
+  RunPolicy (ScdtServer::QUEUE_DROP_OLDEST);
+  NS_TEST_ASSERT_MSG_EQ (m_rootDrops, 0, "The root fell behind a fast link");
+  NS_TEST_ASSERT_MSG_GT (m_relayDrops, 0, "DropOldest dropped nothing for the slow leaf");
+  NS_TEST_ASSERT_MSG_EQ (m_relayDrops, m_relayDropEvents, "DropOldest dropped more than one chunk at a time");
+  NS_TEST_ASSERT_MSG_EQ (m_gaps, m_relayDrops, "The gaps at the leaf are not the chunks dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_nextSeq, m_chunks, "The end of the stream never reached the leaf");
+  NS_TEST_ASSERT_MSG_EQ (m_received + m_gaps, m_chunks, "Chunks missing besides the dropped ones");
+
+  RunPolicy (ScdtServer::QUEUE_SKIP_TO_LATEST);
+  NS_TEST_ASSERT_MSG_EQ (m_rootDrops, 0, "The root fell behind a fast link");
+  NS_TEST_ASSERT_MSG_GT (m_relayDrops, 0, "SkipToLatest dropped nothing for the slow leaf");
+  NS_TEST_ASSERT_MSG_EQ (m_relayDrops, m_relayDropEvents * m_queueSize, "SkipToLatest did not drop a full queue at a time");
+  NS_TEST_ASSERT_MSG_EQ (m_gaps, m_relayDrops, "The gaps at the leaf are not the chunks dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_nextSeq, m_chunks, "The end of the stream never reached the leaf");
+  NS_TEST_ASSERT_MSG_EQ (m_received + m_gaps, m_chunks, "Chunks missing besides the dropped ones");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that a relay blocked by a slow child under ChildQueuePolicy
+ * Block reads from its parent again once that child is removed
+ */
+class ScdtBlockedChildRemovalTestCase : public TestCase
+{
+public:
+  ScdtBlockedChildRemovalTestCase ();
+  virtual ~ScdtBlockedChildRemovalTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a chunk received by the fast leaf
+   * \param seq the sequence number of the chunk
+   * \param latency the latency of the chunk
+   */
+  void LeafChunkRx (uint32_t seq, Time latency);
+  /**
+   * Record the depth of a child queue of the relay
+   * \param child the child of the queue
+   * \param depth the chunks in the queue
+   */
+  void RelayQueueDepth (const Address & child, uint32_t depth);
+  /**
+   * Record a child leaving the relay
+   * \param child the child
+   */
+  void RelayChildRemoved (const Address & child);
+
+  uint32_t m_received; //!< Chunks received by the fast leaf
+  uint32_t m_nextSeq; //!< Sequence number the fast leaf expects next
+  uint32_t m_gaps; //!< Chunks the fast leaf never got before a later one
+  uint32_t m_maxDepth; //!< Deepest child queue of the relay
+  uint32_t m_removed; //!< Children the relay removed
+  Time m_removal; //!< When the relay removed the slow leaf
+  Time m_lastChunk; //!< Arrival of the last chunk at the fast leaf
+  uint32_t m_chunks; //!< Chunks streamed by the root
+  uint32_t m_queueSize; //!< ChildQueueSize of every node
+};
+
+ScdtBlockedChildRemovalTestCase::ScdtBlockedChildRemovalTestCase ()
+  : TestCase ("Test that a relay blocked by a slow child reads from its parent again once the child is removed"),
+    m_received (0),
+    m_nextSeq (0),
+    m_gaps (0),
+    m_maxDepth (0),
+    m_removed (0),
+    m_chunks (300),
+    m_queueSize (8)
+{
+}
+
+ScdtBlockedChildRemovalTestCase::~ScdtBlockedChildRemovalTestCase ()
+{
+}
+
+void
+ScdtBlockedChildRemovalTestCase::LeafChunkRx (uint32_t seq, Time latency)
+{
+  m_received++;
+  if (seq > m_nextSeq)
+    {
+      m_gaps += seq - m_nextSeq;
+    }
+  m_nextSeq = std::max (m_nextSeq, seq + 1);
+  m_lastChunk = Simulator::Now ();
+}
+
+void
+ScdtBlockedChildRemovalTestCase::RelayQueueDepth (const Address & child, uint32_t depth)
+{
+  m_maxDepth = std::max (m_maxDepth, depth);
+}
+
+void
+ScdtBlockedChildRemovalTestCase::RelayChildRemoved (const Address & child)
+{
+  m_removed++;
+  m_removal = Simulator::Now ();
+}
+
+void ScdtBlockedChildRemovalTestCase::DoRun (void)
+{
+  // 10kB chunks at 4Mbps: the leaf reached at 1Mbps fills its queue at
+  // the relay and blocks it, until its application stops at 5 s and the
+  // relay loses it to the heartbeat
+  const uint32_t chunkSize = 10000;
+  m_received = 0;
+  m_nextSeq = 0;
+  m_gaps = 0;
+  m_maxDepth = 0;
+  m_removed = 0;
+  m_removal = Seconds (0);
+  m_lastChunk = Seconds (0);
+
+  NodeContainer nodes;
+  nodes.Create (4);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer upper = ConnectNodes (nodes.Get (0), nodes.Get (1), address);
+  Ipv4InterfaceContainer fast = ConnectNodes (nodes.Get (1), nodes.Get (2), address);
+  Ipv4InterfaceContainer slow = ConnectNodes (nodes.Get (1), nodes.Get (3), address, DataRate ("1Mbps"));
+  // The leaves send their HEARTBEATs to the address of the relay towards the root
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  ScdtTree tree;
+  tree.SetRoot (upper.GetAddress (0));
+  tree.Add (upper.GetAddress (1), upper.GetAddress (0), MilliSeconds (10));
+  tree.Add (fast.GetAddress (1), upper.GetAddress (1), MilliSeconds (10));
+  tree.Add (slow.GetAddress (1), upper.GetAddress (1), MilliSeconds (10));
+
+  ScdtServerHelper rootHelper (upper.GetAddress (0), 9, 1);
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("4Mbps")));
+  rootHelper.SetAttribute ("StreamBytes", UintegerValue (static_cast<uint64_t> (m_chunks) * chunkSize));
+  rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (1.0)));
+  ScdtServerHelper memberHelper (upper.GetAddress (0), 9, 0);
+  ScdtServerHelper *helpers[] = { &rootHelper, &memberHelper };
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      helpers[k]->SetAttribute ("PacketSize", UintegerValue (chunkSize));
+      helpers[k]->SetAttribute ("ChildQueueSize", UintegerValue (m_queueSize));
+      helpers[k]->SetAttribute ("ChildQueuePolicy", EnumValue (ScdtServer::QUEUE_BLOCK));
+      helpers[k]->SetTree (tree);
+    }
+  ApplicationContainer apps = rootHelper.Install (nodes.Get (0));
+  apps.Add (memberHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3))));
+  // The leaves put up with HEARTBEATs stuck behind the stream to the
+  // slow leaf rather than leave the relay
+  apps.Get (2)->SetAttribute ("HeartbeatMisses", UintegerValue (10));
+  apps.Get (3)->SetAttribute ("HeartbeatMisses", UintegerValue (10));
+  // Listening before the parent connects
+  apps.Get (3)->SetStartTime (Seconds (1.0));
+  apps.Get (2)->SetStartTime (Seconds (1.0));
+  apps.Get (1)->SetStartTime (Seconds (1.1));
+  apps.Get (0)->SetStartTime (Seconds (1.2));
+  apps.Stop (Seconds (60.0));
+  apps.Get (3)->SetStopTime (Seconds (5.0));
+  apps.Get (1)->TraceConnectWithoutContext ("ChildQueueDepth", MakeCallback (&ScdtBlockedChildRemovalTestCase::RelayQueueDepth, this));
+  apps.Get (1)->TraceConnectWithoutContext ("ChildRemoved", MakeCallback (&ScdtBlockedChildRemovalTestCase::RelayChildRemoved, this));
+  apps.Get (2)->TraceConnectWithoutContext ("ChunkRx", MakeCallback (&ScdtBlockedChildRemovalTestCase::LeafChunkRx, this));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_maxDepth, m_queueSize, "The slow leaf never blocked the relay");
+  NS_TEST_ASSERT_MSG_EQ (m_removed, 1, "The relay did not remove the slow leaf, and only it");
+  NS_TEST_ASSERT_MSG_GT (m_lastChunk, m_removal, "The fast leaf got nothing after the removal");
+  NS_TEST_ASSERT_MSG_EQ (m_received, m_chunks, "The stream stalled after the blocking child was removed");
+  NS_TEST_ASSERT_MSG_EQ (m_gaps, 0, "Block left a gap in the sequence numbers");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that two groups on one node share its two sockets, and that both
+ * trees get their control datagrams and data connections through them
+ */
+class ScdtSocketMuxTestCase : public TestCase
+{
+public:
+  ScdtSocketMuxTestCase ();
+  virtual ~ScdtSocketMuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the number of sockets the mux has open
+   * \param mux the mux of the node both groups share
+   */
+  void CountSockets (Ptr<ScdtSocketMux> mux);
+  /**
+   * Open a data connection and send only part of an opening header
+   * \param socket the socket to connect
+   * \param to the data port of the shared node
+   */
+  void OpenStray (Ptr<Socket> socket, Address to);
+
+  uint32_t m_minSockets; //!< Fewest sockets seen open
+  uint32_t m_maxSockets; //!< Most sockets seen open
+};
+
+ScdtSocketMuxTestCase::ScdtSocketMuxTestCase ()
+  : TestCase ("Test that two groups on one node share its sockets and both get their trees through them"),
+    m_minSockets (0),
+    m_maxSockets (0)
+{
+}
+
+ScdtSocketMuxTestCase::~ScdtSocketMuxTestCase ()
+{
+}
+
+void
+ScdtSocketMuxTestCase::CountSockets (Ptr<ScdtSocketMux> mux)
+{
+  m_minSockets = std::min (m_minSockets, mux->GetNSockets ());
+  m_maxSockets = std::max (m_maxSockets, mux->GetNSockets ());
+}
+
+void
+ScdtSocketMuxTestCase::OpenStray (Ptr<Socket> socket, Address to)
+{
+  socket->Bind ();
+  socket->Connect (to);
+  socket->Send (Create<Packet> (2));
+}
+
+void ScdtSocketMuxTestCase::DoRun (void)
+{
+  m_minSockets = 0xffffffff;
+  m_maxSockets = 0;
+
+  // Node 2 is a member of the group rooted at node 0 and of the one
+  // rooted at node 1
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.252");
+  Ipv4InterfaceContainer links[] = { ConnectNodes (nodes.Get (0), nodes.Get (2), address),
+                                     ConnectNodes (nodes.Get (1), nodes.Get (2), address) };
+
+  ApplicationContainer roots;
+  ApplicationContainer members;
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      Address rootIp = links[g].GetAddress (0);
+      ScdtServerHelper rootHelper (rootIp, 9, 1);
+      rootHelper.SetAttribute ("GroupId", UintegerValue (g + 1));
+      rootHelper.SetAttribute ("PacketSize", UintegerValue (1000));
+      rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("80kbps")));
+      rootHelper.SetAttribute ("StreamStart", TimeValue (Seconds (2.0)));
+      roots.Add (rootHelper.Install (nodes.Get (g)));
+      ScdtServerHelper memberHelper (rootIp, 9, 0);
+      memberHelper.SetAttribute ("GroupId", UintegerValue (g + 1));
+      memberHelper.SetAttribute ("PacketSize", UintegerValue (1000));
+      members.Add (memberHelper.Install (nodes.Get (2)));
+    }
+  roots.Start (Seconds (1.0));
+  roots.Stop (Seconds (10.0));
+  members.Start (Seconds (1.5));
+  members.Stop (Seconds (10.0));
+
+  // A connection to the data port that closes halfway through its
+  // opening header must not disturb either group
+  Ptr<Socket> stray = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  Simulator::Schedule (Seconds (2.0), &ScdtSocketMuxTestCase::OpenStray, this, stray,
+                       Address (InetSocketAddress (links[0].GetAddress (1), 500)));
+  Simulator::Schedule (Seconds (3.0), &Socket::Close, stray);
+
+  Ptr<ScdtSocketMux> mux = ScdtSocketMux::GetMux (nodes.Get (2));
+  for (uint32_t t = 2; t < 10; t++)
+    {
+      Simulator::Schedule (Seconds (t), &ScdtSocketMuxTestCase::CountSockets, this, mux);
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_minSockets, 2, "The groups did not share the control and data sockets");
+  NS_TEST_ASSERT_MSG_EQ (m_maxSockets, 2, "The mux opened sockets beyond one control and one data socket");
+  for (uint32_t g = 0; g < 2; g++)
+    {
+      Ptr<ScdtServer> member = members.Get (g)->GetObject<ScdtServer> ();
+      NS_TEST_ASSERT_MSG_EQ (member->IsAttached (), true, "Group " << g + 1 << " never attached node 2");
+      NS_TEST_ASSERT_MSG_GT (member->GetRxChunks (), 0, "Group " << g + 1 << " streamed nothing to node 2");
+      NS_TEST_ASSERT_MSG_EQ (roots.Get (g)->GetObject<ScdtServer> ()->GetNChildren (), 1,
+                             "The root of group " << g + 1 << " does not have node 2 as its child");
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that the children of a node whose application stops reattach
+ * below the backup parent of their join, without going back to the root
+ */
+class ScdtBackupRepairTestCase : public TestCase
+{
+public:
+  ScdtBackupRepairTestCase ();
+  virtual ~ScdtBackupRepairTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a datagram the root receives from an orphan after the failure
+   * \param packet the packet, IPv4 header included
+   * \param ipv4 the IPv4 stack of the root
+   * \param interface the interface it arrived on
+   */
+  void RootRx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  /**
+   * Record a chunk received by an orphan
+   * \param seq the sequence number of the chunk
+   * \param latency the latency of the chunk
+   */
+  void OrphanChunkRx (uint32_t seq, Time latency);
+
+  Time m_failure; //!< When the node in the middle stops
+  std::vector<Ipv4Address> m_orphans; //!< Children of the node that stops
+  uint32_t m_rootRx; //!< Datagrams the root got from the orphans after the failure
+  Time m_lastChunk; //!< Arrival of the last chunk at an orphan
+};
+
+ScdtBackupRepairTestCase::ScdtBackupRepairTestCase ()
+  : TestCase ("Test that the children of a stopped node reattach below a backup parent, not the root"),
+    m_failure (Seconds (10.0)),
+    m_rootRx (0)
+{
+}
+
+ScdtBackupRepairTestCase::~ScdtBackupRepairTestCase ()
+{
+}
+
+void
+ScdtBackupRepairTestCase::RootRx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Ipv4Header ipHeader;
+  packet->PeekHeader (ipHeader);
+  if (Simulator::Now () > m_failure
+      && std::find (m_orphans.begin (), m_orphans.end (), ipHeader.GetSource ()) != m_orphans.end ())
+    {
+      m_rootRx++;
+    }
+}
+
+void
+ScdtBackupRepairTestCase::OrphanChunkRx (uint32_t seq, Time latency)
+{
+  m_lastChunk = Simulator::Now ();
+}
+
+void ScdtBackupRepairTestCase::DoRun (void)
+{
+  m_rootRx = 0;
+  m_lastChunk = Seconds (0);
+
+  // The root takes mid and backup; mid answers PINGs faster than
+  // backup, whose device is slow, so the later joiners both go below
+  // mid and keep backup as their backup parent
+  NodeContainer nodes;
+  nodes.Create (5);
+  Ptr<Node> root = nodes.Get (0);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ConnectLan (nodes, address);
+  interfaces.Get (2).first->GetNetDevice (interfaces.Get (2).second)->SetAttribute ("DataRate", DataRateValue (DataRate ("1Mbps")));
+  m_orphans.clear ();
+  m_orphans.push_back (interfaces.GetAddress (3));
+  m_orphans.push_back (interfaces.GetAddress (4));
+
+  // Never evicting keeps the root from trading backup for a closer joiner
+  ScdtServerHelper rootHelper (interfaces.GetAddress (0), 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (2));
+  rootHelper.SetAttribute ("AdmissionPolicy", TypeIdValue (ScdtNeverEvictAdmissionPolicy::GetTypeId ()));
+  rootHelper.SetAttribute ("PacketSize", UintegerValue (1000));
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("80kbps")));
+  ApplicationContainer apps = rootHelper.Install (root);
+  ScdtServerHelper memberHelper (interfaces.GetAddress (0), 9, 0);
+  memberHelper.SetAttribute ("AdmissionPolicy", TypeIdValue (ScdtNeverEvictAdmissionPolicy::GetTypeId ()));
+  memberHelper.SetAttribute ("PacketSize", UintegerValue (1000));
+  apps.Add (memberHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3), nodes.Get (4))));
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    {
+      apps.Get (i)->SetStartTime (Seconds (1.0 + i));
+      apps.Get (i)->SetStopTime (Seconds (30.0));
+    }
+  apps.Get (1)->SetStopTime (m_failure);
+  root->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("Rx", MakeCallback (&ScdtBackupRepairTestCase::RootRx, this));
+  apps.Get (3)->TraceConnectWithoutContext ("ChunkRx", MakeCallback (&ScdtBackupRepairTestCase::OrphanChunkRx, this));
+  apps.Get (4)->TraceConnectWithoutContext ("ChunkRx", MakeCallback (&ScdtBackupRepairTestCase::OrphanChunkRx, this));
+
+  Simulator::Run ();
+
+  Address backup = InetSocketAddress (interfaces.GetAddress (2), 9);
+  for (uint32_t i = 3; i < 5; i++)
+    {
+      Ptr<ScdtServer> orphan = apps.Get (i)->GetObject<ScdtServer> ();
+      NS_TEST_ASSERT_MSG_EQ (orphan->IsAttached (), true, "Node " << i << " did not reattach");
+      NS_TEST_ASSERT_MSG_EQ ((orphan->GetParent () == backup), true, "Node " << i << " did not reattach below its backup parent");
+    }
+  NS_TEST_ASSERT_MSG_EQ (apps.Get (2)->GetObject<ScdtServer> ()->GetNChildren (), 2, "The backup parent did not take both orphans");
+  NS_TEST_ASSERT_MSG_EQ (m_rootRx, 0, "An orphan went back to the root");
+  NS_TEST_ASSERT_MSG_GT (m_lastChunk, m_failure + Seconds (5), "The stream did not reach the orphans again");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that a tree snapshot read back with ScdtTree::LoadSnapshot has
+ * the parents, depths and RTTs of the running tree
+ */
+class ScdtTreeSnapshotTestCase : public TestCase
+{
+public:
+  ScdtTreeSnapshotTestCase ();
+  virtual ~ScdtTreeSnapshotTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Take a snapshot and record the tree the applications see at the
+   * same instant
+   * \param snapshots the helper writing the snapshot
+   * \param apps the applications, root first
+   * \param addresses the address of each application's node
+   */
+  void Record (ScdtTreeSnapshotHelper *snapshots, ApplicationContainer apps, std::vector<Ipv4Address> addresses);
+
+  std::map<Ipv4Address, Ipv4Address> m_parents; //!< Parent of each attached member
+  std::map<Ipv4Address, uint16_t> m_depths; //!< Depth of each attached member
+  std::map<Ipv4Address, Time> m_rtts; //!< RTT each parent measured to the member
+};
+
+ScdtTreeSnapshotTestCase::ScdtTreeSnapshotTestCase ()
+  : TestCase ("Test that a tree snapshot read back with ScdtTree::LoadSnapshot has the parents, depths and RTTs of the running tree")
+{
+}
+
+ScdtTreeSnapshotTestCase::~ScdtTreeSnapshotTestCase ()
+{
+}
+
+void
+ScdtTreeSnapshotTestCase::Record (ScdtTreeSnapshotHelper *snapshots, ApplicationContainer apps,
+                                  std::vector<Ipv4Address> addresses)
+{
+  snapshots->Snapshot ();
+  for (uint32_t k = 1; k < apps.GetN (); k++)
+    {
+      Ptr<ScdtServer> member = apps.Get (k)->GetObject<ScdtServer> ();
+      if (!member->IsAttached ())
+        {
+          continue;
+        }
+      Ipv4Address parent = InetSocketAddress::ConvertFrom (member->GetParent ()).GetIpv4 ();
+      m_parents[addresses[k]] = parent;
+      m_depths[addresses[k]] = member->GetDepth ();
+      Ptr<ScdtServer> parentServer = apps.Get (std::find (addresses.begin (), addresses.end (), parent) - addresses.begin ())->GetObject<ScdtServer> ();
+      for (uint32_t c = 0; c < parentServer->GetNChildren (); c++)
+        {
+          if (InetSocketAddress::ConvertFrom (parentServer->GetChild (c)).GetIpv4 () == addresses[k])
+            {
+              m_rtts[addresses[k]] = parentServer->GetChildRtt (c);
+            }
+        }
+    }
+}
+
+void ScdtTreeSnapshotTestCase::DoRun (void)
+{
+  m_parents.clear ();
+  m_depths.clear ();
+  m_rtts.clear ();
+
+  // A fan-out of 2 puts the last two joiners at depth 2
+  NodeContainer nodes;
+  nodes.Create (5);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ConnectLan (nodes, address);
+  std::vector<Ipv4Address> addresses;
+  for (uint32_t i = 0; i < interfaces.GetN (); i++)
+    {
+      addresses.push_back (interfaces.GetAddress (i));
+    }
+
+  ScdtServerHelper rootHelper (interfaces.GetAddress (0), 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (2));
+  ApplicationContainer apps = rootHelper.Install (nodes.Get (0));
+  ScdtServerHelper memberHelper (interfaces.GetAddress (0), 9, 0);
+  memberHelper.SetAttribute ("MaxFanout", UintegerValue (2));
+  apps.Add (memberHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3), nodes.Get (4))));
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    {
+      apps.Get (i)->SetStartTime (Seconds (1.0 + i));
+      apps.Get (i)->SetStopTime (Seconds (12.0));
+    }
+
+  std::string fileName = CreateTempDirFilename ("scdt-snapshot.json");
+  ScdtTreeSnapshotHelper snapshots;
+  snapshots.Add (apps);
+  snapshots.EnableJson (fileName);
+  Simulator::Schedule (Seconds (10.0), &ScdtTreeSnapshotTestCase::Record, this, &snapshots, apps, addresses);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_parents.size (), 4, "Not every member attached before the snapshot");
+  ScdtTree tree;
+  NS_TEST_ASSERT_MSG_EQ (tree.LoadSnapshot (fileName), true, "Snapshot not read back");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetRoot (), addresses[0], "Root mismatch");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetN (), 5, "Node count mismatch");
+  for (std::map<Ipv4Address, Ipv4Address>::const_iterator it = m_parents.begin (); it != m_parents.end (); it++)
+    {
+      Ipv4Address node = it->first;
+      NS_TEST_ASSERT_MSG_EQ (tree.Contains (node), true, "Node " << node << " missing");
+      NS_TEST_ASSERT_MSG_EQ (tree.GetParent (node), it->second, "Parent of " << node << " mismatch");
+      NS_TEST_ASSERT_MSG_EQ (tree.GetDepth (node), m_depths[node], "Depth of " << node << " mismatch");
+      // Written with 9 significant digits
+      NS_TEST_ASSERT_MSG_EQ_TOL (tree.GetRtt (node).GetNanoSeconds (), m_rtts[node].GetNanoSeconds (), 1,
+                                 "RTT of " << node << " mismatch");
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that ScdtTree derives ancestors, depths, root latencies and
+ * subtree sizes, and reads back its text files and snapshots
+ */
+class ScdtTreeTestCase : public TestCase
+{
+public:
+  ScdtTreeTestCase ();
+  virtual ~ScdtTreeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write a file
+   * \param fileName the file, overwritten
+   * \param text its contents
+   */
+  void WriteFile (std::string fileName, std::string text);
+
+};
+
+ScdtTreeTestCase::ScdtTreeTestCase ()
+  : TestCase ("Test that ScdtTree derives ancestors, depths, root latencies and subtree sizes, and reads back its text files and snapshots")
+{
+}
+
+ScdtTreeTestCase::~ScdtTreeTestCase ()
+{
+}
+
+void
+ScdtTreeTestCase::WriteFile (std::string fileName, std::string text)
+{
+  std::ofstream out (fileName.c_str (), std::ios::trunc);
+  out << text;
+}
+
+void ScdtTreeTestCase::DoRun (void)
+{
+  Ipv4Address root ("10.0.0.1");
+  Ipv4Address a ("10.0.0.2");
+  Ipv4Address b ("10.0.0.3");
+  Ipv4Address c ("10.0.0.4");
+  Ipv4Address d ("10.0.0.5");
+  ScdtTree tree;
+  tree.SetRoot (root);
+  tree.Add (a, root, MilliSeconds (20));
+  tree.Add (b, root, MilliSeconds (40));
+  tree.Add (c, a, MilliSeconds (10));
+  tree.Add (d, c, MilliSeconds (6));
+
+  NS_TEST_ASSERT_MSG_EQ (tree.GetN (), 5, "Node count mismatch");
+  std::vector<Ipv4Address> ancestors = tree.GetAncestors (d);
+  NS_TEST_ASSERT_MSG_EQ (ancestors.size (), 3, "Ancestor count mismatch");
+  NS_TEST_ASSERT_MSG_EQ (ancestors[0], c, "Ancestors do not start at the parent");
+  NS_TEST_ASSERT_MSG_EQ (ancestors[2], root, "Ancestors do not end at the root");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetAncestors (root).size (), 0, "The root has ancestors");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetDepth (root), 0, "Root depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetDepth (b), 1, "Depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetDepth (d), 3, "Depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetRootLatency (d), MilliSeconds (18), "Root latency is not half the RTTs on the path");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetRootLatency (root), Seconds (0), "Root latency of the root");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetSubtreeSize (root), 5, "Subtree size of the root mismatch");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetSubtreeSize (a), 3, "Subtree size mismatch");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetSubtreeSize (d), 1, "Subtree size of a leaf mismatch");
+
+  // Adding a node again moves its subtree
+  tree.Add (c, b, MilliSeconds (8));
+  NS_TEST_ASSERT_MSG_EQ (tree.GetChildren (a).size (), 0, "Moved node left below its old parent");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetSubtreeSize (b), 3, "Subtree not moved along");
+  NS_TEST_ASSERT_MSG_EQ (tree.GetRootLatency (d), MilliSeconds (27), "Root latency not updated by the move");
+
+  std::string textFile = CreateTempDirFilename ("scdt-tree.txt");
+  NS_TEST_ASSERT_MSG_EQ (tree.SaveText (textFile), true, "Text file not written");
+  ScdtTree copy;
+  NS_TEST_ASSERT_MSG_EQ (copy.LoadText (textFile), true, "Text file not read back");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetN (), tree.GetN (), "Node count changed by the round trip");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetRoot (), root, "Root changed by the round trip");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetParent (c), b, "Parent changed by the round trip");
+  NS_TEST_ASSERT_MSG_EQ_TOL (copy.GetRtt (d).GetNanoSeconds (), 6000000, 1, "RTT changed by the round trip");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetDepth (d), 3, "Depth changed by the round trip");
+
+  WriteFile (textFile, "# comment\n\n10.0.0.1 -\n10.0.0.2 10.0.0.1 0.02 # trailing comment\n");
+  NS_TEST_ASSERT_MSG_EQ (copy.LoadText (textFile), true, "Comments and blank lines rejected");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetN (), 2, "LoadText did not replace the tree");
+  WriteFile (textFile, "10.0.0.1 -\n10.0.0.2 10.0.0.1\n");
+  NS_TEST_ASSERT_MSG_EQ (copy.LoadText (textFile), false, "Line without an RTT accepted");
+  WriteFile (textFile, "10.0.0.1 -\n10.0.0.2 10.0.0.256 0.02\n");
+  NS_TEST_ASSERT_MSG_EQ (copy.LoadText (textFile), false, "Parent address out of range accepted");
+  WriteFile (textFile, "10.0.0.1 -\n10.0.0 10.0.0.1 0.02\n");
+  NS_TEST_ASSERT_MSG_EQ (copy.LoadText (textFile), false, "Node address with three bytes accepted");
+  WriteFile (textFile, "node-a -\n");
+  NS_TEST_ASSERT_MSG_EQ (copy.LoadText (textFile), false, "Node name accepted as an address");
+
+  // Two snapshots as ScdtTreeSnapshotHelper writes them: 10.0.0.3 has
+  // not attached in the first, and its RTT is not measured in the second
+  std::string snapshotFile = CreateTempDirFilename ("scdt-tree.json");
+  WriteFile (snapshotFile,
+             "{\"time\":1,\"attached\":2,\"maxDepth\":1,\"nodes\":["
+             "{\"node\":0,\"address\":\"10.0.0.1\",\"root\":true,\"attached\":true,\"parent\":null,\"depth\":0,\"rttToParent\":null,\"subtree\":2,\"children\":[\"10.0.0.2\"]},"
+             "{\"node\":1,\"address\":\"10.0.0.2\",\"root\":false,\"attached\":true,\"parent\":\"10.0.0.1\",\"depth\":1,\"rttToParent\":0.02,\"subtree\":1,\"children\":[]},"
+             "{\"node\":2,\"address\":\"10.0.0.3\",\"root\":false,\"attached\":false,\"parent\":null,\"depth\":null,\"rttToParent\":null,\"subtree\":1,\"children\":[]}]}\n"
+             "{\"time\":2,\"attached\":3,\"maxDepth\":2,\"nodes\":["
+             "{\"node\":0,\"address\":\"10.0.0.1\",\"root\":true,\"attached\":true,\"parent\":null,\"depth\":0,\"rttToParent\":null,\"subtree\":3,\"children\":[\"10.0.0.2\"]},"
+             "{\"node\":1,\"address\":\"10.0.0.2\",\"root\":false,\"attached\":true,\"parent\":\"10.0.0.1\",\"depth\":1,\"rttToParent\":0.02,\"subtree\":2,\"children\":[\"10.0.0.3\"]},"
+             "{\"node\":2,\"address\":\"10.0.0.3\",\"root\":false,\"attached\":true,\"parent\":\"10.0.0.2\",\"depth\":2,\"rttToParent\":null,\"subtree\":1,\"children\":[]}]}\n");
+  ScdtTree snapshot;
+  NS_TEST_ASSERT_MSG_EQ (snapshot.LoadSnapshot (snapshotFile, 0), true, "First snapshot not read");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetN (), 2, "Unattached node read");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetRoot (), root, "Root mismatch");
+  NS_TEST_ASSERT_MSG_EQ_TOL (snapshot.GetRtt (a).GetNanoSeconds (), 20000000, 1, "RTT mismatch");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.LoadSnapshot (snapshotFile), true, "Last snapshot not read");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetN (), 3, "LoadSnapshot did not read the last snapshot");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetParent (b), a, "Parent mismatch");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetDepth (b), 2, "Depth mismatch");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.GetRtt (b), Seconds (0), "Unmeasured RTT not read as zero");
+  NS_TEST_ASSERT_MSG_EQ (snapshot.LoadSnapshot (snapshotFile, 2), false, "Missing snapshot read");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that applications installed on a preset tree stream in place,
+ * without a join phase
+ */
+class ScdtPresetTreeTestCase : public TestCase
+{
+public:
+  ScdtPresetTreeTestCase ();
+  virtual ~ScdtPresetTreeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a completed join
+   * \param parent the parent joined
+   * \param latency the join latency
+   */
+  void Attach (const Address &parent, Time latency);
+
+  uint32_t m_attaches; //!< Joins completed
+  Time m_maxJoinLatency; //!< Largest join latency
+};
+
+ScdtPresetTreeTestCase::ScdtPresetTreeTestCase ()
+  : TestCase ("Test that applications installed on a preset tree stream in place, without a join phase"),
+    m_attaches (0)
+{
+}
+
+ScdtPresetTreeTestCase::~ScdtPresetTreeTestCase ()
+{
+}
+
+void
+ScdtPresetTreeTestCase::Attach (const Address &parent, Time latency)
+{
+  m_attaches++;
+  m_maxJoinLatency = std::max (m_maxJoinLatency, latency);
+}
+
+void ScdtPresetTreeTestCase::DoRun (void)
+{
+  m_attaches = 0;
+  m_maxJoinLatency = Seconds (0);
+
+  NodeContainer nodes;
+  nodes.Create (4);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ConnectLan (nodes, address);
+
+  // Node 2 below node 1, which would be full with a fan-out of 1 if it
+  // had to join
+  ScdtTree tree;
+  tree.SetRoot (interfaces.GetAddress (0));
+  tree.Add (interfaces.GetAddress (1), interfaces.GetAddress (0), MilliSeconds (10));
+  tree.Add (interfaces.GetAddress (2), interfaces.GetAddress (1), MilliSeconds (10));
+  tree.Add (interfaces.GetAddress (3), interfaces.GetAddress (0), MilliSeconds (10));
+
+  ScdtServerHelper rootHelper (interfaces.GetAddress (0), 9, 1);
+  rootHelper.SetAttribute ("MaxFanout", UintegerValue (2));
+  rootHelper.SetAttribute ("PacketSize", UintegerValue (1000));
+  rootHelper.SetAttribute ("StreamRate", DataRateValue (DataRate ("80kbps")));
+  rootHelper.SetTree (tree);
+  ApplicationContainer apps = rootHelper.Install (nodes.Get (0));
+  ScdtServerHelper memberHelper (interfaces.GetAddress (0), 9, 0);
+  memberHelper.SetAttribute ("MaxFanout", UintegerValue (1));
+  memberHelper.SetAttribute ("PacketSize", UintegerValue (1000));
+  memberHelper.SetTree (tree);
+  apps.Add (memberHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2), nodes.Get (3))));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (10.0));
+  for (uint32_t i = 1; i < apps.GetN (); i++)
+    {
+      apps.Get (i)->TraceConnectWithoutContext ("Attach", MakeCallback (&ScdtPresetTreeTestCase::Attach, this));
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_attaches, 3, "A member joined besides taking its preset position");
+  NS_TEST_ASSERT_MSG_EQ (m_maxJoinLatency, Seconds (0), "A member went through a join phase");
+  NS_TEST_ASSERT_MSG_EQ (apps.Get (0)->GetObject<ScdtServer> ()->GetNChildren (), 2, "The root lost a preset child");
+  for (uint32_t i = 1; i < apps.GetN (); i++)
+    {
+      Ptr<ScdtServer> member = apps.Get (i)->GetObject<ScdtServer> ();
+      Address parent = InetSocketAddress (tree.GetParent (interfaces.GetAddress (i)), 9);
+      NS_TEST_ASSERT_MSG_EQ (member->IsAttached (), true, "Node " << i << " not attached");
+      NS_TEST_ASSERT_MSG_EQ ((member->GetParent () == parent), true, "Node " << i << " not below its preset parent");
+      NS_TEST_ASSERT_MSG_EQ (member->GetDepth (), tree.GetDepth (interfaces.GetAddress (i)), "Node " << i << " at the wrong depth");
+      NS_TEST_ASSERT_MSG_GT (member->GetRxChunks (), 0, "Node " << i << " received no chunk");
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that every arrival model of ScdtServerHelper::ScheduleArrivals
+ * repeats with its streams and starts inside its window
+ */
+class ScdtArrivalsTestCase : public TestCase
+{
+public:
+  ScdtArrivalsTestCase ();
+  virtual ~ScdtArrivalsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Draw start times with fixed streams
+   * \param model the name of the arrival model
+   * \param apps the applications to start
+   * \returns their start times
+   */
+  std::vector<Time> Draw (std::string model, ApplicationContainer apps);
+
+  Time m_start; //!< Earliest start time
+  Time m_window; //!< Time the arrivals are spread over
+  uint32_t m_crowd; //!< Applications in the flash crowd burst
+  Time m_burst; //!< Duration of the burst
+};
+
+ScdtArrivalsTestCase::ScdtArrivalsTestCase ()
+  : TestCase ("Test that every arrival model of ScdtServerHelper::ScheduleArrivals repeats with its streams and starts inside its window"),
+    m_start (Seconds (2)),
+    m_window (Seconds (50)),
+    m_crowd (100),
+    m_burst (MilliSeconds (100))
+{
+}
+
+ScdtArrivalsTestCase::~ScdtArrivalsTestCase ()
+{
+}
+
+std::vector<Time>
+ScdtArrivalsTestCase::Draw (std::string model, ApplicationContainer apps)
+{
+  ScdtServerHelper helper (Ipv4Address ("10.1.1.1"), 9, 0);
+  helper.SetArrivals (model, m_start, m_window);
+  helper.SetFlashCrowd (m_crowd, m_burst);
+  helper.AssignStreams (NodeContainer (), 10);
+  return helper.ScheduleArrivals (apps);
+}
+
+void ScdtArrivalsTestCase::DoRun (void)
+{
+  // Start times are all ScheduleArrivals touches, so the applications
+  // need no node
+  ApplicationContainer apps;
+  for (uint32_t k = 0; k < 1000; k++)
+    {
+      apps.Add (CreateObject<ScdtServer> ());
+    }
+
+  const char *models[] = { "Uniform", "Poisson", "FlashCrowd", "Diurnal" };
+  for (uint32_t m = 0; m < 4; m++)
+    {
+      std::string model = models[m];
+      std::vector<Time> starts = Draw (model, apps);
+      NS_TEST_ASSERT_MSG_EQ (starts.size (), apps.GetN (), model << ": start count mismatch");
+      NS_TEST_ASSERT_MSG_EQ ((Draw (model, apps) == starts), true, model << ": same streams, different start times");
+      for (uint32_t k = 0; k < starts.size (); k++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((starts[k] >= m_start && starts[k] <= m_start + m_window), true,
+                                 model << ": start " << starts[k].GetSeconds () << "s outside the window");
+        }
+    }
+
+  std::vector<Time> crowd = Draw ("FlashCrowd", apps);
+  for (uint32_t k = 0; k < m_crowd; k++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((crowd[k] <= m_start + m_burst), true, "Flash crowd arrival " << k << " after the burst");
+    }
+
+  // n arrivals in the window leave n + 1 gaps, window / n apart give or take
+  std::vector<Time> poisson = Draw ("Poisson", apps);
+  for (uint32_t k = 1; k < poisson.size (); k++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((poisson[k] >= poisson[k - 1]), true, "Poisson arrivals out of order");
+    }
+  double meanGap = (poisson.back () - poisson.front ()).GetSeconds () / (poisson.size () - 1);
+  double expected = m_window.GetSeconds () / apps.GetN ();
+  NS_TEST_ASSERT_MSG_EQ_TOL (meanGap, expected, expected / 10, "Poisson mean gap mismatch");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Test that the trace sources of ScdtServer fire on a join
+ */
+class ScdtTraceSourcesTestCase : public TestCase
+{
+public:
+  ScdtTraceSourcesTestCase ();
+  virtual ~ScdtTraceSourcesTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record a PING
+   * \param dest the node probed
+   * \param seq the sequence number of the probe
+   */
+  void ProbeSent (const Address & dest, uint32_t seq);
+  /**
+   * Record an answered PING
+   * \param from the node that answered
+   * \param seq the sequence number of the probe
+   * \param rtt the RTT measured
+   */
+  void ProbeAnswered (const Address & from, uint32_t seq, Time rtt);
+  /**
+   * Record a completed join
+   * \param parent the parent joined
+   * \param latency the join latency
+   */
+  void Attach (const Address & parent, Time latency);
+  /**
+   * Record a child taking a slot of the root
+   * \param child the child
+   */
+  void ChildAdded (const Address & child);
+  /**
+   * Record a packet sent by the member
+   * \param packet the packet
+   */
+  void MemberTx (Ptr<const Packet> packet);
+
+  uint32_t m_probesSent; //!< PINGs sent by either node
+  uint32_t m_probesAnswered; //!< PINGs answered to either node
+  Time m_minRtt; //!< Smallest RTT of the answered PINGs
+  uint32_t m_attaches; //!< Joins completed by the member
+  Address m_parent; //!< Parent the member joined
+  uint32_t m_childrenAdded; //!< Children the root took
+  Address m_child; //!< Child the root took
+  uint32_t m_memberTx; //!< Packets sent by the member
+};
+
+ScdtTraceSourcesTestCase::ScdtTraceSourcesTestCase ()
+  : TestCase ("Test that the trace sources of ScdtServer fire on a join"),
+    m_probesSent (0),
+    m_probesAnswered (0),
+    m_attaches (0),
+    m_childrenAdded (0),
+    m_memberTx (0)
+{
+}
+
+ScdtTraceSourcesTestCase::~ScdtTraceSourcesTestCase ()
+{
+}
+
+void
+ScdtTraceSourcesTestCase::ProbeSent (const Address & dest, uint32_t seq)
+{
+  m_probesSent++;
+}
+
+void
+ScdtTraceSourcesTestCase::ProbeAnswered (const Address & from, uint32_t seq, Time rtt)
+{
+  m_probesAnswered++;
+  m_minRtt = std::min (m_minRtt, rtt);
+}
+
+void
+ScdtTraceSourcesTestCase::Attach (const Address & parent, Time latency)
+{
+  m_attaches++;
+  m_parent = parent;
+}
+
+void
+ScdtTraceSourcesTestCase::ChildAdded (const Address & child)
+{
+  m_childrenAdded++;
+  m_child = child;
+}
+
+void
+ScdtTraceSourcesTestCase::MemberTx (Ptr<const Packet> packet)
+{
+  m_memberTx++;
+}
+
+void ScdtTraceSourcesTestCase::DoRun (void)
+{
+  m_probesSent = 0;
+  m_probesAnswered = 0;
+  m_minRtt = Time::Max ();
+  m_attaches = 0;
+  m_childrenAdded = 0;
+  m_memberTx = 0;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ConnectLan (nodes, address);
+
+  ScdtServerHelper rootHelper (interfaces.GetAddress (0), 9, 1);
+  ApplicationContainer apps = rootHelper.Install (nodes.Get (0));
+  ScdtServerHelper memberHelper (interfaces.GetAddress (0), 9, 0);
+  apps.Add (memberHelper.Install (nodes.Get (1)));
+  apps.Get (0)->SetStartTime (Seconds (1.0));
+  apps.Get (1)->SetStartTime (Seconds (2.0));
+  apps.Stop (Seconds (5.0));
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    {
+      apps.Get (i)->TraceConnectWithoutContext ("ProbeSent", MakeCallback (&ScdtTraceSourcesTestCase::ProbeSent, this));
+      apps.Get (i)->TraceConnectWithoutContext ("ProbeAnswered", MakeCallback (&ScdtTraceSourcesTestCase::ProbeAnswered, this));
+    }
+  apps.Get (0)->TraceConnectWithoutContext ("ChildAdded", MakeCallback (&ScdtTraceSourcesTestCase::ChildAdded, this));
+  apps.Get (1)->TraceConnectWithoutContext ("Attach", MakeCallback (&ScdtTraceSourcesTestCase::Attach, this));
+  apps.Get (1)->TraceConnectWithoutContext ("Tx", MakeCallback (&ScdtTraceSourcesTestCase::MemberTx, this));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (m_probesSent, 0, "ProbeSent never fired");
+  NS_TEST_ASSERT_MSG_GT (m_probesAnswered, 0, "ProbeAnswered never fired");
+  NS_TEST_ASSERT_MSG_LT (m_probesAnswered, m_probesSent + 1, "More PINGs answered than sent");
+  NS_TEST_ASSERT_MSG_GT (m_minRtt, MilliSeconds (10) - NanoSeconds (1), "RTT shorter than the two way channel delay");
+  NS_TEST_ASSERT_MSG_EQ (m_attaches, 1, "Attach did not fire once");
+  NS_TEST_ASSERT_MSG_EQ ((m_parent == Address (InetSocketAddress (interfaces.GetAddress (0), 9))), true, "Attach reported the wrong parent");
+  NS_TEST_ASSERT_MSG_EQ (m_childrenAdded, 1, "ChildAdded did not fire once");
+  NS_TEST_ASSERT_MSG_EQ ((m_child == Address (InetSocketAddress (interfaces.GetAddress (1), 9))), true, "ChildAdded reported the wrong child");
+  NS_TEST_ASSERT_MSG_GT (m_memberTx, 0, "Tx never fired for the control messages of the join");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief SCDT TestSuite
+ */
+class ScdtServerTestSuite : public TestSuite
+{
+public:
+  ScdtServerTestSuite ();
+};
+
+ScdtServerTestSuite::ScdtServerTestSuite ()
+  : TestSuite ("scdt-server", UNIT)
+{
+  AddTestCase (new ScdtHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtProbeTableTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtLatencyHistogramTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtVivaldiCoordinateTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtAdmissionPolicyTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtStatsCollectorTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtEndpointTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtLossyAttachTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtChildQueuePolicyTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtBlockedChildRemovalTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtSocketMuxTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtBackupRepairTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtTreeSnapshotTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtTreeTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtPresetTreeTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtArrivalsTestCase, TestCase::QUICK);
+  AddTestCase (new ScdtTraceSourcesTestCase, TestCase::QUICK);
+}
+
+static ScdtServerTestSuite scdtServerTestSuite; //!< Static variable for test initialization